@@ -0,0 +1,204 @@
+# flake8: noqa
+# Copyright (c) 2020-2026, Krzysztof Strehlau
+# This file is part of the ksIotFrameworkLib IoT library.
+# All licensing information can be found inside LICENSE.md file
+# https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+"""
+Renders binary log records (KSF_LOG_BINARY=1) using the map generated by log_map.py.
+
+Record: zero byte, level, format id (little endian uint32) and arguments. Each argument is a tag followed
+by the value: 0 - unsigned varint, 1 - zigzag varint, 2 - float32, 3 - varint length and the string.
+
+The script connects to the device portal terminal, keeps the logs enabled and prints both text lines and
+decoded binary records. The browser terminal ignores binary records.
+
+With --dump, it renders a saved log instead, e.g. the payload of "dstat/prevLog" (log from before the last reset),
+where binary records are written in hex, prefixed with '#'.
+
+Requires websocket-client (pip install websocket-client), except for --dump.
+Usage: python log_decoder.py ksf_log_map.json 192.168.4.1 [--password ...]
+       python log_decoder.py ksf_log_map.json --dump prevLog.txt
+"""
+import argparse
+import base64
+import http.client
+import json
+import re
+import struct
+import threading
+
+from logger import Colors
+
+LEVEL_NAMES = {1: "E", 2: "W", 3: "I", 4: "D", 5: "T"}
+LEVEL_COLORS = {1: Colors.Red, 2: Colors.Yellow, 3: Colors.Default, 4: Colors.DarkGray, 5: Colors.DarkGray}
+
+# Python formatting doesn't know C length modifiers and %p, string precision is applied on the device.
+CONVERSION = re.compile(r"%([-+ #0]*(?:\*|\d+)?)(\.(?:\*|\d+))?(?:hh|ll|[hlLqjzt])?([diouxXeEfFgGcsp%])")
+
+LOG_ARG_UNSIGNED = 0
+LOG_ARG_SIGNED = 1
+LOG_ARG_FLOAT = 2
+LOG_ARG_STRING = 3
+
+
+def read_varint(data, offset):
+    """Reads LEB128 varint, returns value and the new offset."""
+    value = 0
+    shift = 0
+    while True:
+        byte = data[offset]
+        offset += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if byte < 0x80:
+            return value, offset
+
+
+def decode_args(data, offset):
+    """Decodes record arguments."""
+    args = []
+    while offset < len(data):
+        tag = data[offset]
+        offset += 1
+        if tag == LOG_ARG_UNSIGNED:
+            value, offset = read_varint(data, offset)
+        elif tag == LOG_ARG_SIGNED:
+            value, offset = read_varint(data, offset)
+            value = (value >> 1) ^ -(value & 1)
+        elif tag == LOG_ARG_FLOAT:
+            value = struct.unpack_from("<f", data, offset)[0]
+            offset += 4
+        elif tag == LOG_ARG_STRING:
+            length, offset = read_varint(data, offset)
+            value = data[offset:offset + length].decode("utf-8", errors="replace")
+            offset += length
+        else:
+            raise ValueError("unknown argument tag %d" % tag)
+        args.append(value)
+    return args
+
+
+def render(fmt, args):
+    """Formats the arguments like printf, missing arguments (truncated record) are printed as <?>."""
+    remaining = list(args)
+
+    def take():
+        return remaining.pop(0) if remaining else "<?>"
+
+    def replace(match):
+        flags, precision, conversion = match.groups()
+        if conversion == "%":
+            return "%"
+        if "*" in flags:
+            flags = flags.replace("*", str(take()))
+        # String precision has been applied on the device and is not a part of the record.
+        if precision == ".*":
+            precision = "" if conversion == "s" else "." + str(take())
+        value = take()
+        if isinstance(value, str) and value == "<?>" and conversion != "s":
+            return value
+        if conversion == "p":
+            return "0x%x" % value
+        if conversion == "c" and isinstance(value, int):
+            value = chr(value & 0xFF)
+        try:
+            return ("%" + flags + (precision or "") + conversion) % value
+        except (TypeError, ValueError):
+            return str(value)
+
+    return CONVERSION.sub(replace, fmt)
+
+
+def decode_record(data, log_map):
+    """Renders binary record as text."""
+    level = data[1]
+    (format_id,) = struct.unpack_from("<I", data, 2)
+    entry = log_map.get("%08x" % format_id)
+    args = decode_args(data, 6)
+    if entry is None:
+        return level, "<unknown log id %08x> %s" % (format_id, args)
+    return level, render(entry["format"], args)
+
+
+def format_record(data, log_map):
+    """Renders binary record as a colored line."""
+    level, text = decode_record(data, log_map)
+    return LEVEL_COLORS.get(level, Colors.Default) + LEVEL_NAMES.get(level, "?") + " " + text + Colors.End
+
+
+def print_dump(path, log_map):
+    """Prints saved log, decoding hex encoded binary records."""
+    with open(path, encoding="utf-8", errors="replace") as f:
+        for line in f.read().splitlines():
+            if line.startswith("#"):
+                print(format_record(bytes.fromhex(line[1:]), log_map))
+            else:
+                print(line)
+
+
+def load_log_map(path):
+    with open(path, encoding="utf-8") as f:
+        return json.load(f)
+
+
+def get_auth_cookie(host, password):
+    """Logs into the portal and returns the websocket auth cookie."""
+    connection = http.client.HTTPConnection(host, 80, timeout=10)
+    headers = {}
+    if password:
+        headers["Authorization"] = "Basic " + base64.b64encode(("admin:" + password).encode()).decode()
+    connection.request("GET", "/", headers=headers)
+    response = connection.getresponse()
+    cookie = response.getheader("Set-Cookie", "")
+    connection.close()
+    return cookie.split(";")[0]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Show ksIotFrameworkLib device logs with binary records decoded.")
+    parser.add_argument("map", help="log map generated at build time (ksf_log_map.json in the build directory)")
+    parser.add_argument("host", nargs="?")
+    parser.add_argument("--password", help="portal password")
+    parser.add_argument("--dump", help="render saved log instead of connecting to the device")
+    args = parser.parse_args()
+
+    log_map = load_log_map(args.map)
+    if args.dump:
+        print_dump(args.dump, log_map)
+        return
+    if not args.host:
+        parser.error("host is required")
+
+    import websocket
+
+    ws = websocket.create_connection("ws://%s:81/" % args.host, cookie=get_auth_cookie(args.host, args.password))
+
+    # Logs are sent only while the terminal keeps them alive.
+    stop = threading.Event()
+
+    def keep_alive():
+        while not stop.is_set():
+            ws.send("0|logKeepAlive")
+            stop.wait(4.0)
+
+    threading.Thread(target=keep_alive, daemon=True).start()
+
+    try:
+        while True:
+            opcode, data = ws.recv_data()
+            if opcode == websocket.ABNF.OPCODE_BINARY:
+                if len(data) >= 6 and data[0] == 0:
+                    print(format_record(data, log_map))
+            elif opcode == websocket.ABNF.OPCODE_TEXT:
+                text = data.decode("utf-8", errors="replace")
+                _, _, body = text.partition("\n")
+                print(body)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        stop.set()
+        ws.close()
+
+
+if __name__ == "__main__":
+    main()
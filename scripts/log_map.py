@@ -0,0 +1,103 @@
+# flake8: noqa
+# Copyright (c) 2020-2026, Krzysztof Strehlau
+# This file is part of the ksIotFrameworkLib IoT library.
+# All licensing information can be found inside LICENSE.md file
+# https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+"""
+Generates the map of binary log ids (KSF_LOG_BINARY=1) to their format strings.
+
+Sources are scanned for KSF_LOG_x calls with literal formats. Each format gets the same id as on the device
+(32-bit FNV-1a of the format, see ksf::logFormatId), so log_decoder.py can render the records.
+
+The map is generated by setup_library_env.py into the build directory (ksf_log_map.json) when KSF_LOG_BINARY is enabled.
+Usage: python log_map.py ksf_log_map.json source [source ...]
+"""
+import json
+import os
+import re
+import sys
+
+SOURCE_EXTENSIONS = (".c", ".cpp", ".h", ".hpp", ".ino")
+LEVELS = {"ERROR": 1, "WARN": 2, "INFO": 3, "DEBUG": 4, "TRACE": 5}
+
+LOG_CALL = re.compile(r'\bKSF_LOG_(ERROR|WARN|INFO|DEBUG|TRACE|AT)\s*\(\s*(?:([^,()"]+),\s*)?((?:"(?:[^"\\\n]|\\.)*"\s*)+)')
+STRING_LITERAL = re.compile(r'"((?:[^"\\\n]|\\.)*)"')
+ESCAPE = re.compile(r'\\(x[0-9a-fA-F]+|[0-7]{1,3}|.)')
+SIMPLE_ESCAPES = {"n": "\n", "t": "\t", "r": "\r", "a": "\a", "b": "\b", "f": "\f", "v": "\v", "\\": "\\", "'": "'", '"': '"', "?": "?"}
+
+
+def log_format_id(data):
+    """32-bit FNV-1a, must match ksf::logFormatId."""
+    value = 2166136261
+    for byte in data:
+        value = ((value ^ byte) * 16777619) & 0xFFFFFFFF
+    return value
+
+
+def unescape(literal):
+    """Decodes C string literal content into bytes."""
+    def replace(match):
+        escape = match.group(1)
+        if escape[0] == "x":
+            return chr(int(escape[1:], 16) & 0xFF)
+        if escape[0] in "01234567":
+            return chr(int(escape, 8) & 0xFF)
+        return SIMPLE_ESCAPES.get(escape, escape)
+    return ESCAPE.sub(replace, literal).encode("utf-8")
+
+
+def scan_file(path, log_map, collisions):
+    """Adds log formats found in the file to the map."""
+    with open(path, encoding="utf-8", errors="replace") as f:
+        source = f.read()
+
+    for match in LOG_CALL.finditer(source):
+        name, level, literals = match.groups()
+        data = b"".join(unescape(part) for part in STRING_LITERAL.findall(literals))
+        entry = {
+            "format": data.decode("utf-8", errors="replace"),
+            "level": LEVELS.get(name, (level or "").strip()),
+            "file": path,
+            "line": source.count("\n", 0, match.start()) + 1,
+        }
+
+        key = "%08x" % log_format_id(data)
+        previous = log_map.get(key)
+        if previous is not None and previous["format"] != entry["format"]:
+            collisions.append((key, previous, entry))
+        log_map.setdefault(key, entry)
+
+
+def generate_log_map(source_dirs):
+    """Scans the directories and returns the map and the list of id collisions."""
+    log_map = {}
+    collisions = []
+    for source_dir in source_dirs:
+        if os.path.isfile(source_dir):
+            scan_file(source_dir, log_map, collisions)
+        for root, _, files in os.walk(source_dir):
+            for name in sorted(files):
+                if name.endswith(SOURCE_EXTENSIONS):
+                    scan_file(os.path.join(root, name), log_map, collisions)
+    return log_map, collisions
+
+
+def write_log_map(path, source_dirs):
+    """Generates the map into the file. Returns the list of id collisions."""
+    log_map, collisions = generate_log_map(source_dirs)
+    with open(path, "w", encoding="utf-8") as f:
+        json.dump(log_map, f, indent=1, sort_keys=True)
+    return collisions
+
+
+def main():
+    if len(sys.argv) < 3:
+        sys.exit(__doc__)
+
+    collisions = write_log_map(sys.argv[1], sys.argv[2:])
+    for key, first, second in collisions:
+        print("Log id collision %s: %s:%d and %s:%d" % (key, first["file"], first["line"], second["file"], second["line"]))
+
+
+if __name__ == "__main__":
+    main()
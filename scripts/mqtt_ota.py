@@ -0,0 +1,119 @@
+# flake8: noqa
+# Copyright (c) 2020-2026, Krzysztof Strehlau
+# This file is part of the ksIotFrameworkLib IoT library.
+# All licensing information can be found inside LICENSE.md file
+# https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+"""
+Serves firmware update to a device running ksMqttOtaUpdater component, through the MQTT broker.
+
+The script asks the device for a nonce on "<prefix>ota/ctl", starts the update with a begin command
+authenticated by HMAC-SHA256 of "<nonce> <size> <md5> <encoding>" keyed with the secret shared with the device
+(--secret, or KSF_OTA_SECRET environment variable) and then answers chunk requests published by the device
+on "<prefix>ota/req". Each chunk is sent to "<prefix>ota/chunk" as offset and CRC-32 (little endian uint32)
+followed by the data. Progress and result are read from "<prefix>ota/progress" and "<prefix>ota/result".
+
+Compressed and delta images (ota_compress.py, ota_delta.py) need MD5 of the resulting image (--md5).
+
+Requires paho-mqtt (pip install paho-mqtt).
+Usage: python mqtt_ota.py broker.local device/prefix/ firmware.bin --secret ... [--encoding raw] [--md5 ...]
+"""
+import argparse
+import hashlib
+import hmac
+import os
+import struct
+import sys
+import threading
+import time
+import zlib
+
+import paho.mqtt.client as mqtt
+
+
+def make_chunks(image, offset, length, chunk_size):
+    """Splits requested range of the image into chunk messages."""
+    end = min(offset + length, len(image))
+    while offset < end:
+        data = image[offset:min(offset + chunk_size, end)]
+        yield struct.pack("<II", offset, zlib.crc32(data)) + data
+        offset += len(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Serve firmware update over MQTT for ksIotFrameworkLib devices.")
+    parser.add_argument("broker")
+    parser.add_argument("prefix", help="device prefix (with trailing slash)")
+    parser.add_argument("image", help="file to send (firmware, compressed firmware or delta patch)")
+    parser.add_argument("--port", type=int, default=1883)
+    parser.add_argument("--user")
+    parser.add_argument("--password")
+    parser.add_argument("--encoding", choices=["raw", "heatshrink", "delta"], default="raw")
+    parser.add_argument("--md5", help="MD5 of the resulting firmware (default: MD5 of the file, raw only)")
+    parser.add_argument("--secret", default=os.environ.get("KSF_OTA_SECRET"), help="secret shared with the device")
+    parser.add_argument("--timeout", type=float, default=120.0, help="seconds without any message from the device")
+    args = parser.parse_args()
+
+    with open(args.image, "rb") as f:
+        image = f.read()
+
+    if args.md5 is None and args.encoding != "raw":
+        sys.exit("--md5 of the resulting firmware is required for %s encoding." % args.encoding)
+    md5 = args.md5 or hashlib.md5(image).hexdigest()
+    if not args.secret:
+        sys.exit("--secret (or KSF_OTA_SECRET environment variable) is required.")
+
+    finished = threading.Event()
+    state = {"result": None, "last": time.time(), "sent": 0}
+
+    def on_connect(client, userdata, flags, rc, *extra):
+        for topic in ("ota/nonce", "ota/req", "ota/progress", "ota/result"):
+            client.subscribe(args.prefix + topic, qos=1)
+        client.publish(args.prefix + "ota/ctl", "nonce", qos=1)
+
+    def on_message(client, userdata, msg):
+        state["last"] = time.time()
+        topic = msg.topic[len(args.prefix):]
+        payload = msg.payload.decode(errors="replace")
+
+        if topic == "ota/nonce":
+            # Nonce is single use, so a reconnection during the transfer mustn't start the update again.
+            if state["sent"] == 0:
+                command = "%d %s %s" % (len(image), md5, args.encoding)
+                signature = hmac.new(args.secret.encode(), ("%s %s" % (payload, command)).encode(), hashlib.sha256)
+                client.publish(args.prefix + "ota/ctl", "begin %s %s" % (command, signature.hexdigest()), qos=1)
+        elif topic == "ota/req":
+            offset, length, chunk_size = (int(value) for value in payload.split())
+            for chunk in make_chunks(image, offset, length, chunk_size):
+                client.publish(args.prefix + "ota/chunk", chunk, qos=1)
+                state["sent"] += len(chunk)
+        elif topic == "ota/progress":
+            print("Progress: %s%%" % payload)
+        elif topic == "ota/result":
+            state["result"] = payload
+            finished.set()
+
+    client = mqtt.Client()
+    if args.user:
+        client.username_pw_set(args.user, args.password)
+    client.on_connect = on_connect
+    client.on_message = on_message
+    client.connect(args.broker, args.port)
+    client.loop_start()
+
+    started = time.time()
+    while not finished.wait(1.0):
+        if time.time() - state["last"] > args.timeout:
+            state["result"] = "error: no response from the device"
+            break
+
+    client.loop_stop()
+    client.disconnect()
+
+    elapsed = max(time.time() - started, 0.001)
+    print("Result: %s" % state["result"])
+    print("Sent %d bytes in %.1f s (%.1f KB/s)" % (state["sent"], elapsed, state["sent"] / elapsed / 1024))
+    sys.exit(0 if state["result"] == "ok" else 1)
+
+
+if __name__ == "__main__":
+    main()
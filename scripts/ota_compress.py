@@ -0,0 +1,183 @@
+# flake8: noqa
+# Copyright (c) 2020-2026, Krzysztof Strehlau
+# This file is part of the ksIotFrameworkLib IoT library.
+# All licensing information can be found inside LICENSE.md file
+# https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+"""
+Compresses firmware image for ksDevicePortal OTA upload (compression=heatshrink).
+
+The output is a heatshrink (LZSS) stream prefixed with a 4 byte header: "KSH" and a byte holding
+window bits (upper nibble) and lookahead bits (lower nibble). Upload it with the MD5 of the original
+(uncompressed) image, because the device verifies what it writes to flash.
+
+Output that is not smaller than the input is refused (upload the raw image then), unless --force is given.
+
+Usage: python ota_compress.py firmware.bin firmware.bin.hs [--window 11] [--lookahead 4] [--force]
+"""
+import argparse
+import hashlib
+import sys
+
+MAX_WINDOW_BITS = 12
+MAX_CANDIDATES = 64
+
+
+class BitWriter:
+    """Collects bits MSB first."""
+
+    def __init__(self):
+        self.out = bytearray()
+        self.acc = 0
+        self.count = 0
+
+    def push(self, value, bits):
+        self.acc = (self.acc << bits) | (value & ((1 << bits) - 1))
+        self.count += bits
+        while self.count >= 8:
+            self.count -= 8
+            self.out.append((self.acc >> self.count) & 0xFF)
+        self.acc &= (1 << self.count) - 1
+
+    def finish(self):
+        if self.count:
+            self.out.append(self.acc << (8 - self.count))
+        return bytes(self.out)
+
+
+class BitReader:
+    """Reads bits MSB first, one input byte at a time."""
+
+    def __init__(self, data, pos=0):
+        self.data = data
+        self.pos = pos
+        self.acc = 0
+        self.count = 0
+
+    def remaining(self):
+        return (len(self.data) - self.pos) * 8 + self.count
+
+    def take(self, bits):
+        while self.count < bits:
+            self.acc = (self.acc << 8) | self.data[self.pos]
+            self.pos += 1
+            self.count += 8
+        self.count -= bits
+        value = self.acc >> self.count
+        self.acc &= (1 << self.count) - 1
+        return value
+
+
+def compress(data, window_bits, lookahead_bits):
+    """
+    Compresses data into heatshrink stream (with header).
+
+    Args:
+        data: Input bytes
+        window_bits: Window size bits (backreference distance)
+        lookahead_bits: Lookahead bits (backreference length)
+    """
+    window = 1 << window_bits
+    max_len = 1 << lookahead_bits
+    backref_bits = 1 + window_bits + lookahead_bits
+    writer = BitWriter()
+    chains = {}
+    pos = 0
+
+    while pos < len(data):
+        best_len = 0
+        best_dist = 0
+        key = data[pos:pos + 3]
+        if len(key) == 3:
+            for cand in reversed(chains.get(key, ())):
+                dist = pos - cand
+                if dist > window:
+                    break
+                length = 0
+                while length < max_len and pos + length < len(data) and data[cand + length] == data[pos + length]:
+                    length += 1
+                if length > best_len:
+                    best_len = length
+                    best_dist = dist
+                    if length == max_len:
+                        break
+
+        # Backreference must be cheaper than the literals it replaces.
+        step = 1
+        if best_len * 9 > backref_bits:
+            writer.push(0, 1)
+            writer.push(best_dist - 1, window_bits)
+            writer.push(best_len - 1, lookahead_bits)
+            step = best_len
+        else:
+            writer.push(1, 1)
+            writer.push(data[pos], 8)
+
+        for i in range(pos, pos + step):
+            if i + 3 <= len(data):
+                chain = chains.setdefault(data[i:i + 3], [])
+                chain.append(i)
+                if len(chain) > MAX_CANDIDATES:
+                    del chain[0]
+        pos += step
+
+    return b"KSH" + bytes([(window_bits << 4) | lookahead_bits]) + writer.finish()
+
+
+def decompress(stream):
+    """Reference decompressor, used to verify the output."""
+    window_bits, lookahead_bits = stream[3] >> 4, stream[3] & 0x0F
+    reader = BitReader(stream, 4)
+    out = bytearray()
+
+    while reader.remaining() > 0:
+        if reader.take(1):
+            if reader.remaining() < 8:
+                break
+            out.append(reader.take(8))
+        else:
+            if reader.remaining() < window_bits + lookahead_bits:
+                break
+            dist = reader.take(window_bits) + 1
+            count = reader.take(lookahead_bits) + 1
+            start = len(out) - dist
+            if count <= dist:
+                out += out[start:start + count]
+            else:
+                for i in range(start, start + count):
+                    out.append(out[i])
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compress firmware image for ksIotFrameworkLib OTA.")
+    parser.add_argument("input")
+    parser.add_argument("output")
+    parser.add_argument("--window", type=int, default=11, help="window bits (8-%d)" % MAX_WINDOW_BITS)
+    parser.add_argument("--lookahead", type=int, default=4, help="lookahead bits (3 to window-1)")
+    parser.add_argument("--force", action="store_true", help="write the output even if it is not smaller than the input")
+    args = parser.parse_args()
+
+    if not 8 <= args.window <= MAX_WINDOW_BITS or not 3 <= args.lookahead < args.window:
+        sys.exit("Invalid window/lookahead bits.")
+
+    with open(args.input, "rb") as f:
+        data = f.read()
+
+    stream = compress(data, args.window, args.lookahead)
+    if decompress(stream) != data:
+        sys.exit("Verification failed.")
+
+    # Already compressed or random data only grows, the device would then download and write more than the raw image.
+    if len(stream) >= len(data) and not args.force:
+        sys.exit("Compressed image is not smaller than the input (%d -> %d bytes), upload the raw image instead "
+                 "(or use --force)." % (len(data), len(stream)))
+
+    with open(args.output, "wb") as f:
+        f.write(stream)
+
+    print("Compressed %d -> %d bytes (%.1f%%)" % (len(data), len(stream), 100.0 * len(stream) / max(len(data), 1)))
+    print("size=%d md5=%s" % (len(stream), hashlib.md5(data).hexdigest()))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,164 @@
+# flake8: noqa
+# Copyright (c) 2020-2026, Krzysztof Strehlau
+# This file is part of the ksIotFrameworkLib IoT library.
+# All licensing information can be found inside LICENSE.md file
+# https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+"""
+Generates delta (binary diff) firmware update for ksDevicePortal OTA upload (compression=delta).
+
+The patch turns the firmware currently running on the device (old image) into the new one. Device checks
+MD5 of its running firmware against the patch header before applying it and MD5 of the result before
+marking it bootable. The patch is compressed with heatshrink (see ota_compress.py).
+
+Delta that is not smaller than the new image is refused, unless --force is given.
+
+Usage: python ota_delta.py old.bin new.bin update.delta [--window 11] [--lookahead 4] [--force]
+"""
+import argparse
+import collections
+import hashlib
+import os
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from ota_compress import compress, decompress, MAX_WINDOW_BITS
+
+SEED_SIZE = 8
+SCORE_WINDOW = 32
+MIN_SCORE = SCORE_WINDOW // 2
+
+
+def build_index(old):
+    """Maps each SEED_SIZE long substring of the old image to its first position."""
+    index = {}
+    for i in range(len(old) - SEED_SIZE + 1):
+        index.setdefault(old[i:i + SEED_SIZE], i)
+    return index
+
+
+def extend(old, new, old_pos, new_pos):
+    """
+    Extends approximate match forward, allowing for mismatches (e.g. changed addresses in the code).
+
+    Returns length of the match, ending on the last matching byte.
+    """
+    length = 0
+    last_good = 0
+    # Only the last SCORE_WINDOW results are scored, older ones are dropped as the match grows.
+    history = collections.deque(maxlen=SCORE_WINDOW + 1)
+    score = 0
+    while old_pos + length < len(old) and new_pos + length < len(new):
+        same = old[old_pos + length] == new[new_pos + length]
+        history.append(same)
+        score += same
+        if len(history) > SCORE_WINDOW:
+            score -= history[-SCORE_WINDOW - 1]
+        length += 1
+        if same:
+            last_good = length
+        if len(history) >= SCORE_WINDOW and score < MIN_SCORE:
+            break
+    return last_good
+
+
+def diff(old, new):
+    """
+    Builds list of records: (old_start, new_start, diff_length, extra_length).
+
+    Each record patches diff_length bytes of the old image starting at old_start, then copies extra_length
+    bytes of the new image as they are.
+    """
+    index = build_index(old)
+    records = []
+    cur_old, cur_new, cur_len = 0, 0, 0
+    offset = 0
+    pos = 0
+
+    while pos + SEED_SIZE <= len(new):
+        seed = new[pos:pos + SEED_SIZE]
+        hint = pos + offset
+        if 0 <= hint and old[hint:hint + SEED_SIZE] == seed:
+            match = hint
+        else:
+            match = index.get(seed)
+        if match is None:
+            pos += 1
+            continue
+
+        length = extend(old, new, match, pos)
+        records.append((cur_old, cur_new, cur_len, pos - cur_new - cur_len))
+        cur_old, cur_new, cur_len = match, pos, length
+        offset = match - pos
+        pos += length
+
+    records.append((cur_old, cur_new, cur_len, len(new) - cur_new - cur_len))
+    return records
+
+
+def build_patch(old, new):
+    """Serializes the patch (uncompressed)."""
+    records = diff(old, new)
+    out = bytearray(b"KSD1")
+    out += struct.pack("<II", len(old), len(new))
+    out += hashlib.md5(old).digest() + hashlib.md5(new).digest()
+
+    for i, (old_start, new_start, diff_len, extra_len) in enumerate(records):
+        next_old = records[i + 1][0] if i + 1 < len(records) else old_start + diff_len
+        out += struct.pack("<IIi", diff_len, extra_len, next_old - (old_start + diff_len))
+        out += bytes((new[new_start + k] - old[old_start + k]) & 0xFF for k in range(diff_len))
+        out += new[new_start + diff_len:new_start + diff_len + extra_len]
+    return bytes(out)
+
+
+def apply_patch(old, patch):
+    """Reference patch applier, used to verify the output."""
+    old_size, new_size = struct.unpack_from("<II", patch, 4)
+    pos, old_pos = 44, 0
+    out = bytearray()
+    while len(out) < new_size:
+        diff_len, extra_len, seek = struct.unpack_from("<IIi", patch, pos)
+        pos += 12
+        out += bytes((old[old_pos + k] + patch[pos + k]) & 0xFF for k in range(diff_len))
+        pos += diff_len
+        old_pos += diff_len
+        out += patch[pos:pos + extra_len]
+        pos += extra_len
+        old_pos += seek
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate delta firmware update for ksIotFrameworkLib OTA.")
+    parser.add_argument("old", help="firmware running on the device")
+    parser.add_argument("new", help="new firmware")
+    parser.add_argument("output")
+    parser.add_argument("--window", type=int, default=11, help="window bits (8-%d)" % MAX_WINDOW_BITS)
+    parser.add_argument("--lookahead", type=int, default=4, help="lookahead bits (3 to window-1)")
+    parser.add_argument("--force", action="store_true", help="write the output even if it is not smaller than the new image")
+    args = parser.parse_args()
+
+    with open(args.old, "rb") as f:
+        old = f.read()
+    with open(args.new, "rb") as f:
+        new = f.read()
+
+    patch = build_patch(old, new)
+    stream = compress(patch, args.window, args.lookahead)
+    if decompress(stream) != patch or apply_patch(old, patch) != new:
+        sys.exit("Verification failed.")
+
+    # Unrelated images give a patch bigger than the image itself, the full image is cheaper to send then.
+    if len(stream) >= len(new) and not args.force:
+        sys.exit("Delta is not smaller than the new image (%d -> %d bytes), upload the new image instead "
+                 "(or use --force)." % (len(new), len(stream)))
+
+    with open(args.output, "wb") as f:
+        f.write(stream)
+
+    print("Delta %d -> %d bytes (%.1f%% of the new image)" % (len(new), len(stream), 100.0 * len(stream) / max(len(new), 1)))
+    print("size=%d" % len(stream))
+
+
+if __name__ == "__main__":
+    main()
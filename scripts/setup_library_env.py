@@ -34,7 +34,43 @@ try:
 		e.ProcessFlags("-Wstrict-aliasing")           # Warn about strict aliasing violations
 		e.ProcessFlags("-Wextra")                     # Enable additional warnings beyond -Wall
 	ks_print_log(Colors.Magenta, "Successfully tweaked platform settings for [" + str(len(environments)) + "] environments.")
-	ks_print_log(Colors.Green, "Extra script finished.")
 except BaseException as err:
+	environments = []
 	ks_print_log(Colors.Red, "Error while executing script. Are you on newest platformio core?")
 	ks_print_log(Colors.Yellow, str(err))
+
+def is_log_binary_enabled(environments):
+	"""Checks if any environment defines KSF_LOG_BINARY to a non-zero value (e.g. -DKSF_LOG_BINARY=1 in build_flags)."""
+	for e in environments:
+		defines = e.get("CPPDEFINES", [])
+		if isinstance(defines, dict):
+			defines = defines.items()
+		elif isinstance(defines, str):
+			defines = [defines]
+		for define in defines:
+			if isinstance(define, str):
+				name, _, value = define.partition("=")
+			elif isinstance(define, (list, tuple)) and define:
+				name, value = define[0], define[1] if len(define) > 1 else ""
+			else:
+				continue
+			if name == "KSF_LOG_BINARY":
+				return str(value).strip() != "0"
+	return False
+
+# Format strings are kept only in the map when records are binary, text logs don't need it.
+if is_log_binary_enabled(environments):
+	try:
+		from log_map import write_log_map
+		import os
+		log_sources = [env.subst("$PROJECT_SRC_DIR"), env.subst("$PROJECT_INCLUDE_DIR")] + [lb.src_dir for lb in env.GetLibBuilders()]
+		log_map_path = os.path.join(env.subst("$BUILD_DIR"), "ksf_log_map.json")
+		os.makedirs(os.path.dirname(log_map_path), exist_ok=True)
+		for key, first, second in write_log_map(log_map_path, [path for path in log_sources if os.path.isdir(path)]):
+			ks_print_log(Colors.Yellow, "Log id collision " + key + ": " + first["file"] + " and " + second["file"])
+		ks_print_log(Colors.Magenta, "Binary log map written to " + log_map_path + ".")
+	except BaseException as err:
+		ks_print_log(Colors.Red, "Error while generating binary log map (KSF_LOG_BINARY=1), log_decoder.py won't be able to render logs of this build.")
+		ks_print_log(Colors.Yellow, str(err))
+
+ks_print_log(Colors.Green, "Extra script finished.")
@@ -12,12 +12,14 @@
 #include "ksf/comp/ksConfigProvider.h"
 #include "ksf/comp/ksLed.h"
 #include "ksf/comp/ksResetButton.h"
+#include "ksf/comp/ksSerialLogger.h"
 #include "ksf/comp/ksMqttConfigProvider.h"
 #include "ksf/comp/ksMqttConnector.h"
 #include "ksf/comp/ksWifiConfigurator.h"
 #include "ksf/comp/ksWifiConnector.h"
 #include "ksf/comp/ksDevicePortal.h"
 #include "ksf/comp/ksDevStatMqttReporter.h"
+#include "ksf/comp/ksMqttOtaUpdater.h"
 #include "ksf/ksAppRotator.h"
 #include "ksf/ksApplication.h"
 #include "ksf/ksComponent.h"
@@ -25,4 +27,5 @@
 #include "ksf/misc/ksConfig.h"
 #include "ksf/misc/ksSimpleTimer.h"
 #include "ksf/misc/ksDomainQuery.h"
-#include "ksf/ksConstants.h"
\ No newline at end of file
+#include "ksf/ksConstants.h"
+#include "ksf/ksLog.h"
\ No newline at end of file
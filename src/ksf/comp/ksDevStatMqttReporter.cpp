@@ -8,15 +8,21 @@
  */
 
 #include <Arduino.h>
+#include <limits>
 
 #include "../ksConstants.h"
 #include "../ksApplication.h"
 #include "ksMqttConnector.h"
+#include "../misc/ksMqttClient.h"
+#include "../misc/ksStatWriter.h"
+#include "../misc/ksStatFilter.h"
+#include "../misc/ksLogRing.h"
+#include "../misc/ksLoopWatchdog.h"
 #if defined(ESP32)
 	#include <WiFi.h>
 #elif defined(ESP8266)
 	#include <ESP8266WiFi.h>
-#else			
+#else
 	#error Platform not implemented.
 #endif
 
@@ -24,14 +30,141 @@
 
 namespace ksf::comps
 {
-	static constexpr char RSSI_TOPIC[] 			PROGMEM {"dstat/rssi"};
-	static constexpr char UPTIME_TOPIC[] 		PROGMEM {"dstat/uptimeSec"};
-	static constexpr char CONN_TIME_TOPIC[] 	PROGMEM {"dstat/connTimeSec"};
-	static constexpr char RECONN_CNT_TOPIC[] 	PROGMEM {"dstat/reconnCnt"};
+	static constexpr char DSTAT_TOPIC_PREFIX[] 	PROGMEM {"dstat/"};
+	static constexpr char JSON_REPORT_TOPIC[] 	PROGMEM {"dstat/json"};
+	static constexpr char CBOR_REPORT_TOPIC[] 	PROGMEM {"dstat/cbor"};
+	static constexpr char PREV_LOG_TOPIC[] 		PROGMEM {"dstat/prevLog"};
 
-	ksDevStatMqttReporter::ksDevStatMqttReporter(uint8_t intervalInSeconds) 
-		: reporterTimer(KSF_SEC_TO_MS(intervalInSeconds))
-	{}
+	static constexpr char RSSI_STAT[] 			PROGMEM {"rssi"};
+	static constexpr char UPTIME_STAT[] 		PROGMEM {"uptimeSec"};
+	static constexpr char CONN_TIME_STAT[] 		PROGMEM {"connTimeSec"};
+	static constexpr char RECONN_CNT_STAT[] 	PROGMEM {"reconnCnt"};
+	static constexpr char LOOP_STALLS_STAT[] 	PROGMEM {"loopStalls"};
+
+	static constexpr char MQTT_GROUP[] 			PROGMEM {"mqtt"};
+	static constexpr char MQTT_BYTES_IN_STAT[] 	PROGMEM {"bytesIn"};
+	static constexpr char MQTT_BYTES_OUT_STAT[] PROGMEM {"bytesOut"};
+	static constexpr char MQTT_MSG_IN_STAT[] 	PROGMEM {"msgIn"};
+	static constexpr char MQTT_MSG_OUT_STAT[] 	PROGMEM {"msgOut"};
+	static constexpr char MQTT_PUB_FAIL_STAT[] 	PROGMEM {"pubFail"};
+	static constexpr char MQTT_CONN_MS_STAT[] 	PROGMEM {"connMs"};
+	static constexpr char MQTT_PING_MS_STAT[] 	PROGMEM {"pingMs"};
+	static constexpr char MQTT_LOOP_MAX_US_STAT[] PROGMEM {"loopMaxUs"};
+#if KSF_MQTT_LOOP_TIME_HISTOGRAM
+	static constexpr char MQTT_LOOP_HIST_STAT[] PROGMEM {"loopHist"};
+#endif
+
+	/* Threshold of stats that grow all the time, they are reported on heartbeat only. */
+	static constexpr float HEARTBEAT_ONLY{std::numeric_limits<float>::infinity()};
+
+	/*!
+		@brief Built-in stat provider.
+	*/
+	struct ksDevStatProvider
+	{
+		const char* name;								//!< Name of the stat.
+		float threshold;								//!< Default change threshold used in delta reporting.
+		int64_t (*getValue)(ksMqttConnector& mqttConn);	//!< Function that retrieves the value.
+	};
+
+	/* Registry of device stats, reported in this order. */
+	static constexpr ksDevStatProvider DEV_STAT_PROVIDERS[]
+	{
+		{RSSI_STAT, 3.0f, [](ksMqttConnector&) -> int64_t { return WiFi.RSSI(); }},
+		{UPTIME_STAT, HEARTBEAT_ONLY, [](ksMqttConnector&) -> int64_t { return ksf::millis64()/1000; }},
+		{CONN_TIME_STAT, HEARTBEAT_ONLY, [](ksMqttConnector& mqttConn) -> int64_t { return mqttConn.getConnectionTimeSeconds(); }},
+		{RECONN_CNT_STAT, 0.0f, [](ksMqttConnector& mqttConn) -> int64_t { return mqttConn.getReconnectCounter(); }},
+		{LOOP_STALLS_STAT, 0.0f, [](ksMqttConnector&) -> int64_t { return misc::ksLoopWatchdog::getStallCount(); }}
+	};
+
+	/* Registry of MQTT health stats (reported inside "mqtt" group), reported in this order. */
+	static constexpr ksDevStatProvider MQTT_STAT_PROVIDERS[]
+	{
+		{MQTT_BYTES_IN_STAT, HEARTBEAT_ONLY, [](ksMqttConnector& mqttConn) -> int64_t { return mqttConn.getClientStats().bytesIn; }},
+		{MQTT_BYTES_OUT_STAT, HEARTBEAT_ONLY, [](ksMqttConnector& mqttConn) -> int64_t { return mqttConn.getClientStats().bytesOut; }},
+		{MQTT_MSG_IN_STAT, HEARTBEAT_ONLY, [](ksMqttConnector& mqttConn) -> int64_t { return mqttConn.getClientStats().messagesIn; }},
+		{MQTT_MSG_OUT_STAT, HEARTBEAT_ONLY, [](ksMqttConnector& mqttConn) -> int64_t { return mqttConn.getClientStats().messagesOut; }},
+		{MQTT_PUB_FAIL_STAT, 0.0f, [](ksMqttConnector& mqttConn) -> int64_t { return mqttConn.getClientStats().publishFailures; }},
+		{MQTT_CONN_MS_STAT, 0.0f, [](ksMqttConnector& mqttConn) -> int64_t { return mqttConn.getStats().connectDurationMs; }},
+		{MQTT_PING_MS_STAT, 50.0f, [](ksMqttConnector& mqttConn) -> int64_t { return mqttConn.getClientStats().pingRoundTripMs; }},
+		{MQTT_LOOP_MAX_US_STAT, 1000.0f, [](ksMqttConnector& mqttConn) -> int64_t { return mqttConn.getStats().loopTimeMaxUs; }}
+	};
+
+	/*!
+		@brief Stat writer that publishes each value to its own topic as text.
+
+		Groups are mapped to subtopics, so value "bytesIn" inside group "mqtt" is published to "dstat/mqtt/bytesIn".
+	*/
+	class ksTopicStatWriter : public misc::ksStatWriter
+	{
+		protected:
+			ksMqttConnector& mqttConn;		//!< Reference to the MQTT connector.
+			std::string topicPrefix;		//!< Topic prefix of the current group.
+
+			/*!
+				@brief Publishes the value to the topic of the current group.
+				@param name Name of the value.
+				@param value Value in text form.
+			*/
+			void publish(std::string_view name, const std::string& value)
+			{
+				auto topic{topicPrefix};
+				topic.append(name);
+				mqttConn.publish(topic, value);
+			}
+
+		public:
+			/*!
+				@brief Constructs the topic stat writer.
+				@param mqttConn Reference to the MQTT connector.
+				@param rootPrefix Topic prefix of the root group (must end with a slash).
+			*/
+			ksTopicStatWriter(ksMqttConnector& mqttConn, std::string_view rootPrefix)
+				: mqttConn(mqttConn), topicPrefix(rootPrefix)
+			{}
+
+			void beginGroup(std::string_view name) override
+			{
+				topicPrefix.append(name);
+				topicPrefix += '/';
+			}
+
+			void endGroup() override
+			{
+				/* Remove the last "name/" segment. */
+				auto slashPos{topicPrefix.rfind('/', topicPrefix.size() - 2)};
+				topicPrefix.resize(slashPos == std::string::npos ? 0 : slashPos + 1);
+			}
+
+			void addInt(std::string_view name, int64_t value) override
+			{
+				publish(name, ksf::to_string(value));
+			}
+
+			void addUnsigned(std::string_view name, uint64_t value) override
+			{
+				publish(name, ksf::to_string(value));
+			}
+
+			void addFloat(std::string_view name, double value, uint8_t decimals) override
+			{
+				publish(name, ksf::to_string(value, decimals));
+			}
+
+			void addString(std::string_view name, std::string_view value) override
+			{
+				publish(name, std::string(value));
+			}
+	};
+
+	ksDevStatMqttReporter::ksDevStatMqttReporter(uint8_t intervalInSeconds, bool reportMqttStats, ReportFormat reportFormat)
+		: reporterTimer(KSF_SEC_TO_MS(intervalInSeconds)), reportFormat(reportFormat)
+	{
+		bitflags.mqttStatsEnabled = reportMqttStats;
+
+		if (reportFormat != ReportFormat::Topics)
+			compactBuffer = std::make_unique<uint8_t[]>(KSF_DEVSTAT_COMPACT_BUFFER_SIZE);
+	}
 
 	bool ksDevStatMqttReporter::postInit(ksApplication* app)
 	{
@@ -42,26 +175,160 @@ namespace ksf::comps
 
 		return true;
 	}
-	
+
 	void ksDevStatMqttReporter::onConnected()
 	{
 		reporterTimer.restart();
+
+		/* Broker might have lost the previous values, so start with a full report. */
+		statFilter.reset();
+
+#if APP_LOG_ENABLED
+		if (auto mqttConnSp{mqttConnWp.lock()})
+			publishPreviousLog(*mqttConnSp);
+#endif
+	}
+
+#if APP_LOG_ENABLED
+	void ksDevStatMqttReporter::publishPreviousLog(ksMqttConnector& mqttConn)
+	{
+		/* Once per boot, the component itself is created again after application rotation. */
+		static bool previousLogPublished{false};
+
+		auto previousLogRing{ksApplication::getPreviousLogRing()};
+		if (previousLogPublished || !previousLogRing)
+			return;
+
+		/* The log is streamed line by line. First pass only counts the bytes, so the whole log is never held in memory. */
+		std::string header{PSTR("Reset reason: ")};
+		header += ksf::getResetReason();
+
+		uint32_t payloadLength{static_cast<uint32_t>(header.size())};
+		std::string entry, line;
+		for (auto cursor{previousLogRing->begin()}; entry.clear(), previousLogRing->read(cursor, entry);)
+		{
+			line.assign(1, '\n');
+			misc::ksLogRing::appendAsText(entry, line);
+			payloadLength += line.size();
+		}
+
+		if (!mqttConn.beginPublish(PREV_LOG_TOPIC, payloadLength) || !mqttConn.write(header))
+			return;
+
+		for (auto cursor{previousLogRing->begin()}; entry.clear(), previousLogRing->read(cursor, entry);)
+		{
+			line.assign(1, '\n');
+			misc::ksLogRing::appendAsText(entry, line);
+			if (!mqttConn.write(line))
+				return;
+		}
+
+		previousLogPublished = mqttConn.endPublish();
+	}
+#endif
+
+	void ksDevStatMqttReporter::enableDeltaReporting(uint16_t heartbeatIntervalInSeconds)
+	{
+		bitflags.deltaReporting = true;
+		heartbeatTimer.setInterval(KSF_SEC_TO_MS(heartbeatIntervalInSeconds));
+
+		for (const auto& provider : DEV_STAT_PROVIDERS)
+			statFilter.setThreshold(provider.name, provider.threshold);
+
+		std::string path{MQTT_GROUP};
+		path += '/';
+		for (const auto& provider : MQTT_STAT_PROVIDERS)
+			statFilter.setThreshold(path + provider.name, provider.threshold);
+#if KSF_MQTT_LOOP_TIME_HISTOGRAM
+		statFilter.setThreshold(path + MQTT_LOOP_HIST_STAT, HEARTBEAT_ONLY);
+#endif
 	}
 
-	void ksDevStatMqttReporter::reportDevStats() const
+	void ksDevStatMqttReporter::setStatThreshold(std::string_view path, float threshold)
+	{
+		statFilter.setThreshold(path, threshold);
+	}
+
+	void ksDevStatMqttReporter::collectDevStats(ksMqttConnector& mqttConn, misc::ksStatWriter& writer) const
+	{
+		for (const auto& provider : DEV_STAT_PROVIDERS)
+			writer.addInt(provider.name, provider.getValue(mqttConn));
+
+		if (bitflags.mqttStatsEnabled)
+			collectMqttStats(mqttConn, writer);
+
+		onCollectCustomStats->broadcast(writer);
+	}
+
+	void ksDevStatMqttReporter::collectMqttStats(ksMqttConnector& mqttConn, misc::ksStatWriter& writer) const
+	{
+		writer.beginGroup(MQTT_GROUP);
+
+		for (const auto& provider : MQTT_STAT_PROVIDERS)
+			writer.addInt(provider.name, provider.getValue(mqttConn));
+
+#if KSF_MQTT_LOOP_TIME_HISTOGRAM
+		/* Histogram is reported as comma separated bucket counters. */
+		const auto& connStats{mqttConn.getStats()};
+		std::string histogram;
+		for (uint8_t bucket{0}; bucket < KSF_MQTT_LOOP_TIME_HISTOGRAM_BUCKETS; ++bucket)
+		{
+			if (bucket > 0)
+				histogram += ',';
+			ksf::append_to_string(histogram, connStats.loopTimeHistogram[bucket]);
+		}
+		writer.addString(MQTT_LOOP_HIST_STAT, histogram);
+#endif
+
+		writer.endGroup();
+	}
+
+	bool ksDevStatMqttReporter::writeDevStats(ksMqttConnector& mqttConn, misc::ksStatWriter& writer, bool heartbeat)
+	{
+		if (!bitflags.deltaReporting)
+		{
+			collectDevStats(mqttConn, writer);
+			return true;
+		}
+
+		misc::ksFilteredStatWriter filteredWriter{writer, statFilter, heartbeat};
+		collectDevStats(mqttConn, filteredWriter);
+		return filteredWriter.getForwardedCount() > 0;
+	}
+
+	void ksDevStatMqttReporter::reportDevStats()
 	{
 		auto mqttConnSp{mqttConnWp.lock()};
 		if (!mqttConnSp || !mqttConnSp->isConnected())
 			return;
 
-		mqttConnSp->publish(RSSI_TOPIC, ksf::to_string(WiFi.RSSI()));
-		mqttConnSp->publish(UPTIME_TOPIC, ksf::to_string(ksf::millis64()/1000));
-		mqttConnSp->publish(CONN_TIME_TOPIC, ksf::to_string(mqttConnSp->getConnectionTimeSeconds()));
-		mqttConnSp->publish(RECONN_CNT_TOPIC, ksf::to_string(mqttConnSp->getReconnectCounter()));
+		auto heartbeat{heartbeatTimer.triggered()};
+
+		if (reportFormat == ReportFormat::Topics)
+		{
+			ksTopicStatWriter writer{*mqttConnSp, DSTAT_TOPIC_PREFIX};
+			writeDevStats(*mqttConnSp, writer, heartbeat);
+		}
+		else
+		{
+			auto format{reportFormat == ReportFormat::Json ? misc::ksCompactStatWriter::Format::Json : misc::ksCompactStatWriter::Format::Cbor};
+			misc::ksCompactStatWriter writer{format, compactBuffer.get(), KSF_DEVSTAT_COMPACT_BUFFER_SIZE};
+
+			writer.begin();
+			auto anyValueWritten{writeDevStats(*mqttConnSp, writer, heartbeat)};
+
+			/* Document is sent straight from the buffer. If it didn't fit or nothing changed, the report is skipped. */
+			if (writer.end() && anyValueWritten)
+			{
+				auto document{writer.getDocument()};
+				auto topic{format == misc::ksCompactStatWriter::Format::Json ? JSON_REPORT_TOPIC : CBOR_REPORT_TOPIC};
+				mqttConnSp->publish(topic, reinterpret_cast<const uint8_t*>(document.data()), document.size());
+			}
+		}
 
 		onReportCustomStats->broadcast(mqttConnSp);
 	}
-	
+
 	bool ksDevStatMqttReporter::loop([[maybe_unused]] ksApplication* app)
 	{
 		if (reporterTimer.triggered())
@@ -69,4 +336,4 @@ namespace ksf::comps
 
 		return true;
 	}
-}
\ No newline at end of file
+}
@@ -10,11 +10,13 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 
 #include "../evt/ksEvent.h"
 #include "../ksComponent.h"
 
 #include "../misc/ksSimpleTimer.h"
+#include "../misc/ksStatFilter.h"
 
 namespace ksf::comps
 {
@@ -28,15 +30,51 @@ namespace ksf::comps
 
 		Each update includes values such as RSSI, device uptime, connection time, and IP address. 
 		The subtopic used is "dstat" so, for example, RSSI is published to the topic "deviceprefix/dstat/rssi".
+
+		With KSF_LOG_PERSISTENT, the log from before a software reset (e.g. watchdog) is published once after boot
+		to "dstat/prevLog", as the reset reason followed by the log lines.
+
+		Optionally, MQTT connection health metrics (traffic counters, publish failures, connect time, 
+		ping round-trip time and loop time) are published under "dstat/mqtt/" subtopic.
+
+		In compact mode, all the stats (including those added through onCollectCustomStats) are encoded into a single 
+		JSON or CBOR document and sent as one message to "dstat/json" or "dstat/cbor" topic respectively. The document 
+		is built in a buffer of KSF_DEVSTAT_COMPACT_BUFFER_SIZE bytes, allocated once. If it doesn't fit, the report is skipped.
+
+		With delta reporting enabled, a stat is reported only if it changed by at least its threshold since the last report.
+		Every stat is reported on each heartbeat and after (re)connection to the broker. Built-in stats come with default 
+		thresholds (e.g. 3 dBm for RSSI, uptime on heartbeat only), custom stats report any change unless configured otherwise.
 	*/
 	class ksDevStatMqttReporter : public ksComponent
 	{
 		KSF_RTTI_DECLARATIONS(ksDevStatMqttReporter, ksComponent)
 
+		public:
+			/*!
+				@brief Format of the reports.
+			*/
+			enum class ReportFormat : uint8_t
+			{
+				Topics,		//!< Each stat is published to its own topic as text.
+				Json,		//!< All stats are published as a single JSON document.
+				Cbor		//!< All stats are published as a single CBOR document.
+			};
+
 		protected:
 			std::weak_ptr<ksMqttConnector> mqttConnWp;				//!< Weak pointer to MQTT connector.
 			std::unique_ptr<evt::ksEventHandle> connEventHandle;	//!< Event handle for connection delegate.
 			misc::ksSimpleTimer reporterTimer;						//!< Timer to report device stats.
+			misc::ksSimpleTimer heartbeatTimer{0};					//!< Timer to report all stats in delta reporting mode.
+			misc::ksStatFilter statFilter;							//!< Last reported values used in delta reporting mode.
+			std::unique_ptr<uint8_t[]> compactBuffer;				//!< Buffer for compact reports.
+			ReportFormat reportFormat{ReportFormat::Topics};		//!< Format of the reports.
+
+			struct
+			{
+				bool mqttStatsEnabled : 1;							//!< True if MQTT health metrics should be reported.
+				bool deltaReporting : 1;							//!< True if only changed stats should be reported.
+			}
+			bitflags = {false, false};
 
 			/*!
 				@brief Calback executed on MQTT connection.
@@ -50,20 +88,79 @@ namespace ksf::comps
 			/*!
 				@brief Reports device statistics to the MQTT broker.
 			*/
-			void reportDevStats() const;
+			void reportDevStats();
+
+			/*!
+				@brief Writes device statistics, filtered by change thresholds in delta reporting mode.
+				@param mqttConn Reference to the MQTT connector.
+				@param writer Stat writer that receives the values.
+				@param heartbeat True to write all the stats regardless of thresholds.
+				@return True if at least one value has been written, otherwise false.
+			*/
+			bool writeDevStats(ksMqttConnector& mqttConn, misc::ksStatWriter& writer, bool heartbeat);
+
+			/*!
+				@brief Writes device statistics using the stat writer.
+				@param mqttConn Reference to the MQTT connector.
+				@param writer Stat writer that receives the values.
+			*/
+			void collectDevStats(ksMqttConnector& mqttConn, misc::ksStatWriter& writer) const;
+
+			/*!
+				@brief Writes MQTT connection health metrics using the stat writer.
+				@param mqttConn Reference to the MQTT connector.
+				@param writer Stat writer that receives the values.
+			*/
+			void collectMqttStats(ksMqttConnector& mqttConn, misc::ksStatWriter& writer) const;
+
+#if APP_LOG_ENABLED
+			/*!
+				@brief Publishes the log from before the last reset (see ksApplication::getPreviousLogRing) to "dstat/prevLog", once per boot.
+				@param mqttConn Reference to the MQTT connector.
+			*/
+			void publishPreviousLog(ksMqttConnector& mqttConn);
+#endif
 
 		public:
 			/*!
 				@brief Called when Dev Stat Reporter timer is triggered. Users can bind to this event to add their own stats.
+
+				Stats published from this event are always sent as separate messages, regardless of the report format.
+
 				@param param_1 Shared pointer to the MQTT connector.
 			*/
 			DECLARE_KS_EVENT(onReportCustomStats, std::shared_ptr<ksMqttConnector>&)
 
+			/*!
+				@brief Called when stats are collected. Users can bind to this event to add their own stats.
+				
+				Unlike onReportCustomStats, values written here follow the report format, so in compact mode
+				they become part of the single report message.
+
+				@param param_1 Reference to the stat writer.
+			*/
+			DECLARE_KS_EVENT(onCollectCustomStats, misc::ksStatWriter&)
+
 			/*!
 				@brief Constructs device statistics reporter component.
 				@param intervalInSeconds Interval in seconds between each report.
+				@param reportMqttStats True to report MQTT connection health metrics as well.
+				@param reportFormat Format of the reports.
+			*/
+			ksDevStatMqttReporter(uint8_t intervalInSeconds = 60, bool reportMqttStats = false, ReportFormat reportFormat = ReportFormat::Topics);
+
+			/*!
+				@brief Enables delta reporting - only stats that changed significantly are reported.
+				@param heartbeatIntervalInSeconds Interval in seconds between full reports (0 - full report only after connection).
+			*/
+			void enableDeltaReporting(uint16_t heartbeatIntervalInSeconds);
+
+			/*!
+				@brief Sets change threshold of a stat used in delta reporting mode.
+				@param path Path of the stat, e.g. "rssi", "mqtt/pingMs" or name of a custom stat.
+				@param threshold Minimum change that triggers a report (0 - any change, infinity - on heartbeat only).
 			*/
-			ksDevStatMqttReporter(uint8_t intervalInSeconds = 60);
+			void setStatThreshold(std::string_view path, float threshold);
 
 			/*!
 				@brief Handles component post-initialization.
@@ -37,11 +37,16 @@
 
 #include "../ksApplication.h"
 #include "../ksConstants.h"
+#include "../misc/ksFlashContent.h"
+#include "../misc/ksJsonWriter.h"
+#include "../misc/ksLoopWatchdog.h"
+#include "../misc/ksOtaWriter.h"
 #include "../misc/ksWSServer.h"
-#include "../res/otaWebpage.h"
+#include "../res/portalAssets.h"
 #include "ksWifiConnector.h"
 #include "ksConfigProvider.h"
 #include "ksMqttConnector.h"
+#include "../misc/ksMqttClient.h"
 
 #include "ksDevicePortal.h"
 
@@ -61,6 +66,11 @@ namespace ksf::comps
 	static constexpr char PROGMEM_TEXT_HTML[] PROGMEM {"text/html"};
 	static constexpr char PROGMEM_ACCEPT[] PROGMEM {"Accept"};
 	static constexpr char PROGMEM_IF_NONE_MATCH[] PROGMEM {"If-None-Match"};
+	static constexpr char PROGMEM_COOKIE[] PROGMEM {"Cookie"};
+	static constexpr char PROGMEM_RANGE[] PROGMEM {"Range"};
+	static constexpr char PROGMEM_CACHE_CONTROL[] PROGMEM {"Cache-Control"};
+	static constexpr char PROGMEM_CACHE_IMMUTABLE[] PROGMEM {"public, max-age=31536000, immutable"};
+	static constexpr char PROGMEM_CACHE_REVALIDATE[] PROGMEM {"no-cache"};
 	static constexpr char PROGMEM_NO_ID_RESPONSE[] PROGMEM {"null\n"};
 
 	uint64_t generateAuthToken(const std::string& password)
@@ -137,10 +147,94 @@ namespace ksf::comps
 		if (!webSocket)
 			return;
 
+		/* Logs are queued, so a slow browser drops old lines instead of stalling the application. */
 		message.insert(0, PROGMEM_NO_ID_RESPONSE);
-		webSocket->broadcastTXT(message.c_str(), message.size());
+		webSocket->queueBroadcastTXT(message);
 	}
 
+#if APP_LOG_ENABLED
+	void ksDevicePortal::sendAppLogs()
+	{
+		/* Forget terminals that have disconnected, their client number may be reused. */
+		for (uint8_t num{0}; num < WEBSOCKETS_SERVER_CLIENT_MAX; ++num)
+			if ((logClientsMask & (1UL << num)) != 0 && !webSocket->clientIsConnected(num))
+				logClientsMask &= ~(1UL << num);
+
+		/* Prefix goes first, so the line is appended to it without moving anything. */
+		std::string message;
+		while (true)
+		{
+			message.assign(PROGMEM_NO_ID_RESPONSE);
+			if (!ksApplication::getLogRing().read(logCursor, message))
+				break;
+
+			for (uint8_t num{0}; num < WEBSOCKETS_SERVER_CLIENT_MAX; ++num)
+				if ((logClientsMask & (1UL << num)) != 0)
+					queueAppLog(num, message);
+		}
+	}
+
+	void ksDevicePortal::sendPreviousAppLog(uint8_t clientNum)
+	{
+		auto previousLogRing{ksApplication::getPreviousLogRing()};
+
+		std::string message{PROGMEM_NO_ID_RESPONSE};
+		if (!previousLogRing)
+		{
+			message += PSTR("[ DevicePortal ] No log from before the last reset (requires KSF_LOG_PERSISTENT).");
+			webSocket->queueTXT(clientNum, std::move(message));
+			return;
+		}
+
+		message += PSTR("[ DevicePortal ] Log from before the last reset (");
+		message += ksf::getResetReason();
+		message += PSTR("):");
+		webSocket->queueTXT(clientNum, std::move(message));
+
+		auto cursor{previousLogRing->begin()};
+		while (true)
+		{
+			message.assign(PROGMEM_NO_ID_RESPONSE);
+			if (!previousLogRing->read(cursor, message))
+				break;
+
+			queueAppLog(clientNum, std::move(message));
+		}
+
+		message.assign(PROGMEM_NO_ID_RESPONSE);
+		message += PSTR("[ DevicePortal ] End of the previous log.");
+		webSocket->queueTXT(clientNum, std::move(message));
+	}
+
+	void ksDevicePortal::queueAppLog(uint8_t clientNum, std::string message)
+	{
+		/* Binary records (KSF_LOG_BINARY) start with zero byte. They go without the prefix, as binary messages. */
+		auto prefixLength{sizeof(PROGMEM_NO_ID_RESPONSE) - 1};
+		if (message.size() > prefixLength && message[prefixLength] == '\0')
+		{
+			message.erase(0, prefixLength);
+			webSocket->queueBIN(clientNum, std::move(message));
+		}
+		else webSocket->queueTXT(clientNum, std::move(message));
+	}
+
+	void ksDevicePortal::backfillAppLogs(uint8_t clientNum)
+	{
+		auto& logRing{ksApplication::getLogRing()};
+		auto cursor{logRing.begin()};
+
+		std::string message;
+		while (cursor.sequence != logCursor.sequence)
+		{
+			message.assign(PROGMEM_NO_ID_RESPONSE);
+			if (!logRing.read(cursor, message))
+				break;
+
+			queueAppLog(clientNum, std::move(message));
+		}
+	}
+#endif
+
 	void ksDevicePortal::rebootDevice()
 	{
 		delay(100);
@@ -159,7 +253,11 @@ namespace ksf::comps
 		if (body.empty())
 			return PSTR("No command received. Don't be shy. Try 'help'.");
 		if (body == PSTR("help"))
+#if APP_LOG_ENABLED
+			return PSTR("Available commands: reboot-device, erase-config, erase-all-data, previous-log, help");
+#else
 			return PSTR("Available commands: reboot-device, erase-config, erase-all-data, help");
+#endif
 		
 		if (body == PSTR("reboot-device"))
 			rebootDevice();
@@ -206,6 +304,36 @@ namespace ksf::comps
 		return true;
 	}
 
+	bool ksDevicePortal::inRequest_HasAuthCookie()
+	{
+		/* The stored Set-Cookie value starts with "WSA=<token>", the attributes follow after the semicolon. */
+		std::string_view expected{wsAuthCookie};
+		expected = expected.substr(0, expected.find(';'));
+		if (expected.empty())
+			return false;
+
+		const auto& cookieHeader{webServer->header(PROGMEM_COOKIE)};
+		std::string_view cookies{cookieHeader.c_str(), cookieHeader.length()};
+
+		/* Cookies are separated with "; ", the token must match as a whole (not as a prefix of another value). */
+		while (!cookies.empty())
+		{
+			auto end{cookies.find(';')};
+			auto cookie{cookies.substr(0, end)};
+			while (!cookie.empty() && cookie.front() == ' ')
+				cookie.remove_prefix(1);
+
+			if (cookie == expected)
+				return true;
+
+			if (end == std::string_view::npos)
+				break;
+			cookies.remove_prefix(end + 1);
+		}
+
+		return false;
+	}
+
 	void ksDevicePortal::onWebsocketTextMessage(uint8_t clientNum, const std::string_view& message)
 	{
 		auto idEnd{message.find('|', 0)};
@@ -229,26 +357,33 @@ namespace ksf::comps
 
 		if (command == PSTR("executeCommand"))
 		{
+#if APP_LOG_ENABLED
+			/* Previous log is queued line by line (binary records stay binary), so it's not a text response. */
+			if (body == PSTR("previous-log"))
+			{
+				sendPreviousAppLog(clientNum);
+				return;
+			}
+#endif
 			auto commandResponse{handle_executeCommand(body)};
 			commandResponse.insert(0, PROGMEM_NO_ID_RESPONSE);
-			webSocket->sendTXT(clientNum, commandResponse.c_str(), commandResponse.size());
+			webSocket->queueTXT(clientNum, std::move(commandResponse));
 			return;
 		}
 
-		std::string response{id};
-		response += '\n';
+		void (ksDevicePortal::*jsonHandler)(misc::ksJsonWriter&){nullptr};
 
 		if (command == PSTR("getIdentity"))
 		{
-			handle_getIdentity(response);
+			jsonHandler = &ksDevicePortal::handle_getIdentity;
 		}
 		else if (command == PSTR("scanNetworks"))
 		{
-			handle_scanNetworks(response);
+			jsonHandler = &ksDevicePortal::handle_scanNetworks;
 		}
 		else if (command == PSTR("getDeviceParams"))
 		{
-			handle_getDeviceParams(response);
+			jsonHandler = &ksDevicePortal::handle_getDeviceParams;
 		}
 		else if (command == PSTR("goToConfigMode"))
 		{
@@ -314,10 +449,28 @@ namespace ksf::comps
 			auto enabledLogsRightNow{ logKeepAliveTimestamp == 0 };
 			logKeepAliveTimestamp = std::max(1UL, millis());
 
+#if APP_LOG_ENABLED
+			/* Lines logged while no terminal was open are not lost, each new terminal gets them as history. */
+			if (enabledLogsRightNow)
+				logCursor = ksApplication::getLogRing().end();
+
+			if (auto clientBit{1UL << clientNum}; (logClientsMask & clientBit) == 0)
+			{
+				logClientsMask |= clientBit;
+				backfillAppLogs(clientNum);
+
+				if (ksApplication::getPreviousLogRing())
+				{
+					std::string hint{PROGMEM_NO_ID_RESPONSE};
+					hint += PSTR("[ DevicePortal ] Log from before the last reset is available, type 'previous-log' to show it.");
+					webSocket->queueTXT(clientNum, std::move(hint));
+				}
+			}
+#endif
+
 			if (enabledLogsRightNow)
 			{
 #if APP_LOG_ENABLED
-				app->setLogCallback(std::bind(&ksDevicePortal::onAppLog, this, _1));
 				std::string log{PSTR("[ DevicePortal ] Logs enabled - both command responses and detailed logs will be printed.")};
 #else
 				std::string log{PSTR("[ DevicePortal ] Detailed logs are disabled (no APP_LOG_ENABLED set). Only command responses will be printed.")};
@@ -328,78 +481,195 @@ namespace ksf::comps
 			return;
 		}
 
-		webSocket->sendTXT(clientNum, response.c_str(), response.size());
+		/*
+			The response is streamed as a fragmented message, so its size doesn't matter for memory usage.
+			Space in front of the fragment buffer is reserved for the frame header, so no copy is made.
+		*/
+		uint8_t fragmentBuffer[WEBSOCKETS_MAX_HEADER_SIZE + KSF_PORTAL_WS_FRAGMENT_SIZE];
+		bool isFirstFragment{true};
+		misc::ksJsonWriter json(reinterpret_cast<char*>(fragmentBuffer + WEBSOCKETS_MAX_HEADER_SIZE), KSF_PORTAL_WS_FRAGMENT_SIZE,
+			[&](std::string_view fragment, bool isFinal) {
+				auto sent{webSocket->sendTXTFragment(clientNum, fragmentBuffer, fragment.size(), isFirstFragment, isFinal, true)};
+				isFirstFragment = false;
+				return sent;
+			});
+
+		json.raw(id);
+		json.raw(std::string_view("\n", 1));
+
+		/* Unknown commands get an empty response, so the frontend doesn't wait for it. */
+		if (jsonHandler)
+			(this->*jsonHandler)(json);
+
+		json.finish();
 	}
 
-	void ksDevicePortal::handle_getIdentity(std::string& response)
+	void ksDevicePortal::handle_getIdentity(misc::ksJsonWriter& json)
 	{
-		response.reserve(512);
-		response += PSTR("[{\"name\":\"MCU chip\",\"value\":\"");
-		response += PSTR(HARDWARE " (");
-		response += ksf::to_string(ESP.getCpuFreqMHz());
-		response += PSTR(" MHz)\"},{\"name\":\"Flash chip\",\"value\":\"Vendor ID: ");
-		response += ksf::to_string(ESP_getFlashVendor());
-		response += PSTR(", size: ");
-		response += ksf::to_string(ESP_getFlashSizeKB());
-		response += PSTR(" KB \"},{\"name\":\"Framework\",\"value\":\"");
-		response += PSTR(KSF_LIBRARY_VERSION);
-		response += PSTR("\"},{\"name\":\"Hostname\",\"value\":\"");
-		response += ksf::json_escape(WiFi.getHostname());
-		response += PSTR("\"},{\"name\":\"Free heap\",\"value\":\"");
-		response += ksf::to_string(ESP.getFreeHeap());
-		response += PSTR(" bytes\"},{\"name\":\"Loop-to-loop time\",\"value\":\"");
-		response += ksf::to_string(loopExecutionTime);
-		response += PSTR(" μs\"},{\"name\":\"Device uptime\",\"value\":\"");
-		response += ksf::getUptimeString();
-		response += PSTR("\"},{\"name\":\"Reset reason\",\"value\":\"");
-		response += ksf::getResetReason();
-		response += PSTR("\"},{\"name\":\"MQTT status\",\"value\":\" ");
-
-		if (auto mqttConnSp{mqttConnectorWp.lock()})
+		json.beginArray();
+
+		json.beginObject();
+		json.member_P(PSTR("name"), PSTR("MCU chip"));
+		json.key_P(PSTR("value"));
+		json.beginString();
+		json.addString_P(PSTR(HARDWARE " ("));
+		json.addString(ESP.getCpuFreqMHz());
+		json.addString_P(PSTR(" MHz)"));
+		json.endString();
+		json.endObject();
+
+		json.beginObject();
+		json.member_P(PSTR("name"), PSTR("Flash chip"));
+		json.key_P(PSTR("value"));
+		json.beginString();
+		json.addString_P(PSTR("Vendor ID: "));
+		json.addString(ESP_getFlashVendor());
+		json.addString_P(PSTR(", size: "));
+		json.addString(ESP_getFlashSizeKB());
+		json.addString_P(PSTR(" KB "));
+		json.endString();
+		json.endObject();
+
+		json.beginObject();
+		json.member_P(PSTR("name"), PSTR("Framework"));
+		json.member_P(PSTR("value"), PSTR(KSF_LIBRARY_VERSION));
+		json.endObject();
+
+		json.beginObject();
+		json.member_P(PSTR("name"), PSTR("Hostname"));
+		json.member_P(PSTR("value"), WiFi.getHostname());
+		json.endObject();
+
+		json.beginObject();
+		json.member_P(PSTR("name"), PSTR("Free heap"));
+		json.key_P(PSTR("value"));
+		json.beginString();
+		json.addString(ESP.getFreeHeap());
+		json.addString_P(PSTR(" bytes"));
+		json.endString();
+		json.endObject();
+
+		json.beginObject();
+		json.member_P(PSTR("name"), PSTR("Loop-to-loop time"));
+		json.key_P(PSTR("value"));
+		json.beginString();
+		json.addString(loopExecutionTime);
+		json.addString_P(PSTR(" μs"));
+		json.endString();
+		json.endObject();
+
+		json.beginObject();
+		json.member_P(PSTR("name"), PSTR("Device uptime"));
+		json.member_P(PSTR("value"), ksf::getUptimeString());
+		json.endObject();
+
+		json.beginObject();
+		json.member_P(PSTR("name"), PSTR("Reset reason"));
+		json.member_P(PSTR("value"), ksf::getResetReason());
+		json.endObject();
+
+		json.beginObject();
+		json.member_P(PSTR("name"), PSTR("Loop stalls"));
+		json.key_P(PSTR("value"));
+		json.beginString();
+		json.addString(misc::ksLoopWatchdog::getStallCount());
+		json.addString_P(PSTR(", longest "));
+		json.addString(misc::ksLoopWatchdog::getMaxStallMs());
+		json.addString_P(PSTR(" ms"));
+		if (auto previousStall{misc::ksLoopWatchdog::getPreviousStall()})
+		{
+			json.addString_P(PSTR(", before reset: "));
+			json.addString(previousStall->componentName);
+			json.addString_P(previousStall->hasReturned ? PSTR(" took ") : PSTR(" still running after "));
+			json.addString(previousStall->durationMs);
+			json.addString_P(PSTR(" ms"));
+		}
+		json.endString();
+		json.endObject();
+
+		json.beginObject();
+		json.member_P(PSTR("name"), PSTR("MQTT status"));
+		json.key_P(PSTR("value"));
+		json.beginString();
+
+		auto mqttConnSp{mqttConnectorWp.lock()};
+		if (mqttConnSp)
 		{
 			if (mqttConnSp->isConnected())
 			{
-				response += PSTR("up for ");
-				response += ksf::getUptimeFromSeconds(mqttConnSp->getConnectionTimeSeconds());
-				response += PSTR(", ");
+				json.addString_P(PSTR("up for "));
+				json.addString(ksf::getUptimeFromSeconds(mqttConnSp->getConnectionTimeSeconds()));
+				json.addString_P(PSTR(", "));
 			}
-			else response += PSTR("down, ");
+			else json.addString_P(PSTR("down, "));
 
-			response += std::to_string(mqttConnSp->getReconnectCounter());
-			response += PSTR(" attempt(s)");
+			json.addString(mqttConnSp->getReconnectCounter());
+			json.addString_P(PSTR(" attempt(s)"));
 		}
-		else response += PSTR("not present");
+		else json.addString_P(PSTR("not present"));
+
+		json.endString();
+		json.endObject();
 
-		response += PSTR("\"},{\"name\":\"IP address\",\"value\":\"");
-		response += WiFi.getMode() == WIFI_AP ?  WiFi.softAPIP().toString().c_str() : WiFi.localIP().toString().c_str();
-		response += PSTR("\"},{\"name\":\"DNS servers\",\"value\":\"");
-		response += WiFi.dnsIP().toString().c_str();
-		response += ", ";
-		response += WiFi.dnsIP(1).toString().c_str();
-		response += PSTR("\"}]");
+		if (mqttConnSp)
+		{
+			const auto& clientStats{mqttConnSp->getClientStats()};
+			json.beginObject();
+			json.member_P(PSTR("name"), PSTR("MQTT traffic"));
+			json.key_P(PSTR("value"));
+			json.beginString();
+			json.addString_P(PSTR("in: "));
+			json.addString(clientStats.messagesIn);
+			json.addString_P(PSTR(" msg / "));
+			json.addString(clientStats.bytesIn);
+			json.addString_P(PSTR(" bytes, out: "));
+			json.addString(clientStats.messagesOut);
+			json.addString_P(PSTR(" msg / "));
+			json.addString(clientStats.bytesOut);
+			json.addString_P(PSTR(" bytes, "));
+			json.addString(clientStats.publishFailures);
+			json.addString_P(PSTR(" failed, ping "));
+			json.addString(clientStats.pingRoundTripMs);
+			json.addString_P(PSTR(" ms, max loop "));
+			json.addString(mqttConnSp->getStats().loopTimeMaxUs);
+			json.addString_P(PSTR(" μs"));
+			json.endString();
+			json.endObject();
+		}
+
+		json.beginObject();
+		json.member_P(PSTR("name"), PSTR("IP address"));
+		json.member_P(PSTR("value"), (WiFi.getMode() == WIFI_AP ? WiFi.softAPIP() : WiFi.localIP()).toString().c_str());
+		json.endObject();
+
+		json.beginObject();
+		json.member_P(PSTR("name"), PSTR("DNS servers"));
+		json.key_P(PSTR("value"));
+		json.beginString();
+		json.addString(WiFi.dnsIP().toString().c_str());
+		json.addString_P(PSTR(", "));
+		json.addString(WiFi.dnsIP(1).toString().c_str());
+		json.endString();
+		json.endObject();
+
+		json.endArray();
 	}
 
-	void ksDevicePortal::handle_scanNetworks(std::string& response)
+	void ksDevicePortal::handle_scanNetworks(misc::ksJsonWriter& json)
 	{
 		if (auto scanResult{WiFi.scanComplete()}; scanResult > 0)
 		{
-			response.reserve(scanResult * 64);
-			response += '[';
+			json.beginArray();
 			for (int i{0}; i < scanResult; ++i)
 			{
-				if (i > 0)
-					response += ',';
-				response += PSTR("{\"rssi\":");
-				response += ksf::to_string(WiFi.RSSI(i));
-				response += PSTR(",\"ssid\":\"");
-				response += ksf::json_escape(WiFi.SSID(i).c_str());
-				response += PSTR("\",\"channel\":");
-				response += ksf::to_string(WiFi.channel(i));
-				response += PSTR(",\"secure\":");
-				response += ksf::to_string(WiFi.encryptionType(i));
-				response += '}';
+				json.beginObject();
+				json.member_P(PSTR("rssi"), WiFi.RSSI(i));
+				json.member_P(PSTR("ssid"), WiFi.SSID(i).c_str());
+				json.member_P(PSTR("channel"), WiFi.channel(i));
+				json.member_P(PSTR("secure"), static_cast<int>(WiFi.encryptionType(i)));
+				json.endObject();
 			}
-			response +=	']';
+			json.endArray();
 			WiFi.scanDelete();
 			WiFi.enableSTA(false);
 			scanNetworkTimestamp = 0;
@@ -418,34 +688,33 @@ namespace ksf::comps
 	#endif
 				scanNetworkTimestamp = std::max(1UL, millis());
 			}
-			response += PSTR("{}");
+			json.beginObject();
+			json.endObject();
 		}
 	}
 
-	void ksDevicePortal::handle_getDeviceParams(std::string& response)
+	void ksDevicePortal::handle_getDeviceParams(misc::ksJsonWriter& json)
 	{
 		std::vector<std::weak_ptr<ksConfigProvider>> configCompsWp;
 		app->findComponents<ksConfigProvider>(configCompsWp);
 
 		auto isInConfigMode{static_cast<bool>(WiFi.getMode() & WIFI_AP)};
-		response.reserve(256);
-		response += PSTR("{\"isConfigMode\": ");
-		response += isInConfigMode ? PSTR("true") : PSTR("false");
+		json.beginObject();
+		json.member_P(PSTR("isConfigMode"), isInConfigMode);
 
 		if (!isInConfigMode)
 		{
-			response += '}';
+			json.endObject();
 			return;
 		}
 
 		std::string ssid, pass;
 		ksf::loadCredentials(ssid, pass);
 
-		response += PSTR(",\"ssid\":\"");
-		response += ksf::json_escape(ssid);
-		response += PSTR("\", \"password\":\"");
-		response += ksf::json_escape(pass);
-		response += PSTR("\",\"params\": [");
+		json.member_P(PSTR("ssid"), ssid);
+		json.member_P(PSTR("password"), pass);
+		json.key_P(PSTR("params"));
+		json.beginArray();
 
 		for (auto& configCompWp : configCompsWp)
 		{
@@ -459,38 +728,34 @@ namespace ksf::comps
 
 			for (const auto& paramRef : paramListRef)
 			{
-				response += PSTR("{\"id\": \"");
-				response += ksf::json_escape(paramRef.id);
-				response += PSTR("\", \"label\": \"");
-				response += ksf::json_escape(paramRef.label);
-				response += PSTR("\", \"value\": \"");
-				response += ksf::json_escape(paramRef.value);
-				response += PSTR("\", \"type\": \"");
+				json.beginObject();
+				json.member_P(PSTR("id"), paramRef.id);
+				json.member_P(PSTR("label"), paramRef.label);
+				json.member_P(PSTR("value"), paramRef.value);
+				json.key_P(PSTR("type"));
 				
 				switch (paramRef.type)
 				{
 					case EConfigParamType::Text:
-						response += PSTR("text");
+						json.value_P(PSTR("text"));
 					break;
 					case EConfigParamType::Password:
-						response += PSTR("password");
+						json.value_P(PSTR("password"));
 					break;
 					case EConfigParamType::Number:
-						response += PSTR("number");
+						json.value_P(PSTR("number"));
 					break;
 					case EConfigParamType::Checkbox:
-						response += PSTR("checkbox");
+						json.value_P(PSTR("checkbox"));
 					break;
 				}
 
-				response += PSTR("\"},");
+				json.endObject();
 			}
 		}
 
-		if (response.back() == ',')
-			response.pop_back();
-		
-		response += "]}";
+		json.endArray();
+		json.endObject();
 	}
 
 	void ksDevicePortal::onRequest_notFound() const
@@ -507,6 +772,59 @@ namespace ksf::comps
 		webServer->send(302);
 	}
 
+	bool ksDevicePortal::beginOtaUpload()
+	{
+		if (!otaWriter)
+			otaWriter = std::make_unique<misc::ksOtaWriter>();
+
+		/* Non-zero offset continues interrupted upload, if it matches the number of already received bytes. */
+		auto offset{static_cast<uint32_t>(webServer->arg(PSTR("offset")).toInt())};
+		if (offset != 0)
+			return otaWriter->isActive() && offset == otaWriter->getReceivedBytes();
+
+		auto expectedSize{static_cast<uint32_t>(webServer->arg(PSTR("size")).toInt())};
+		auto compression{webServer->arg(PSTR("compression"))};
+		auto encoding{misc::ksOtaWriter::Encoding::Raw};
+		if (compression == PSTR("heatshrink"))
+			encoding = misc::ksOtaWriter::Encoding::Heatshrink;
+		else if (compression == PSTR("delta"))
+			encoding = misc::ksOtaWriter::Encoding::Delta;
+
+		if (!otaWriter->begin(expectedSize, webServer->arg(PSTR("md5")).c_str(), encoding))
+			return false;
+
+		otaLastReportedBytes = 0;
+		onUpdateStart->broadcast();
+		return true;
+	}
+
+	void ksDevicePortal::reportOtaProgress()
+	{
+		auto receivedBytes{otaWriter->getReceivedBytes()};
+		auto expectedSize{otaWriter->getExpectedSize()};
+
+		/* Report every 5% or every 64 KB if the size is unknown. */
+		auto reportStep{expectedSize != 0 ? expectedSize / 20 : 0x10000};
+		if (receivedBytes - otaLastReportedBytes < reportStep && receivedBytes != expectedSize)
+			return;
+
+		otaLastReportedBytes = receivedBytes;
+
+		std::string message{PSTR("[ DevicePortal ] OTA progress: ")};
+		ksf::append_to_string(message, receivedBytes);
+		if (expectedSize != 0)
+		{
+			message += '/';
+			ksf::append_to_string(message, expectedSize);
+			message += PSTR(" bytes (");
+			ksf::append_to_string(message, static_cast<uint32_t>(uint64_t{receivedBytes} * 100 / expectedSize));
+			message += PSTR("%)");
+		}
+		else message += PSTR(" bytes");
+
+		onAppLog(std::move(message));
+	}
+
 	void ksDevicePortal::onRequest_otaChunk()
 	{
 		if (inRequest_NeedAuthentication())
@@ -515,27 +833,40 @@ namespace ksf::comps
 		auto& upload{webServer->upload()};
 		if (upload.status == UPLOAD_FILE_START)
 		{
-#if defined(ESP8266)
-			Update.runAsync(true);
-			auto maxSketchSpace{(ESP.getFreeSketchSpace() - 0x1000) & 0xFFFFF000};
-#elif defined(ESP32)
-			auto maxSketchSpace{UPDATE_SIZE_UNKNOWN};
-#else
-			#error Platform not implemented.
-#endif
-			if (!Update.begin(maxSketchSpace, U_FLASH)) 
-				return webServer->send_P(400, PROGMEM_TEXT_PLAIN, PSTR("OTA could not begin"));
-
-			onUpdateStart->broadcast();
+			bitflags.otaUploadAccepted = beginOtaUpload();
+			bitflags.otaUploadSucceeded = false;
+		}
+		else if (!bitflags.otaUploadAccepted)
+		{
+			return;
 		}
 		else if (upload.status == UPLOAD_FILE_WRITE)
 		{
-			Update.write(upload.buf, upload.currentSize);
+			if (!otaWriter->write(upload.buf, upload.currentSize))
+			{
+				otaWriter->abort();
+				bitflags.otaUploadAccepted = false;
+				return;
+			}
+
+			reportOtaProgress();
 		}
 		else if (upload.status == UPLOAD_FILE_END) 
 		{
-			Update.end(true);
+			bitflags.otaUploadSucceeded = otaWriter->end();
 		}
+
+		/* On UPLOAD_FILE_ABORTED the session is kept, so the sender can resume it. */
+	}
+
+	void ksDevicePortal::onRequest_otaOffset()
+	{
+		if (inRequest_NeedAuthentication())
+			return;
+
+		std::string offset;
+		ksf::append_to_string(offset, otaWriter && otaWriter->isActive() ? otaWriter->getReceivedBytes() : 0);
+		webServer->send(200, PROGMEM_TEXT_PLAIN, offset.c_str());
 	}
 
 	void ksDevicePortal::onRequest_otaFinish()
@@ -543,7 +874,15 @@ namespace ksf::comps
 		if (inRequest_NeedAuthentication())
 			return;
 
-		auto hasError{Update.hasError()};
+		auto hasError{!bitflags.otaUploadSucceeded};
+
+		/* Failed upload tells the sender where to resume from (0 means from the beginning). */
+		if (hasError)
+		{
+			std::string offset;
+			ksf::append_to_string(offset, otaWriter && otaWriter->isActive() ? otaWriter->getReceivedBytes() : 0);
+			webServer->sendHeader(PSTR("X-OTA-Offset"), offset.c_str());
+		}
 
 		webServer->sendHeader(PSTR("Connection"), PSTR("close"));
 		webServer->send(200, PROGMEM_TEXT_PLAIN, hasError ? PSTR("FAIL") : PSTR("OK"));
@@ -555,29 +894,92 @@ namespace ksf::comps
 		rebootDevice();
 	}
 	
-	void ksDevicePortal::onRequest_index()
+	void ksDevicePortal::onRequest_asset(const res::ksPortalAsset& asset)
 	{
-		if (inRequest_NeedAuthentication())
-			return;
+		/* The shell references other assets, so it changes whenever any of them changes. */
+		const auto& etag{FPSTR(asset.isEntryPoint ? res::PORTAL_MANIFEST_HASH : asset.hash)};
+		auto isNotModified{webServer->header(PROGMEM_IF_NONE_MATCH) == etag};
 
-		if (webSocket)
+		/*
+			Repeated load of the shell by a browser that already holds the current WebSocket cookie is answered
+			straight away, without the authentication and the cookie. The token depends on the password and the
+			manifest, so a stale cookie falls through to the full path below.
+		*/
+		if (asset.isEntryPoint && isNotModified && inRequest_HasAuthCookie())
 		{
-			String cookie{PSTR("WSA=")};
-			cookie += webSocket->getRequiredAuthToken();
-			cookie += PSTR("; Path=/; HttpOnly; SameSite=Strict");
-			webServer->sendHeader(PSTR("Set-Cookie") , cookie);
+			webServer->sendHeader(PROGMEM_CACHE_CONTROL, PROGMEM_CACHE_REVALIDATE);
+			webServer->sendHeader(PSTR("ETag"), etag);
+			webServer->send(304);
+			return;
 		}
 
-		const auto& fileMD5{FPSTR(DEVICE_FRONTEND_HTML_MD5)};
-		if (webServer->header(PROGMEM_IF_NONE_MATCH) == fileMD5)
+		/*
+			Hashed assets are public and never change, so a matching ETag is answered without the authentication.
+			The shell otherwise requires authentication, because it hands out the WebSocket cookie.
+		*/
+		if ((asset.isEntryPoint || !isNotModified) && inRequest_NeedAuthentication())
+			return;
+
+		webServer->sendHeader(PROGMEM_CACHE_CONTROL, asset.isEntryPoint ? PROGMEM_CACHE_REVALIDATE : PROGMEM_CACHE_IMMUTABLE);
+		webServer->sendHeader(PSTR("ETag"), etag);
+
+		/* The cookie is sent with 304 too, so a cached shell gets a valid token after the password change. */
+		if (asset.isEntryPoint && !wsAuthCookie.empty())
+			webServer->sendHeader(PSTR("Set-Cookie"), wsAuthCookie.c_str());
+
+		if (isNotModified)
 		{
 			webServer->send(304);
 			return;
 		}
 
 		webServer->sendHeader(PSTR("Content-Encoding"), PSTR("gzip"));
-		webServer->sendHeader(PSTR("ETag"), fileMD5);
-		webServer->send_P(200, PROGMEM_TEXT_HTML, (const char*)DEVICE_FRONTEND_HTML, DEVICE_FRONTEND_HTML_SIZE);
+		sendFlashContent(asset.contentType, asset.data, asset.size);
+	}
+
+	void ksDevicePortal::sendFlashContent(const char* contentType, const uint8_t* data, size_t size)
+	{
+		size_t start{0}, length{size};
+		auto code{200};
+
+		webServer->sendHeader(PSTR("Accept-Ranges"), PSTR("bytes"));
+
+		if (webServer->hasHeader(PROGMEM_RANGE))
+		{
+			const auto& rangeHeader{webServer->header(PROGMEM_RANGE)};
+			auto rangeResult{misc::parseByteRange({rangeHeader.c_str(), rangeHeader.length()}, size, start, length)};
+
+			if (rangeResult != misc::ERangeResult::None)
+			{
+				std::string contentRange{PSTR("bytes ")};
+				if (rangeResult == misc::ERangeResult::Partial)
+				{
+					ksf::append_to_string(contentRange, start);
+					contentRange += '-';
+					ksf::append_to_string(contentRange, start + length - 1);
+				}
+				else contentRange += '*';
+				contentRange += '/';
+				ksf::append_to_string(contentRange, size);
+				webServer->sendHeader(PSTR("Content-Range"), contentRange.c_str());
+
+				if (rangeResult == misc::ERangeResult::Unsatisfiable)
+				{
+					webServer->send(416);
+					return;
+				}
+
+				code = 206;
+			}
+		}
+
+		/* Send headers only, with the length of the content that follows. */
+		webServer->setContentLength(length);
+		webServer->send(code, contentType, "");
+
+		/* Write directly from flash, without staging in RAM. */
+		auto client{webServer->client()};
+		misc::writeFlashContent(client, data + start, length);
 	}
 
 	void ksDevicePortal::setupHttpServer()
@@ -587,10 +989,13 @@ namespace ksf::comps
 		/* Setup 404 handler. */
 		webServer->onNotFound(std::bind(&ksDevicePortal::onRequest_notFound, this));
 
-		/* Setup index page handler. */
-		webServer->on(FPSTR("/"), HTTP_GET,
-			std::bind(&ksDevicePortal::onRequest_index, this)
-		);
+		/* Setup frontend asset handlers (shell page and on-demand loaded parts). */
+		for (const auto& asset : res::PORTAL_ASSETS)
+		{
+			webServer->on(FPSTR(asset.path), HTTP_GET,
+				std::bind(&ksDevicePortal::onRequest_asset, this, std::cref(asset))
+			);
+		}
 
 		/* Setup OTA update request handler. */
 		webServer->on("/api/flash", HTTP_POST,
@@ -598,14 +1003,26 @@ namespace ksf::comps
 			std::bind(&ksDevicePortal::onRequest_otaChunk, this)	// Upload file end
 		);
 
+		/* Setup OTA resume offset request handler. */
+		webServer->on("/api/flash", HTTP_GET,
+			std::bind(&ksDevicePortal::onRequest_otaOffset, this)
+		);
+
 		/* Setup headers we want to collect. */
 		const char* headerkeys[]
 		{
 			PROGMEM_ACCEPT, 
-			PROGMEM_IF_NONE_MATCH
+			PROGMEM_IF_NONE_MATCH,
+			PROGMEM_RANGE,
+			PROGMEM_COOKIE
 		};
 		webServer->collectHeaders(headerkeys, sizeof(headerkeys)/sizeof(char*));
 
+#if defined(ESP8266)
+		/* Keep connections open, so the browser can fetch ranges or reload without new handshakes. */
+		webServer->keepAlive(true);
+#endif
+
 		/* Startup. */
 		webServer->begin();
 	}
@@ -615,9 +1032,14 @@ namespace ksf::comps
 		webSocket = std::make_unique<ksf::misc::ksWSServer>(81);
 
 		auto authTokenToHash{portalPassword};
-		authTokenToHash.append(DEVICE_FRONTEND_HTML_MD5);
+		authTokenToHash.append(res::PORTAL_MANIFEST_HASH);
 		webSocket->setRequiredAuthToken(generateAuthToken(authTokenToHash));
 
+		/* Cookie is built once, so asset requests don't have to format it. */
+		wsAuthCookie = PSTR("WSA=");
+		ksf::append_to_string(wsAuthCookie, webSocket->getRequiredAuthToken());
+		wsAuthCookie += PSTR("; Path=/; HttpOnly; SameSite=Strict");
+
 		webSocket->setMessageHandler(std::bind(&ksDevicePortal::onWebsocketTextMessage, this, _1, _2));
 		webSocket->enableHeartbeat(WS_PING_INTERVAL_MS, WS_PONG_TIMEOUT_MS, WS_DISCONNECT_TIMEOUT_COUNT);
 
@@ -648,6 +1070,10 @@ namespace ksf::comps
 		if (webSocket)
 			webSocket->loop();
 
+		/* Drop interrupted OTA upload if it's not resumed in time. */
+		if (otaWriter && otaWriter->isIdle(KSF_OTA_RESUME_TIMEOUT_MS))
+			otaWriter->abort();
+
 		/* Cleanup scan results if not received by the client. */
 		if (scanNetworkTimestamp != 0 && millis() - scanNetworkTimestamp > WIFI_SCAN_TIMEOUT)
 		{
@@ -659,11 +1085,16 @@ namespace ksf::comps
 		if (logKeepAliveTimestamp != 0 && millis() - logKeepAliveTimestamp > LOG_KEEPALIVE_INTERVAL)
 		{
 #if APP_LOG_ENABLED
-			app->setLogCallback(nullptr);
+			logClientsMask = 0;
 #endif
 			logKeepAliveTimestamp = 0;
 		}
 
+#if APP_LOG_ENABLED
+		if (logKeepAliveTimestamp != 0)
+			sendAppLogs();
+#endif
+
 		lastLoopExecutionTimestamp = micros();
 		return true;
 	}
@@ -15,6 +15,7 @@
 
 #include "../evt/ksEvent.h"
 #include "../ksComponent.h"
+#include "../misc/ksLogRing.h"
 
 class DNSServer;
 class ArduinoOTAClass;
@@ -34,6 +35,13 @@ class ArduinoOTAClass;
 namespace ksf::misc
 {
 	class ksWSServer;
+	class ksJsonWriter;
+	class ksOtaWriter;
+}
+
+namespace ksf::res
+{
+	struct ksPortalAsset;
 }
 
 namespace ksf::comps
@@ -58,20 +66,29 @@ namespace ksf::comps
 			struct{
 				bool breakApp : 1;										//!< Flag to break app logic.
 				bool isSafeToCallEndOta : 1;							//!< Flag indicating that OTA class is initialized.
-			} bitflags = {false, false};								//!< Bit flags for internal use.
+				bool otaUploadAccepted : 1;								//!< Flag indicating that current OTA upload is being written.
+				bool otaUploadSucceeded : 1;							//!< Flag indicating that current OTA upload has been written and verified.
+			} bitflags = {false, false, false, false};					//!< Bit flags for internal use.
 
 			uint32_t logKeepAliveTimestamp{0};							//!< Flag indicating whether logs are enabled.
 			uint32_t lastLoopExecutionTimestamp{0};						//!< Time of last loop execution (us).
 			uint32_t loopExecutionTime{0};								//!< Diff (loop exec time).
 			uint32_t scanNetworkTimestamp{0};							//!< Timestamp of last scan.
+			uint32_t otaLastReportedBytes{0};							//!< Number of OTA bytes received at last progress report.
+#if APP_LOG_ENABLED
+			misc::ksLogRing::Cursor logCursor;							//!< Next application log line to be sent to the terminals.
+			uint32_t logClientsMask{0};									//!< Bit mask of Websocket clients that receive logs.
+#endif
 
 			std::string portalPassword;									//!< Portal password.
+			std::string wsAuthCookie;									//!< Set-Cookie header value with WebSocket auth token.
 			std::weak_ptr<ksMqttConnector> mqttConnectorWp;				//!< MQTT connector.
 
 			std::unique_ptr<WebServerClass> webServer;					//!< HTTP server.
 			std::unique_ptr<misc::ksWSServer> webSocket;				//!< Web socket server.
 			std::unique_ptr<DNSServer> dnsServer;						//!< DNS server.
 			std::unique_ptr<ArduinoOTAClass> arduinoOTA;				//!< Arduino OTA object.
+			std::unique_ptr<misc::ksOtaWriter> otaWriter;				//!< Portal OTA upload writer.
 
 			/*!
 				@brief Causes the application exit (and ksAppRotator to spawn and process next defined application).
@@ -109,6 +126,12 @@ namespace ksf::comps
 			*/
 			bool inRequest_NeedAuthentication();
 
+			/*!
+				@brief Checks if current HTTP request carries the current WebSocket auth cookie.
+				@return True if the request has the cookie with the current token, otherwise false.
+			*/
+			bool inRequest_HasAuthCookie();
+
 			/*!
 				@brief HTTP handler for 404 "not found" endpoint.
 
@@ -117,11 +140,42 @@ namespace ksf::comps
 			void onRequest_notFound() const;
 
 			/*!
-				@brief HTTP handler for index endpoint.
+				@brief HTTP handler for frontend asset endpoints.
+
+				Called when the browser requests the shell page ("/" endpoint, the default one) or any of the
+				frontend parts it loads on demand.
+
+				@param asset Requested asset.
+			*/
+			void onRequest_asset(const res::ksPortalAsset& asset);
+
+			/*!
+				@brief Sends flash-resident content as a response to the current HTTP request.
+
+				The content is written to the socket in chunks of KSF_PORTAL_STREAM_CHUNK_SIZE bytes, directly from flash.
+				Single range requests (HTTP Range header) are supported.
+
+				@param contentType Content type (PROGMEM string).
+				@param data Pointer to the content in flash.
+				@param size Size of the content.
+			*/
+			void sendFlashContent(const char* contentType, const uint8_t* data, size_t size);
+
+			/*!
+				@brief Starts or resumes portal OTA upload, depending on the request arguments.
+
+				Optional arguments are "offset" (resume offset, 0 or none starts a new upload), "size" (upload size),
+				"md5" (image MD5 to be verified) and "compression" ("heatshrink" for images compressed with
+				scripts/ota_compress.py, "delta" for patches generated by scripts/ota_delta.py).
+
+				@return True if the upload has been accepted, otherwise false.
+			*/
+			bool beginOtaUpload();
 
-				Called when the browser requests "/" endpoint. This is the default endpoint.
+			/*!
+				@brief Broadcasts OTA upload progress to Websocket clients (every 5% of the image).
 			*/
-			void onRequest_index();
+			void reportOtaProgress();
 
 			/*!
 				@brief HTTP handler for OTA chunk endpoint.
@@ -131,6 +185,14 @@ namespace ksf::comps
 			*/
 			void onRequest_otaChunk();
 
+			/*!
+				@brief HTTP handler for OTA resume offset endpoint.
+
+				Called when the browser requests "/api/flash" endpoint with GET method. Responds with the number
+				of bytes received by the interrupted upload, which is the offset to resume from.
+			*/
+			void onRequest_otaOffset();
+
 			/*!
 				@brief HTTP handler for OTA finish endpoint.
 
@@ -148,21 +210,21 @@ namespace ksf::comps
 
 			/*!
 				@brief Websocket handler for network scan endpoint.
-				@param response Response reference. This method will output network scan results in JSON format into this string.
+				@param json JSON writer that receives network scan results.
 			*/
-			void handle_scanNetworks(std::string& response);
+			void handle_scanNetworks(misc::ksJsonWriter& json);
 
 			/*!
 				@brief Websocket handler for identity endpoint (device details).
-				@param response Response reference. This method will output device details in JSON format into this string.
+				@param json JSON writer that receives device details.
 			*/
-			void handle_getIdentity(std::string& response);
+			void handle_getIdentity(misc::ksJsonWriter& json);
 
 			/*!
 				@brief Websocket handler for device parameters endpoint.
-				@param response Response reference. This method will output device configuration parameters into this string.
+				@param json JSON writer that receives device configuration parameters.
 			*/
-			void handle_getDeviceParams(std::string& response);
+			void handle_getDeviceParams(misc::ksJsonWriter& json);
 
 			/*!
 				@brief Websocket handler for user commands endpoint.
@@ -177,6 +239,32 @@ namespace ksf::comps
 			*/
 			void onAppLog(std::string&& message);
 
+#if APP_LOG_ENABLED
+			/*!
+				@brief Sends new application log lines to the terminals.
+			*/
+			void sendAppLogs();
+
+			/*!
+				@brief Sends log history (lines already sent to other terminals) to a newly opened terminal.
+				@param clientNum Websocket client number.
+			*/
+			void backfillAppLogs(uint8_t clientNum);
+
+			/*!
+				@brief Sends the log of the previous boot (see ksApplication::getPreviousLogRing) to the terminal.
+				@param clientNum Websocket client number.
+			*/
+			void sendPreviousAppLog(uint8_t clientNum);
+
+			/*!
+				@brief Queues log message read from the ring (after the prefix) for the terminal.
+				@param clientNum Websocket client number.
+				@param message Prefixed log line or binary log record.
+			*/
+			void queueAppLog(uint8_t clientNum, std::string message);
+#endif
+
 		public:
 			/*!
 				@brief Update start (OTA) event. No parameters.
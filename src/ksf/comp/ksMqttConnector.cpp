@@ -7,6 +7,8 @@
  *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
  */
 
+#include <cstring>
+
 #if defined(ESP32)
 	#include <esp_wifi.h>
 	#include <WiFi.h>
@@ -18,12 +20,13 @@
 #else 			
 	#error Platform not implemented.
 #endif
-#include <PubSubClient.h>
 
 #include "../ksApplication.h"
 #include "../ksConstants.h"
+#include "../ksLog.h"
 #include "../misc/ksConfig.h"
 #include "../misc/ksCertUtils.h"
+#include "../misc/ksMqttClient.h"
 #include "ksWifiConnector.h"
 #include "ksMqttConfigProvider.h"
 
@@ -34,8 +37,11 @@ using namespace std::placeholders;
 namespace ksf::comps
 {
 	ksMqttConnector::ksMqttConnector(bool sendConnectionStatus, bool usePersistentSession)
-		: reconnectTimer(KSF_MQTT_RECONNECT_DELAY_MS)
+		: reconnectPolicy(KSF_MQTT_RECONNECT_DELAY_MS, KSF_MQTT_RECONNECT_MAX_DELAY_MS, KSF_MQTT_RECONNECT_JITTER_PERCENT, KSF_MQTT_BROKER_ADDRESS_TTL_MS)
 	{
+		/* Each device should use a different jitter sequence, so seed it from the hardware RNG. */
+		reconnectPolicy.setSeed(static_cast<uint32_t>(random(INT32_MAX)) ^ micros());
+
 		bitflags.sendConnectionStatus = sendConnectionStatus;
 		bitflags.usePersistentSession = usePersistentSession;
 	}
@@ -46,10 +52,6 @@ namespace ksf::comps
 	{
 		ksMqttConfigProvider cfgProvider;
 
-#if APP_LOG_ENABLED
-		this->app = app;
-#endif
-
 		cfgProvider.init(app);
 		cfgProvider.setupMqttConnector(*this);
 
@@ -96,40 +98,34 @@ namespace ksf::comps
 		ksf::from_chars(port, portNumber);
 
 		/* Create MQTT client. */
-		mqttClientUq = std::make_unique<PubSubClient>(*netClientUq.get());
+		mqttClientUq = std::make_unique<misc::ksMqttClient>(*netClientUq.get(), KSF_MQTT_RX_BUFFER_SIZE, KSF_MQTT_TX_BUFFER_SIZE, KSF_MQTT_INFLIGHT_WINDOW);
+		mqttClientUq->setKeepAlive(KSF_MQTT_KEEPALIVE_SECS);
+		mqttClientUq->setCallback(std::bind(&ksMqttConnector::mqttMessageInternal, this, _1, _2));
 	}
 
 	void ksMqttConnector::mqttConnectedInternal()
 	{
 		lastSuccessConnectionTime = ksf::millis64();
-		mqttClientUq->setCallback(std::bind(&ksMqttConnector::mqttMessageInternal, this, _1, _2, _3));
+		stats.loopTimeMaxUs = 0;
 		onConnected->broadcast();
 	}
 
-	void ksMqttConnector::mqttMessageInternal(const char* topic, const uint8_t* payload, uint32_t length)
+	void ksMqttConnector::mqttMessageInternal(std::string_view topicStr, std::string_view payloadStr)
 	{
 		bool handlesDeviceMessage{onDeviceMessage->isBound()};
 		bool handlesAnyMessage{onAnyMessage->isBound()};
 
 		if (!handlesDeviceMessage && !handlesAnyMessage)
 			return;
-
-		std::string_view payloadStr{reinterpret_cast<const char*>(payload), length};
-		std::string_view topicStr{topic};
 		
-#ifdef APP_LOG_ENABLED
-		app->log([&](std::string& out) {
-			out.reserve(64 + topicStr.length() + payloadStr.length());
-			out += PSTR("[ MqttConnector ] Received on topic: ");
-			out += topicStr;
-			out += PSTR(", value: ");
-			out += payloadStr;
-		});
-#endif
+		KSF_LOG_TRACE("[ MqttConnector ] Received on topic: %.*s, value: %.*s", static_cast<int>(topicStr.length()), topicStr.data(),
+			static_cast<int>(payloadStr.length()), payloadStr.data());
 
-		if (handlesDeviceMessage && ksf::starts_with(topicStr, prefix))
+		/* Prefix is compared in one memcmp call. Stripping it only moves the start of the view. */
+		if (auto prefixLength{prefix.length()}; handlesDeviceMessage && topicStr.length() >= prefixLength &&
+			std::memcmp(topicStr.data(), prefix.data(), prefixLength) == 0)
 		{
-			topicStr = topicStr.substr(prefix.length());
+			topicStr.remove_prefix(prefixLength);
 			onDeviceMessage->broadcast(topicStr, payloadStr);
 		}
 		
@@ -140,76 +136,61 @@ namespace ksf::comps
 	void ksMqttConnector::subscribe(const std::string& topic, bool skipDevicePrefix, ksMqttConnector::QosLevel qos)
 	{
 		uint8_t qosLevel{static_cast<uint8_t>(qos)};
-		if (skipDevicePrefix)
-			mqttClientUq->subscribe(topic.c_str(), qosLevel);
-		else
-		{
-			std::string fullTopic{prefix + topic};
-			mqttClientUq->subscribe(fullTopic.c_str(), qosLevel);
-		}
+		mqttClientUq->subscribe(skipDevicePrefix ? std::string_view{} : prefix, topic, qosLevel);
 	}
 
 	void ksMqttConnector::unsubscribe(const std::string& topic, bool skipDevicePrefix)
 	{
-		if (skipDevicePrefix)
-			mqttClientUq->unsubscribe(topic.c_str());
-		else
-		{
-			std::string fullTopic{prefix + topic};
-			mqttClientUq->unsubscribe(fullTopic.c_str());
-		}
+		mqttClientUq->unsubscribe(skipDevicePrefix ? std::string_view{} : prefix, topic);
 	}
 
-	void ksMqttConnector::publish(const std::string& topic, const std::string& payload, bool retain, bool skipDevicePrefix)
+	bool ksMqttConnector::publish(const std::string& topic, const std::string& payload, bool retain, bool skipDevicePrefix, ksMqttConnector::QosLevel qos)
 	{
-#ifdef APP_LOG_ENABLED
-		app->log([&](std::string& out) {
-			out += PSTR("[ MqttConnector ] ");
-			if (retain)
-				out += PSTR("(Retained) ");
-			out += PSTR("Publish to: ");
-			if (!skipDevicePrefix)
-				out += prefix;
-			out += topic;
-			out += PSTR(", value: ");
-			out += payload;
-		});
-#endif
-		if (skipDevicePrefix)
-			mqttClientUq->publish(topic.c_str(), reinterpret_cast<const uint8_t*>(payload.c_str()), payload.length(), retain);
-		else
-		{
-			std::string fullTopic{prefix + topic};
-			mqttClientUq->publish(fullTopic.c_str(), reinterpret_cast<const uint8_t*>(payload.c_str()), payload.length(), retain);
-		}
+		KSF_LOG_TRACE("[ MqttConnector ] %sPublish to: %s%s, value: %s", retain ? "(Retained) " : "",
+			skipDevicePrefix ? "" : prefix.c_str(), topic.c_str(), payload.c_str());
+		uint8_t qosLevel{static_cast<uint8_t>(qos)};
+		return mqttClientUq->publish(skipDevicePrefix ? std::string_view{} : prefix, topic, payload, retain, qosLevel);
+	}
+
+	bool ksMqttConnector::publish(const std::string& topic, const uint8_t* data, std::size_t length, bool retain, bool skipDevicePrefix, ksMqttConnector::QosLevel qos)
+	{
+		KSF_LOG_TRACE("[ MqttConnector ] %sPublish to: %s%s, binary value of %u bytes", retain ? "(Retained) " : "",
+			skipDevicePrefix ? "" : prefix.c_str(), topic.c_str(), static_cast<unsigned>(length));
+		uint8_t qosLevel{static_cast<uint8_t>(qos)};
+		std::string_view payload{reinterpret_cast<const char*>(data), length};
+		return mqttClientUq->publish(skipDevicePrefix ? std::string_view{} : prefix, topic, payload, retain, qosLevel);
+	}
+
+	bool ksMqttConnector::beginPublish(const std::string& topic, uint32_t payloadLength, bool retain, bool skipDevicePrefix)
+	{
+		KSF_LOG_TRACE("[ MqttConnector ] %sStream publish to: %s%s, length: %u", retain ? "(Retained) " : "",
+			skipDevicePrefix ? "" : prefix.c_str(), topic.c_str(), static_cast<unsigned>(payloadLength));
+		return mqttClientUq->beginPublish(skipDevicePrefix ? std::string_view{} : prefix, topic, payloadLength, retain);
+	}
+
+	bool ksMqttConnector::write(std::string_view chunk)
+	{
+		return mqttClientUq->writePayload(reinterpret_cast<const uint8_t*>(chunk.data()), chunk.size());
+	}
+
+	bool ksMqttConnector::endPublish()
+	{
+		return mqttClientUq->endPublish();
 	}
 
 	bool ksMqttConnector::connectToBroker()
 	{
-#ifdef APP_LOG_ENABLED
-		app->log([&](std::string& out) {
-			out += PSTR("[ MqttConnector ] Connecting to MQTT broker...");
-		});
-#endif
+		KSF_LOG_INFO("[ MqttConnector ] Connecting to MQTT broker...");
 		IPAddress serverIP;
 		if (!domainResolver.getResolvedIP(serverIP))
 		{
-#ifdef APP_LOG_ENABLED
-			app->log([&](std::string& out) {
-				out += PSTR("[ MqttConnector ] Failed to resolve MQTT broker IP address!");
-			});
-#endif
+			KSF_LOG_ERROR("[ MqttConnector ] Failed to resolve MQTT broker IP address!");
 			return false;
 		}
 
 		if (serverIP.operator uint32_t() != 0)
 		{
-#ifdef APP_LOG_ENABLED
-			app->log([&](std::string& out) {
-				out += PSTR("[ MqttConnector ] Connecting to the resolved IP address: ");
-				out += std::string(serverIP.toString().c_str());
-			});
-#endif
+			KSF_LOG_INFO("[ MqttConnector ] Connecting to the resolved IP address: %u.%u.%u.%u", serverIP[0], serverIP[1], serverIP[2], serverIP[3]);
 #if defined(ESP32)
 			netClientUq->connect(serverIP, portNumber, KSF_MQTT_TIMEOUT_MS);
 #elif defined(ESP8266)
@@ -226,46 +207,44 @@ namespace ksf::comps
 		/* Verify certificate fingerprint. */
 		if (certFingerprint && !certFingerprint->verify(reinterpret_cast<ksMqttConnectorNetClientSecure_t*>(netClientUq.get())))
 		{
-#ifdef APP_LOG_ENABLED
-			app->log([&](std::string& out) {
-				out += PSTR("[ MqttConnector ] Invalid certificate fingerprint! Disconnecting.");
-			});
-#endif
+			KSF_LOG_ERROR("[ MqttConnector ] Invalid certificate fingerprint! Disconnecting.");
 			netClientUq->stop();
 			return false;
 		}
 
-#ifdef APP_LOG_ENABLED
-		app->log([&](std::string& out) {
-			out += PSTR("[ MqttConnector ] Connected successfully and will now authenticate.");
-		});
-#endif
+		KSF_LOG_INFO("[ MqttConnector ] Connected successfully and will now authenticate.");
 
+		auto clientId{WiFi.macAddress()};
 		if (bitflags.sendConnectionStatus)
 		{
 			std::string willTopic{prefix + PSTR("connected")};
-			if (mqttClientUq->connect(WiFi.macAddress().c_str(), login.c_str(), password.c_str(), willTopic.c_str(), 0, true, "0", !bitflags.usePersistentSession))
+			if (mqttClientUq->connect(clientId.c_str(), login, password, willTopic, 0, true, "0", !bitflags.usePersistentSession, KSF_MQTT_TIMEOUT_MS))
 			{
-				mqttClientUq->publish(willTopic.c_str(), reinterpret_cast<const uint8_t*>("1"), 1, true);
+				mqttClientUq->publish({}, willTopic, "1", true);
 				return true;
 			}
+
+			return false;
 		}
 		
-		return mqttClientUq->connect(WiFi.macAddress().c_str(), login.c_str(), password.c_str(), 0, 0, false, 0, !bitflags.usePersistentSession);
+		return mqttClientUq->connect(clientId.c_str(), login, password, {}, 0, false, {}, !bitflags.usePersistentSession, KSF_MQTT_TIMEOUT_MS);
 	}
 
 	bool ksMqttConnector::loop([[maybe_unused]] ksApplication* app)
 	{		
 		/* If MQTT is connected, process it. */
+		auto loopStartUs{micros()};
 		if (mqttClientUq->loop())
+		{
+			recordLoopTime(micros() - loopStartUs);
 			return true;
+		}
 			
-		/* If no MQTT connection, but was connected before, broadcast disconnected event, restart reconnect timer etc. */
+		/* If no MQTT connection, but was connected before, broadcast disconnected event and let the policy retry immediately. */
 		if (bitflags.wasConnected)
 		{
 			bitflags.wasConnected = false;
-			reconnectTimer.restart();
-			domainResolver.invalidate();
+			reconnectPolicy.onDisconnected(millis());
 			onDisconnected->broadcast();
 			return true;
 		}
@@ -273,32 +252,61 @@ namespace ksf::comps
 		/* Process domain resolver. */
 		domainResolver.process();
 			
-		/* If reconnect timer expired, try to reconnect. */
-		if (reconnectTimer.hasTimePassed())
+		/* Wait until the policy allows next attempt. */
+		if (!reconnectPolicy.shouldAttempt(millis()))
+			return true;
+
+		/* Without WiFi there is nothing to try. Keep the attempt pending, so it happens as soon as WiFi is up. */
+		auto wifiConnSp{wifiConnWp.lock()};
+		if (!wifiConnSp || !wifiConnSp->isConnected())
+			return true;
+
+		/* The same applies to the broker address, resolver retries the query on its own. */
+		if (IPAddress serverIP; !domainResolver.getResolvedIP(serverIP))
+			return true;
+
+		auto connectStartMs{millis()};
+		auto connected{connectToBroker()};
+		stats.connectDurationMs = millis() - connectStartMs;
+
+		if (connected)
 		{
-			if (auto wifiConnSp{wifiConnWp.lock()})
-			{
-				if (wifiConnSp->isConnected() && connectToBroker())
-				{
-					/* On successful reconnection, increment reconnect counter and trigger event. */
-					++reconnectCounter;
-					bitflags.wasConnected = true;
-					mqttConnectedInternal();
-				}
-				else 
-				{
-					/* Always invalidate domain resolver in case we are not connected after retry. */
-					domainResolver.invalidate();
-				}
-			}
-			
-			/* This must be done after connectToBroker, because connect can block for few seconds. */
-			reconnectTimer.restart();
+			/* On successful reconnection, increment reconnect counter and trigger event. */
+			++reconnectCounter;
+			bitflags.wasConnected = true;
+			reconnectPolicy.onConnected();
+			mqttConnectedInternal();
+			return true;
 		}
 
+		/* This must be done after connectToBroker, because connect can block for few seconds. */
+		auto nowMs{millis()};
+		reconnectPolicy.onAttemptFailed(nowMs);
+
+		/* Reuse the cached broker address until its lifetime expires. */
+		if (reconnectPolicy.isAddressExpired(domainResolver.getResolvedTimeMs(), nowMs))
+			domainResolver.invalidate();
+
 		return true;
 	}
 
+	void ksMqttConnector::recordLoopTime(uint32_t loopTimeUs)
+	{
+		stats.loopTimeUs = loopTimeUs;
+		stats.loopTimeMaxUs = std::max(stats.loopTimeMaxUs, loopTimeUs);
+#if KSF_MQTT_LOOP_TIME_HISTOGRAM
+		uint8_t bucket{0};
+		for (auto limitUs{loopTimeUs >> 6}; limitUs > 0 && bucket < KSF_MQTT_LOOP_TIME_HISTOGRAM_BUCKETS - 1; limitUs >>= 1)
+			++bucket;
+		++stats.loopTimeHistogram[bucket];
+#endif
+	}
+
+	const misc::ksMqttClientStats& ksMqttConnector::getClientStats() const
+	{
+		return mqttClientUq->getStats();
+	}
+
 	bool ksMqttConnector::isConnected() const
 	{
 		return mqttClientUq ? mqttClientUq->connected() : false;
@@ -14,9 +14,10 @@
 #include <string_view>
 
 #include "../ksComponent.h"
+#include "../ksConstants.h"
 #include "../evt/ksEvent.h"
-#include "../misc/ksSimpleTimer.h"
 #include "../misc/ksDomainQuery.h"
+#include "../misc/ksReconnectPolicy.h"
 
 #if (defined(ESP32))
 	#if ESP_ARDUINO_VERSION_MAJOR >= 3
@@ -37,17 +38,30 @@
 	#error Platform not implemented.
 #endif
 
-class PubSubClient;
-
 namespace ksf::misc
 {
 	class ksCertFingerprint;
+	class ksMqttClient;
+	struct ksMqttClientStats;
 }
 
 namespace ksf::comps
 {
 	class ksWifiConnector;
 
+	/*!
+		@brief Timing statistics of the MQTT connector.
+	*/
+	struct ksMqttConnectorStats
+	{
+		uint32_t connectDurationMs{0};			//!< Time spent in the last connection attempt (milliseconds).
+		uint32_t loopTimeUs{0};					//!< Time spent in the last MQTT client loop (microseconds).
+		uint32_t loopTimeMaxUs{0};				//!< Longest MQTT client loop since the connection was established (microseconds).
+#if KSF_MQTT_LOOP_TIME_HISTOGRAM
+		uint32_t loopTimeHistogram[KSF_MQTT_LOOP_TIME_HISTOGRAM_BUCKETS]{};	//!< Loop time histogram, bucket N counts loops shorter than 64 << N us.
+#endif
+	};
+
 	/*!
 		@brief A component responsible for managing MQTT connections.
 
@@ -61,18 +75,15 @@ namespace ksf::comps
 		KSF_RTTI_DECLARATIONS(ksMqttConnector, ksComponent)
 
 		protected:
-#if APP_LOG_ENABLED
-			ksApplication* app{nullptr};									//!< Application pointer.
-#endif
-
 			misc::ksDomainQuery domainResolver;								//!< Domain query used to resolve MQTT broker address.
 			std::unique_ptr<ksMqttConnectorNetClient_t> netClientUq;		//!< Shared pointer to WiFiClient used to connect to MQTT.
-			std::unique_ptr<PubSubClient> mqttClientUq;						//!< Shared pointer to PubSubClient used to connect to MQTT.
+			std::unique_ptr<misc::ksMqttClient> mqttClientUq;				//!< Unique pointer to MQTT client used to connect to MQTT.
 			std::weak_ptr<ksWifiConnector> wifiConnWp;						//!< Weak pointer to WiFi connector.
-			misc::ksSimpleTimer reconnectTimer;								//!< Timer that counts time between reconnection attempts.
+			misc::ksReconnectPolicy reconnectPolicy;						//!< Policy that schedules reconnection attempts.
 
 			uint64_t lastSuccessConnectionTime{0};							//!< Time of connection to MQTT broker in seconds.
 			uint32_t reconnectCounter{0};									//!< MQTT reconnection counter.
+			ksMqttConnectorStats stats;										//!< Timing statistics.
 
 			struct 
 			{
@@ -99,7 +110,7 @@ namespace ksf::comps
 			/*!
 				@brief Connects to the MQTT broker (internal function).
 
-				Binds onMessage callback, calls bound onConnected callbacks and is used to configures parameters.
+				Saves connection time and calls bound onConnected callbacks.
 			*/
 			void mqttConnectedInternal();
 
@@ -107,19 +118,40 @@ namespace ksf::comps
 				@brief Called when MQTT message arrives (internal function).
 				@param topic Topic that received the message.
 				@param payload Payload of the message.
-				@param length Length of the payload.
 			*/
-			void mqttMessageInternal(const char* topic, const uint8_t* payload, uint32_t length);
+			void mqttMessageInternal(std::string_view topic, std::string_view payload);
 
 		public:
-			enum class QosLevel
+			/*!
+				@brief MQTT quality of service level. Values are sent on the wire as they are.
+			*/
+			enum class QosLevel : uint8_t
 			{
-				QOS_AT_LEAST_ONCE,
-				QOS_EXACTLY_ONCE
+				QOS_AT_MOST_ONCE = 0,		//!< QoS 0, fire and forget.
+				QOS_AT_LEAST_ONCE = 1,		//!< QoS 1, acknowledged with PUBACK.
+				QOS_EXACTLY_ONCE = 2		//!< QoS 2, acknowledged with PUBREC/PUBREL/PUBCOMP handshake.
 			};
 
-			DECLARE_KS_EVENT(onDeviceMessage, const std::string_view&, const std::string_view&)		//!< onDeviceMessage event that user can bind to.
-			DECLARE_KS_EVENT(onAnyMessage, const std::string_view&, const std::string_view&)		//!< onAnyMessage event that user can bind to.
+			/*!
+				@brief Called when a message arrives on a topic that starts with the device prefix.
+
+				Topic is passed without the device prefix. Both views point directly into the receive buffer of the 
+				MQTT client, which is reused for the next packet. They are valid only until the callback returns, 
+				so copy the data if it's needed later. Publishing from the callback is safe.
+
+				Binary payloads (e.g. CBOR) can be decoded in place by passing the payload to misc::ksCborReader.
+
+				@param param_1 Topic (without the device prefix).
+				@param param_2 Payload.
+			*/
+			DECLARE_KS_EVENT(onDeviceMessage, const std::string_view&, const std::string_view&)
+
+			/*!
+				@brief Called when any message arrives. Views follow the same lifetime rules as in onDeviceMessage.
+				@param param_1 Topic (without the device prefix if the message has been already passed to onDeviceMessage).
+				@param param_2 Payload.
+			*/
+			DECLARE_KS_EVENT(onAnyMessage, const std::string_view&, const std::string_view&)
 
 			DECLARE_KS_EVENT(onConnected)															//!< onConnected event that user can bind to.
 			DECLARE_KS_EVENT(onDisconnected)														//!< onDisconnected event that user can bind to.
@@ -167,6 +199,12 @@ namespace ksf::comps
 			*/
 			bool isConnected() const;
 
+			/*!
+				@brief Records time spent in the MQTT client loop.
+				@param loopTimeUs Loop time in microseconds.
+			*/
+			void recordLoopTime(uint32_t loopTimeUs);
+
 			/*!
 				@brief Retrieves connection time in seconds.
 				@return MQTT connection time in seconds.
@@ -179,13 +217,25 @@ namespace ksf::comps
 			*/
 			uint32_t getReconnectCounter() const { return reconnectCounter; }
 
+			/*!
+				@brief Retrieves timing statistics (connect duration, loop time).
+				@return Reference to the timing statistics.
+			*/
+			const ksMqttConnectorStats& getStats() const { return stats; }
+
+			/*!
+				@brief Retrieves MQTT traffic counters (bytes, messages, failures, ping round-trip time).
+				@return Reference to the traffic counters.
+			*/
+			const misc::ksMqttClientStats& getClientStats() const;
+
 			/*!
 				@brief Subscribes to MQTT topic.
 				@param topic Topic to subscribe
 				@param skipDevicePrefix True if device prefix shouldn't be inserted before passed topic, false otherwise.
 				@param qos Quality of service level (QOS).
 			*/
-			void subscribe(const std::string& topic, bool skipDevicePrefix = false, ksMqttConnector::QosLevel = ksMqttConnector::QosLevel::QOS_AT_LEAST_ONCE);
+			void subscribe(const std::string& topic, bool skipDevicePrefix = false, ksMqttConnector::QosLevel = ksMqttConnector::QosLevel::QOS_AT_MOST_ONCE);
 
 			/*!
 				@brief Unsubscribes the MQTT topic.
@@ -200,8 +250,56 @@ namespace ksf::comps
 				@param payload Payload to be transmitted.
 				@param retain True if this publish should be retained, otherwise false.
 				@param skipDevicePrefix True if device prefix shouldn't be inserted to the topic, false otherwise.
+				@param qos Quality of service level (QOS). With QOS 1 and 2 the call fails when too many messages wait for acknowledgement.
+				@return True if the message has been sent, otherwise false.
+			*/
+			bool publish(const std::string& topic, const std::string& payload, bool retain = false, bool skipDevicePrefix = false, ksMqttConnector::QosLevel qos = ksMqttConnector::QosLevel::QOS_AT_MOST_ONCE);
+
+			/*!
+				@brief Publishes a binary message (e.g. encoded with ksCborWriter) to the MQTT topic.
+				@param topic Target topic name.
+				@param data Pointer to the payload.
+				@param length Length of the payload.
+				@param retain True if this publish should be retained, otherwise false.
+				@param skipDevicePrefix True if device prefix shouldn't be inserted to the topic, false otherwise.
+				@param qos Quality of service level (QOS). With QOS 1 and 2 the call fails when too many messages wait for acknowledgement.
+				@return True if the message has been sent, otherwise false.
+			*/
+			bool publish(const std::string& topic, const uint8_t* data, std::size_t length, bool retain = false, bool skipDevicePrefix = false, ksMqttConnector::QosLevel qos = ksMqttConnector::QosLevel::QOS_AT_MOST_ONCE);
+
+			/*!
+				@brief Starts a streamed publish to the MQTT topic.
+
+				Use it for large payloads that shouldn't be built as one string. After this call, write the payload with
+				one or more write calls (exactly payloadLength bytes in total) and finish with endPublish. 
+				Chunks are sent directly to the socket. Don't publish anything else until endPublish returns.
+
+				@param topic Target topic name.
+				@param payloadLength Total length of the payload that will be written.
+				@param retain True if this publish should be retained, otherwise false.
+				@param skipDevicePrefix True if device prefix shouldn't be inserted to the topic, false otherwise.
+				@return True if the publish has been started, otherwise false.
+			*/
+			bool beginPublish(const std::string& topic, uint32_t payloadLength, bool retain = false, bool skipDevicePrefix = false);
+
+			/*!
+				@brief Writes a chunk of the streamed publish payload.
+
+				If the publish hasn't been started (beginPublish returned false), nothing is sent and the connection stays.
+				If the chunk exceeds the declared length or can't be sent, the started message can't be completed,
+				so the connection is dropped.
+
+				@param chunk Part of the payload.
+				@return True on success, false if the publish hasn't been started, the chunk exceeds declared length or the connection failed.
+			*/
+			bool write(std::string_view chunk);
+
+			/*!
+				@brief Finishes the streamed publish.
+				@return True if the whole message has been sent, otherwise false. The connection is dropped if the publish
+					has been started, but the message couldn't be completed.
 			*/
-			void publish(const std::string& topic, const std::string& payload, bool retain = false, bool skipDevicePrefix = false);
+			bool endPublish();
 
 			/*!
 				@brief Sets up MQTT connection.
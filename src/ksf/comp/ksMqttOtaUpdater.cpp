@@ -0,0 +1,384 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#include <Arduino.h>
+#include <algorithm>
+#include <cstring>
+
+#include "../ksConstants.h"
+#include "../ksApplication.h"
+#include "../misc/ksOtaWriter.h"
+#include "../misc/ksSha256.h"
+#include "ksMqttConnector.h"
+
+#include "ksMqttOtaUpdater.h"
+
+namespace ksf::comps
+{
+	static constexpr char OTA_CTL_TOPIC[] 		PROGMEM {"ota/ctl"};
+	static constexpr char OTA_NONCE_TOPIC[] 	PROGMEM {"ota/nonce"};
+	static constexpr char OTA_REQ_TOPIC[] 		PROGMEM {"ota/req"};
+	static constexpr char OTA_CHUNK_TOPIC[] 	PROGMEM {"ota/chunk"};
+	static constexpr char OTA_PROGRESS_TOPIC[] 	PROGMEM {"ota/progress"};
+	static constexpr char OTA_RESULT_TOPIC[] 	PROGMEM {"ota/result"};
+
+	/* Chunk header: offset and CRC-32 of the data (both little endian uint32). */
+	static constexpr std::size_t CHUNK_HEADER_SIZE{8};
+
+	/*!
+		@brief Reads little endian uint32 value.
+		@param data Pointer to the data.
+		@return Decoded value.
+	*/
+	static uint32_t readUint32LE(const uint8_t* data)
+	{
+		return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t>(data[3]) << 24);
+	}
+
+	/*!
+		@brief Converts bytes to a lowercase hex string.
+		@param data Pointer to the data.
+		@param length Length of the data.
+		@return Hex string.
+	*/
+	static std::string bytesToHex(const uint8_t* data, std::size_t length)
+	{
+		static constexpr char HEX_DIGITS[] PROGMEM {"0123456789abcdef"};
+
+		std::string hex;
+		hex.reserve(length * 2);
+		for (std::size_t i{0}; i < length; ++i)
+		{
+			hex += pgm_read_byte(&HEX_DIGITS[data[i] >> 4]);
+			hex += pgm_read_byte(&HEX_DIGITS[data[i] & 0x0F]);
+		}
+		return hex;
+	}
+
+	/*!
+		@brief Retrieves a random number from the hardware RNG.
+		@return Random number.
+	*/
+	static uint32_t hardwareRandom()
+	{
+#if defined(ESP32)
+		return esp_random();
+#elif defined(ESP8266)
+		return ESP.random();
+#else
+		#error Platform not implemented.
+#endif
+	}
+
+	/*!
+		@brief Takes the next space separated token from the input.
+		@param input Input text (the token and following spaces are removed).
+		@return Token or empty view if there are no more tokens.
+	*/
+	static std::string_view nextToken(std::string_view& input)
+	{
+		auto tokenEnd{std::min(input.find(' '), input.size())};
+		auto token{input.substr(0, tokenEnd)};
+		input.remove_prefix(tokenEnd);
+
+		while (!input.empty() && input.front() == ' ')
+			input.remove_prefix(1);
+
+		return token;
+	}
+
+	ksMqttOtaUpdater::ksMqttOtaUpdater(std::string sharedSecret)
+		: sharedSecret(std::move(sharedSecret))
+	{}
+
+	ksMqttOtaUpdater::~ksMqttOtaUpdater() = default;
+
+	bool ksMqttOtaUpdater::postInit(ksApplication* app)
+	{
+		mqttConnWp = app->findComponent<ksMqttConnector>();
+
+		if (auto mqttConnSp{mqttConnWp.lock()})
+		{
+			mqttConnSp->onConnected->registerEvent(connEventHandle, std::bind(&ksMqttOtaUpdater::onConnected, this));
+			mqttConnSp->onDeviceMessage->registerEvent(msgEventHandle, std::bind(&ksMqttOtaUpdater::onDeviceMessage, this, std::placeholders::_1, std::placeholders::_2));
+		}
+
+		return true;
+	}
+
+	void ksMqttOtaUpdater::onConnected()
+	{
+		if (auto mqttConnSp{mqttConnWp.lock()})
+		{
+			mqttConnSp->subscribe(OTA_CTL_TOPIC);
+			mqttConnSp->subscribe(OTA_CHUNK_TOPIC);
+		}
+
+		/* Chunks requested before the connection has been lost will never come, request them again. */
+		if (!isUpdating())
+			return;
+
+		requestedEnd = otaWriter->getReceivedBytes();
+		chunkTimer.restart();
+		requestChunks();
+	}
+
+	void ksMqttOtaUpdater::onDeviceMessage(const std::string_view& topic, const std::string_view& payload)
+	{
+		if (topic == OTA_CHUNK_TOPIC)
+			handleChunk(payload);
+		else if (topic == OTA_CTL_TOPIC)
+			handleCommand(payload);
+	}
+
+	void ksMqttOtaUpdater::handleCommand(std::string_view command)
+	{
+		auto name{nextToken(command)};
+
+		if (name == PSTR("nonce"))
+			sendNonce();
+		else if (name == PSTR("begin"))
+		{
+			/* Rejected command must not break the update in progress. */
+			if (!authenticate(command))
+				publish(OTA_RESULT_TOPIC, PSTR("error: unauthorized"));
+			else if (!beginUpdate(command))
+				failUpdate(PSTR("begin failed"));
+		}
+		else if (name == PSTR("abort"))
+		{
+			if (isUpdating())
+				failUpdate(PSTR("aborted"));
+		}
+		else publish(OTA_RESULT_TOPIC, PSTR("error: unknown command"));
+	}
+
+	void ksMqttOtaUpdater::sendNonce()
+	{
+		uint8_t random[8];
+		for (uint8_t i{0}; i < sizeof(random); i += 4)
+		{
+			auto value{hardwareRandom()};
+			memcpy(random + i, &value, 4);
+		}
+
+		nonce = bytesToHex(random, sizeof(random));
+		publish(OTA_NONCE_TOPIC, nonce);
+	}
+
+	bool ksMqttOtaUpdater::authenticate(std::string_view& args)
+	{
+		/* Single use - whatever the result, the next begin needs a new nonce. */
+		auto expectedNonce{std::move(nonce)};
+		nonce.clear();
+
+		auto hmacPos{args.rfind(' ')};
+		if (sharedSecret.empty() || expectedNonce.empty() || hmacPos == std::string_view::npos)
+			return false;
+
+		auto signedArgs{args.substr(0, hmacPos)};
+		auto receivedHmac{args.substr(hmacPos + 1)};
+
+		auto message{expectedNonce};
+		message += ' ';
+		message += signedArgs;
+
+		uint8_t digest[misc::ksSha256::DIGEST_SIZE];
+		misc::ksSha256::hmac(sharedSecret, message, digest);
+		auto expectedHmac{bytesToHex(digest, sizeof(digest))};
+
+		if (receivedHmac.size() != expectedHmac.size())
+			return false;
+
+		/* Compare all the characters, so the time doesn't tell how many of them match. */
+		uint8_t difference{0};
+		for (std::size_t i{0}; i < expectedHmac.size(); ++i)
+			difference |= receivedHmac[i] ^ expectedHmac[i];
+
+		if (difference != 0)
+			return false;
+
+		args = signedArgs;
+		return true;
+	}
+
+	bool ksMqttOtaUpdater::beginUpdate(std::string_view args)
+	{
+		uint32_t expectedSize{0};
+		if (!ksf::from_chars(nextToken(args), expectedSize) || expectedSize == 0)
+			return false;
+
+		auto expectedMD5{nextToken(args)};
+		if (expectedMD5.size() != 32)
+			return false;
+
+		auto encodingName{nextToken(args)};
+		auto encoding{misc::ksOtaWriter::Encoding::Raw};
+		if (encodingName == PSTR("heatshrink"))
+			encoding = misc::ksOtaWriter::Encoding::Heatshrink;
+		else if (encodingName == PSTR("delta"))
+			encoding = misc::ksOtaWriter::Encoding::Delta;
+		else if (!encodingName.empty() && encodingName != PSTR("raw"))
+			return false;
+
+		if (!otaWriter)
+			otaWriter = std::make_unique<misc::ksOtaWriter>();
+
+		if (!otaWriter->begin(expectedSize, std::string(expectedMD5), encoding))
+			return false;
+
+		requestedEnd = 0;
+		retryCounter = 0;
+		lastReportedPercent = 0;
+		onUpdateStart->broadcast();
+
+		chunkTimer.restart();
+		requestChunks();
+		return true;
+	}
+
+	void ksMqttOtaUpdater::handleChunk(std::string_view payload)
+	{
+		if (!isUpdating() || payload.size() <= CHUNK_HEADER_SIZE)
+			return;
+
+		auto header{reinterpret_cast<const uint8_t*>(payload.data())};
+		auto data{header + CHUNK_HEADER_SIZE};
+		auto length{payload.size() - CHUNK_HEADER_SIZE};
+		auto receivedBytes{otaWriter->getReceivedBytes()};
+
+		/* Duplicates, chunks after a gap and damaged chunks are dropped. Missing data is requested again on timeout. */
+		if (readUint32LE(header) != receivedBytes || length > otaWriter->getExpectedSize() - receivedBytes)
+			return;
+
+		if (ksf::crc32_update(data, length) != readUint32LE(header + 4))
+			return;
+
+		if (!otaWriter->write(data, length))
+		{
+			failUpdate(PSTR("write failed"));
+			return;
+		}
+
+		retryCounter = 0;
+		chunkTimer.restart();
+		reportProgress();
+
+		if (otaWriter->getReceivedBytes() != otaWriter->getExpectedSize())
+		{
+			requestChunks();
+			return;
+		}
+
+		if (!otaWriter->end())
+		{
+			failUpdate(PSTR("verification failed"));
+			return;
+		}
+
+		publish(OTA_RESULT_TOPIC, PSTR("ok"));
+		ksf::saveOtaBootIndicator(EOTAType::OTA_GENERIC);
+		onUpdateEnd->broadcast();
+
+		/* Give the result some time to leave the device. */
+		rebootTimer.setInterval(KSF_ONE_SEC_MS);
+	}
+
+	void ksMqttOtaUpdater::requestChunks()
+	{
+		static constexpr uint32_t WINDOW_SIZE{KSF_MQTT_OTA_CHUNK_SIZE * KSF_MQTT_OTA_WINDOW_CHUNKS};
+
+		auto expectedSize{otaWriter->getExpectedSize()};
+		auto pendingBytes{requestedEnd - otaWriter->getReceivedBytes()};
+		if (requestedEnd >= expectedSize || pendingBytes > WINDOW_SIZE / 2)
+			return;
+
+		auto length{std::min(expectedSize - requestedEnd, WINDOW_SIZE - pendingBytes)};
+
+		std::string request;
+		ksf::append_to_string(request, requestedEnd);
+		request += ' ';
+		ksf::append_to_string(request, length);
+		request += ' ';
+		ksf::append_to_string(request, KSF_MQTT_OTA_CHUNK_SIZE);
+
+		/* If the request can't be sent now, it will be repeated on timeout. */
+		auto mqttConnSp{mqttConnWp.lock()};
+		if (mqttConnSp && mqttConnSp->isConnected() && mqttConnSp->publish(OTA_REQ_TOPIC, request))
+			requestedEnd += length;
+	}
+
+	void ksMqttOtaUpdater::reportProgress()
+	{
+		auto percent{static_cast<uint8_t>(uint64_t{otaWriter->getReceivedBytes()} * 100 / otaWriter->getExpectedSize())};
+		if (percent < lastReportedPercent + 5 && percent != 100)
+			return;
+
+		lastReportedPercent = percent;
+
+		std::string progress;
+		ksf::append_to_string(progress, percent);
+		publish(OTA_PROGRESS_TOPIC, progress);
+	}
+
+	void ksMqttOtaUpdater::failUpdate(const char* reason)
+	{
+		if (otaWriter)
+			otaWriter->abort();
+
+		std::string result{PSTR("error: ")};
+		result += reason;
+		publish(OTA_RESULT_TOPIC, result);
+	}
+
+	void ksMqttOtaUpdater::publish(const char* topic, const std::string& payload)
+	{
+		if (auto mqttConnSp{mqttConnWp.lock()}; mqttConnSp && mqttConnSp->isConnected())
+			mqttConnSp->publish(topic, payload);
+	}
+
+	bool ksMqttOtaUpdater::isUpdating() const
+	{
+		return otaWriter && otaWriter->isActive();
+	}
+
+	bool ksMqttOtaUpdater::loop([[maybe_unused]] ksApplication* app)
+	{
+		if (rebootTimer.triggered())
+			ESP.restart();
+
+		if (!isUpdating())
+			return true;
+
+		/* Session survives reconnections, but not forever. */
+		if (otaWriter->isIdle(KSF_OTA_RESUME_TIMEOUT_MS))
+		{
+			failUpdate(PSTR("timeout"));
+			return true;
+		}
+
+		if (!chunkTimer.triggered())
+			return true;
+
+		/* Timeouts are counted only while connected, missing chunks are requested again after reconnection anyway. */
+		auto mqttConnSp{mqttConnWp.lock()};
+		if (!mqttConnSp || !mqttConnSp->isConnected())
+			return true;
+
+		if (++retryCounter > KSF_MQTT_OTA_MAX_RETRIES)
+		{
+			failUpdate(PSTR("timeout"));
+			return true;
+		}
+
+		requestedEnd = otaWriter->getReceivedBytes();
+		requestChunks();
+		return true;
+	}
+}
@@ -0,0 +1,185 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "../evt/ksEvent.h"
+#include "../ksComponent.h"
+#include "../ksConstants.h"
+
+#include "../misc/ksSimpleTimer.h"
+
+namespace ksf::misc
+{
+	class ksOtaWriter;
+}
+
+namespace ksf::comps
+{
+	class ksMqttConnector;
+
+	/*!
+		@brief A component that pulls firmware updates over MQTT.
+
+		Upon instantiation, the component searches for the ksMqttConnector component. It's meant for devices that
+		can't be reached directly (e.g. behind NAT), so the update server only talks to the broker. All the topics
+		are under the device prefix:
+
+		- "ota/ctl" (server -> device): "nonce" requests a nonce, "begin <size> <md5> [raw|heatshrink|delta] <hmac>"
+		  starts the update, "abort" stops it.
+		- "ota/nonce" (device -> server): nonce for the next begin command (16 hex digits).
+		- "ota/req" (device -> server): "<offset> <length> <chunkSize>" requests a range of the firmware file.
+		- "ota/chunk" (server -> device): offset (little endian uint32), CRC-32 of the data (little endian uint32) and the data.
+		- "ota/progress" (device -> server): percent of the file received, reported every 5%.
+		- "ota/result" (device -> server): "ok" or "error: <reason>".
+
+		Flow control is windowed. At most KSF_MQTT_OTA_WINDOW_CHUNKS chunks are requested ahead and more are requested
+		when half of them arrives, so the transfer doesn't stop on the round trip. Chunks are accepted only in order
+		and with valid CRC. Anything else is dropped and requested again when no valid chunk arrives in
+		KSF_MQTT_OTA_CHUNK_TIMEOUT_MS. Lost connection doesn't break the session, the transfer continues after reconnection.
+
+		The data is written through misc::ksOtaWriter, so compressed images and delta patches are supported as well.
+		After a successful update, the device reboots.
+
+		Anyone allowed to publish to the control topic could otherwise flash any firmware, so the begin command must be
+		authenticated. Its last argument is HMAC-SHA256 (hex) of "<nonce> <size> <md5> [encoding]" keyed with the secret
+		passed to the constructor, where the nonce is the last one published by the device. A nonce is random, valid
+		for a single begin command and dropped after it, so a recorded command can't be replayed. Begin commands are
+		rejected when the secret is empty. The chunks themselves are not signed - the MD5 from the authenticated
+		command is verified before the new image is marked bootable. The abort and nonce commands are not
+		authenticated, so a broker client with publish access to the device prefix can still interrupt an update.
+		Keep the secret out of the source repository and use broker ACLs as well.
+	*/
+	class ksMqttOtaUpdater : public ksComponent
+	{
+		KSF_RTTI_DECLARATIONS(ksMqttOtaUpdater, ksComponent)
+
+		protected:
+			std::weak_ptr<ksMqttConnector> mqttConnWp;				//!< Weak pointer to MQTT connector.
+			std::unique_ptr<evt::ksEventHandle> connEventHandle;	//!< Event handle for connection delegate.
+			std::unique_ptr<evt::ksEventHandle> msgEventHandle;		//!< Event handle for message delegate.
+			std::unique_ptr<misc::ksOtaWriter> otaWriter;			//!< Firmware writer (allocated on first update).
+			misc::ksSimpleTimer chunkTimer{KSF_MQTT_OTA_CHUNK_TIMEOUT_MS};	//!< Timer to detect missing chunks.
+			misc::ksSimpleTimer rebootTimer{0};						//!< Timer to reboot after the result has been sent.
+			std::string sharedSecret;								//!< Secret used to authenticate begin command.
+			std::string nonce;										//!< Nonce expected in begin command (empty if none).
+			uint32_t requestedEnd{0};								//!< End offset of the requested range.
+			uint8_t retryCounter{0};								//!< Number of consecutive chunk timeouts.
+			uint8_t lastReportedPercent{0};							//!< Last reported progress.
+
+			/*!
+				@brief Callback executed on MQTT connection. Subscribes the topics and continues the transfer.
+			*/
+			void onConnected();
+
+			/*!
+				@brief Callback executed on device message.
+				@param topic Topic (without the device prefix).
+				@param payload Payload.
+			*/
+			void onDeviceMessage(const std::string_view& topic, const std::string_view& payload);
+
+			/*!
+				@brief Handles control command.
+				@param command Command text.
+			*/
+			void handleCommand(std::string_view command);
+
+			/*!
+				@brief Generates new nonce and publishes it.
+			*/
+			void sendNonce();
+
+			/*!
+				@brief Verifies HMAC of begin command. The nonce is dropped, whatever the result.
+				@param args Command arguments (HMAC is removed on success).
+				@return True if the command is authentic, otherwise false.
+			*/
+			bool authenticate(std::string_view& args);
+
+			/*!
+				@brief Starts the update session.
+				@param args Command arguments (size, MD5 and optional encoding).
+				@return True on success, otherwise false.
+			*/
+			bool beginUpdate(std::string_view args);
+
+			/*!
+				@brief Handles firmware chunk.
+				@param payload Chunk message payload.
+			*/
+			void handleChunk(std::string_view payload);
+
+			/*!
+				@brief Requests next chunks if the window is half empty.
+			*/
+			void requestChunks();
+
+			/*!
+				@brief Reports progress every 5%.
+			*/
+			void reportProgress();
+
+			/*!
+				@brief Aborts the session and reports the error.
+				@param reason Error reason.
+			*/
+			void failUpdate(const char* reason);
+
+			/*!
+				@brief Publishes message to the OTA topic.
+				@param topic Topic relative to the device prefix.
+				@param payload Payload.
+			*/
+			void publish(const char* topic, const std::string& payload);
+
+		public:
+			DECLARE_KS_EVENT(onUpdateStart)			//!< onUpdateStart event that user can bind to.
+			DECLARE_KS_EVENT(onUpdateEnd)			//!< onUpdateEnd event that user can bind to.
+
+			/*!
+				@brief Constructs MQTT OTA updater component.
+				@param sharedSecret Secret used to authenticate begin command (empty rejects all updates).
+			*/
+			explicit ksMqttOtaUpdater(std::string sharedSecret);
+
+			/*!
+				@brief Destructs MQTT OTA updater component, aborting active update.
+			*/
+			virtual ~ksMqttOtaUpdater();
+
+			/*!
+				@brief Handles component post-initialization.
+
+				This method is responsible for reference gathering (component lookup) as well as binding to the events.
+
+				@param app Pointer to the parent ksApplication.
+				@return True on success, false on fail.
+			*/
+			bool postInit(ksApplication* app) override;
+
+			/*!
+				@brief Handles chunk timeouts and the reboot after the update.
+				@param app Pointer to the parent ksApplication.
+				@return True on success, false on fail.
+			*/
+			bool loop(ksApplication* app) override;
+
+			/*!
+				@brief Checks if the update is in progress.
+				@return True if the update session is active, otherwise false.
+			*/
+			bool isUpdating() const;
+	};
+}
@@ -0,0 +1,61 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#include <algorithm>
+
+#include "../ksApplication.h"
+#include "../misc/ksLogRing.h"
+
+#include "ksSerialLogger.h"
+
+namespace ksf::comps
+{
+#if APP_LOG_ENABLED
+	/* Shared by all instances, the component is created again after application rotation. */
+	static misc::ksLogRing::Cursor serialLogCursor;
+#endif
+
+	ksSerialLogger::ksSerialLogger(Print* output)
+		: output(output)
+	{}
+
+	bool ksSerialLogger::loop([[maybe_unused]] ksApplication* app)
+	{
+#if APP_LOG_ENABLED
+		auto& logRing{ksApplication::getLogRing()};
+
+		while (true)
+		{
+			if (pendingOffset == pending.size())
+			{
+				entry.clear();
+				if (!logRing.read(serialLogCursor, entry))
+					break;
+
+				pending.clear();
+				pendingOffset = 0;
+				misc::ksLogRing::appendAsText(entry, pending);
+				pending += PSTR("\r\n");
+			}
+
+			auto space{output->availableForWrite()};
+			if (space <= 0)
+				break;
+
+			auto length{std::min<std::size_t>(space, pending.size() - pendingOffset)};
+			auto written{output->write(reinterpret_cast<const uint8_t*>(pending.data()) + pendingOffset, length)};
+			pendingOffset += written;
+
+			if (written < length)
+				break;
+		}
+#endif
+		return true;
+	}
+}
@@ -0,0 +1,58 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <Arduino.h>
+
+#include "../ksComponent.h"
+
+namespace ksf::comps
+{
+	/*!
+		@brief A component that mirrors application logs to a serial port (or any other Print).
+
+		Drains the application log ring from the loop, like the device portal terminal does, starting with the history
+		still in the ring. Each call writes only as much as the output reports with availableForWrite, so a slow port
+		never blocks the loop (longer lines are written in parts). HardwareSerial and USB CDC ports report it.
+		Binary records (KSF_LOG_BINARY) are written in hex, prefixed with '#', so scripts/log_decoder.py --dump
+		can render a captured output.
+
+		Read position is kept across application rotation, so lines are not printed twice. Does nothing without APP_LOG_ENABLED.
+	*/
+	class ksSerialLogger : public ksComponent
+	{
+		KSF_RTTI_DECLARATIONS(ksSerialLogger, ksComponent)
+
+		protected:
+			Print* output{nullptr};						//!< Output the logs are written to.
+			std::string entry;							//!< Line read from the ring (reused buffer).
+			std::string pending;						//!< Text waiting to be written (reused buffer).
+			std::size_t pendingOffset{0};				//!< Number of pending bytes already written.
+
+		public:
+			/*!
+				@brief Constructs the serial logger. The output must be set up (e.g. Serial.begin) by the application.
+
+				Taken as a pointer, because addComponent passes the arguments by value (a reference would bind to a copy).
+
+				@param output Output the logs are written to (e.g. &Serial), must outlive the component.
+			*/
+			explicit ksSerialLogger(Print* output);
+
+			/*!
+				@brief Writes new log lines, as much as the output takes without blocking.
+				@param app Pointer to the parent ksApplication.
+				@return True on success, false otherwise.
+			*/
+			bool loop(ksApplication* app) override;
+	};
+}
@@ -9,11 +9,53 @@
 
 #include "ksComponent.h"
 #include "ksConstants.h"
+#include "misc/ksLogRing.h"
+#include "misc/ksLoopWatchdog.h"
+#if APP_LOG_ENABLED && KSF_LOG_PERSISTENT
+	#if defined(ESP32)
+		#include <esp_attr.h>
+	#else
+		#error KSF_LOG_PERSISTENT is supported only on ESP32.
+	#endif
+#endif
 
 #include "ksApplication.h"
 
 namespace ksf
 {
+#if APP_LOG_ENABLED && KSF_LOG_PERSISTENT
+	static constexpr uint32_t PERSISTENT_LOG_MAGIC{0x4B53504C};
+	static constexpr std::size_t PERSISTENT_LOG_STORAGE_SIZE{misc::ksLogRing::getStorageSize(KSF_LOG_RING_SIZE)};
+
+	/*!
+		@brief Log rings kept in memory that is not cleared on software reset.
+	*/
+	struct ksPersistentLogStorage
+	{
+		uint32_t magic;															//!< PERSISTENT_LOG_MAGIC if the storage has been initialized.
+		uint32_t activeIndex;													//!< Index of the ring written in this boot.
+		alignas(misc::ksLogRing::State) uint8_t rings[2][PERSISTENT_LOG_STORAGE_SIZE];	//!< Ring storages.
+	};
+
+	static __NOINIT_ATTR ksPersistentLogStorage persistentLogStorage;
+
+	/*!
+		@brief Picks the ring for this boot. The other one keeps the log of the previous boot.
+		@return Index of the ring for this boot.
+	*/
+	static uint32_t selectPersistentLogRing()
+	{
+		if (persistentLogStorage.magic != PERSISTENT_LOG_MAGIC || persistentLogStorage.activeIndex > 1)
+		{
+			persistentLogStorage.magic = PERSISTENT_LOG_MAGIC;
+			persistentLogStorage.activeIndex = 0;
+		}
+		else persistentLogStorage.activeIndex ^= 1;
+
+		return persistentLogStorage.activeIndex;
+	}
+#endif
+
 	ksApplication::~ksApplication() = default;
 
 	bool ksApplication::loop()
@@ -28,8 +70,13 @@ namespace ksf
 			switch (comp->componentState)
 			{
 				case ksComponentState::Active:
-					if (!comp->loop(this))
+				{
+					/* Component being executed is recorded, so a stall (or a watchdog reset) can be attributed to it. */
+					misc::ksLoopWatchdog::enter(comp->getInstanceName());
+					auto loopResult{comp->loop(this)};
+					if (!misc::ksLoopWatchdog::leave() || !loopResult)
 						return false;
+				}
 				break;
 
 				case ksComponentState::ToRemove:
@@ -57,19 +104,37 @@ namespace ksf
 	}
 
 #if APP_LOG_ENABLED
-	void ksApplication::log(AppLogProviderFunc_t provideLogFn) const
+	misc::ksLogRing& ksApplication::getLogRing()
 	{
-		if (appLogCallback && provideLogFn)
-		{
-			std::string theLog;
-			provideLogFn(theLog);
-			appLogCallback(std::move(theLog));
-		}
+#if KSF_LOG_PERSISTENT
+		static misc::ksLogRing logRing(persistentLogStorage.rings[selectPersistentLogRing()], PERSISTENT_LOG_STORAGE_SIZE, false);
+#else
+		static misc::ksLogRing logRing(KSF_LOG_RING_SIZE);
+#endif
+		return logRing;
+	}
+
+	const misc::ksLogRing* ksApplication::getPreviousLogRing()
+	{
+#if KSF_LOG_PERSISTENT
+		/* Current ring picks the storage, so it goes first. Lines are kept only if the ring survived the reset intact. */
+		getLogRing();
+		static misc::ksLogRing previousLogRing(persistentLogStorage.rings[persistentLogStorage.activeIndex ^ 1], PERSISTENT_LOG_STORAGE_SIZE, true);
+		return previousLogRing.getLineCount() > 0 ? &previousLogRing : nullptr;
+#else
+		return nullptr;
+#endif
+	}
+
+	std::string& ksApplication::getLogLineBuffer()
+	{
+		static std::string logLine;
+		return logLine;
 	}
 
-	void ksApplication::setLogCallback(AppLogCallbackFunc_t logCallback)
+	void ksApplication::writeLog(std::string_view line)
 	{
-		appLogCallback = std::move(logCallback);
+		getLogRing().write(line);
 	}
 #endif
 }
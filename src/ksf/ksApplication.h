@@ -12,14 +12,16 @@
 #include <memory>
 #include <list>
 #include <string>
+#include <string_view>
 #include <functional>
 
 #include "ksComponent.h"
+#include "ksLog.h"
 
-#if APP_LOG_ENABLED
-typedef std::function<void(std::string&)> AppLogProviderFunc_t;
-typedef std::function<void(std::string&&)> AppLogCallbackFunc_t;
-#endif
+namespace ksf::misc
+{
+	class ksLogRing;
+}
 
 namespace ksf 
 {
@@ -46,7 +48,17 @@ namespace ksf
 			std::list<std::shared_ptr<ksComponent>> components;		//!< An array with shared_ptr of components (holding main reference).
 
 #if APP_LOG_ENABLED
-			 AppLogCallbackFunc_t appLogCallback;					//!< Callback function for logging
+			/*!
+				@brief Retrieves the buffer used to build log lines. Reused, so building a line doesn't allocate.
+				@return Reference to the line buffer.
+			*/
+			static std::string& getLogLineBuffer();
+
+			/*!
+				@brief Writes a line into the log ring.
+				@param line Line to be written.
+			*/
+			static void writeLog(std::string_view line);
 #endif
 		public:
 			/*!
@@ -140,16 +152,55 @@ namespace ksf
 
 #if APP_LOG_ENABLED
 			/*!
-				@brief Calls log callback function with the string to be logged.
-				@param provideLogFn Function that appends a string to be logged using the reference provided as a parameter.
+				@brief Retrieves the log ring shared by all applications, so the history survives application rotation.
+
+				Consumers (e.g. ksDevicePortal terminal) keep their own cursor and drain the ring asynchronously.
+
+				@return Reference to the log ring.
 			*/
-			void log(AppLogProviderFunc_t provideLogFn) const;
+			static misc::ksLogRing& getLogRing();
 
 			/*!
-				@brief Sets log callback function. Called every time a new log is generated.
-				@param logCallback Function that is called after every log - ksDevicePortal uses this function to send logs to the browser when using Terminal feature.
+				@brief Retrieves the log ring of the previous boot (requires KSF_LOG_PERSISTENT).
+
+				Software resets (watchdog, exception, restart) don't clear it, so it tells what happened before the reset.
+
+				@return Pointer to the log ring of the previous boot or nullptr if there's no log that survived the reset.
 			*/
-			void setLogCallback(AppLogCallbackFunc_t logCallback);
+			static const misc::ksLogRing* getPreviousLogRing();
+
+			/*!
+				@brief Checks if lines written with log are stored (runtime log level is info or above).
+
+				Lets callers skip work of their own (e.g. collecting the pieces of a line) when logs are off.
+
+				@return True if log writes the line, otherwise false.
+			*/
+			bool isLogActive() const { return logLevel >= KSF_LOG_LEVEL_INFO; }
+
+			/*!
+				@brief Writes a line into the log ring (at info level).
+
+				Meant for lines built from pieces. Other lines should be logged with KSF_LOG_x macros (see ksLog.h),
+				which format straight into a stack buffer and are removed at compile time below KSF_LOG_LEVEL.
+
+				The line is built in a reused buffer and then copied into the ring, so logging doesn't allocate 
+				memory per line. The provider is taken as a template parameter, so passing a lambda doesn't wrap 
+				it into std::function.
+
+				@param provideLogFn Function that appends a string to be logged using the reference provided as a parameter.
+			*/
+			template <typename TLogProvider>
+			void log(TLogProvider&& provideLogFn) const
+			{
+				if (!isLogActive())
+					return;
+
+				auto& line{getLogLineBuffer()};
+				line.clear();
+				provideLogFn(line);
+				writeLog(line);
+			}
 #endif
 	};
 }
@@ -7,6 +7,10 @@
  *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
  */
 
+#include <array>
+#include <cmath>
+#include <cstring>
+
 #if defined(ESP32)
 	#include <WiFi.h>
 	#include <esp_phy_init.h>
@@ -22,6 +26,7 @@
 #include <LittleFS.h>
 
 #include "misc/ksConfig.h"
+#include "misc/ksLoopWatchdog.h"
 
 #include "ksConstants.h"
 
@@ -77,6 +82,9 @@ namespace ksf
 			indicatorFile.close();
 			LittleFS.remove(OTA_FILENAME_TEXT);
 		}
+
+		/* Pick up the culprit of the last loop stall and start watching component loops. */
+		misc::ksLoopWatchdog::begin();
 	}
 
 	const char* getNvsDirectory()
@@ -162,10 +170,129 @@ namespace ksf
 		return (static_cast<uint64_t>(uptime_high32) << 32) | uptime_low32;
 	}
 
+	/* Two-digit decimal representation of numbers 00-99. Tables are kept in flash, ESP8266 would copy them to RAM. */
+	static constexpr char DIGIT_PAIRS[] PROGMEM {
+		"00010203040506070809"
+		"10111213141516171819"
+		"20212223242526272829"
+		"30313233343536373839"
+		"40414243444546474849"
+		"50515253545556575859"
+		"60616263646566676869"
+		"70717273747576777879"
+		"80818283848586878889"
+		"90919293949596979899"
+	};
+
+	/* Powers of ten used to scale the fractional part. */
+	static constexpr uint32_t POWERS_OF_TEN[] PROGMEM {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+	/*!
+		@brief Writes decimal representation of a 32-bit unsigned integer, right-aligned, ending at the given position.
+		@param last Pointer past the last output character.
+		@param value Value to be converted.
+		@return Pointer to the first written character.
+	*/
+	static char* format_uint32_backwards(char* last, uint32_t value)
+	{
+		while (value >= 100)
+		{
+			auto pair{(value % 100) * 2};
+			value /= 100;
+			*--last = pgm_read_byte(&DIGIT_PAIRS[pair + 1]);
+			*--last = pgm_read_byte(&DIGIT_PAIRS[pair]);
+		}
+
+		if (value >= 10)
+		{
+			*--last = pgm_read_byte(&DIGIT_PAIRS[value * 2 + 1]);
+			*--last = pgm_read_byte(&DIGIT_PAIRS[value * 2]);
+		}
+		else *--last = '0' + value;
+
+		return last;
+	}
+
+	char* format_unsigned(char* first, uint64_t value)
+	{
+		char digits[20];
+		auto last{digits + sizeof(digits)}, pos{last};
+
+		/* Split into 32-bit chunks of 9 digits, so the hot loop uses 32-bit division only. */
+		while (value > UINT32_MAX)
+		{
+			auto chunk{static_cast<uint32_t>(value % 1000000000)};
+			value /= 1000000000;
+			auto chunkStart{format_uint32_backwards(pos, chunk)};
+			while (chunkStart > pos - 9)
+				*--chunkStart = '0';
+			pos = chunkStart;
+		}
+
+		pos = format_uint32_backwards(pos, static_cast<uint32_t>(value));
+
+		auto length{static_cast<std::size_t>(last - pos)};
+		std::memcpy(first, pos, length);
+		return first + length;
+	}
+
+	char* to_chars(char* first, double value, int decimals)
+	{
+		if (std::isnan(value))
+		{
+			std::memcpy(first, "nan", 3);
+			return first + 3;
+		}
+
+		if (value < 0)
+		{
+			*first++ = '-';
+			value = -value;
+		}
+
+		if (std::isinf(value))
+		{
+			std::memcpy(first, "inf", 3);
+			return first + 3;
+		}
+
+		decimals = decimals < 0 ? 0 : decimals > 9 ? 9 : decimals;
+		auto scale{static_cast<uint32_t>(pgm_read_dword(&POWERS_OF_TEN[decimals]))};
+
+		/* Too big for fixed notation in 64-bit integer, fall back to exponent notation. */
+		if (value * scale >= 1e18)
+			return first + snprintf(first, KSF_TO_CHARS_BUFFER_SIZE - 1, PSTR("%.*e"), decimals, value);
+
+		/* Round half away from zero, then split into integer and fractional part. */
+		auto scaled{static_cast<uint64_t>(value * scale + 0.5)};
+		auto integerPart{scaled / scale};
+		auto fractionalPart{static_cast<uint32_t>(scaled % scale)};
+
+		first = format_unsigned(first, integerPart);
+
+		if (decimals > 0)
+		{
+			*first++ = '.';
+			auto fractionEnd{first + decimals};
+			auto fractionStart{format_uint32_backwards(fractionEnd, fractionalPart)};
+			while (fractionStart > first)
+				*--fractionStart = '0';
+			first = fractionEnd;
+		}
+
+		return first;
+	}
+
+	void append_to_string(std::string& out, double value, int decimals)
+	{
+		char buffer[KSF_TO_CHARS_BUFFER_SIZE];
+		out.append(buffer, to_chars(buffer, value, decimals));
+	}
+
 	std::string to_string(double value, const int base)
 	{
-		char buf[33];
-		return dtostrf(value, (base + 2), base, buf);
+		char buffer[KSF_TO_CHARS_BUFFER_SIZE];
+		return std::string(buffer, to_chars(buffer, value, base));
 	}
 
 	std::string to_string(float value, const int base)
@@ -228,13 +355,13 @@ namespace ksf
 	{
 		std::string result;
 		result.reserve(32);
-		result += to_string(sec / 60 / 60 / 24);
+		append_to_string(result, sec / 60 / 60 / 24);
 		result += "d ";
-		result += to_string(sec / 60 / 60 % 24);
+		append_to_string(result, sec / 60 / 60 % 24);
 		result += "h ";
-		result += to_string(sec / 60 % 60);
+		append_to_string(result, sec / 60 % 60);
 		result += "m ";
-		result += to_string(sec % 60);
+		append_to_string(result, sec % 60);
 		result += "s";
 		return result;
 	}
@@ -245,56 +372,106 @@ namespace ksf
 		return getUptimeFromSeconds(static_cast<uint32_t>(uptimeSeconds));
 	}
 
-	std::string json_escape(const std::string& input)
+	/*!
+		@brief Builds the JSON escape table.
+
+		Each entry holds the character that follows the backslash in the escape sequence ('u' means \u00XX form)
+		or zero if the byte doesn't need escaping.
+
+		@return Escape table indexed by byte value.
+	*/
+	static constexpr std::array<char, 256> makeJsonEscapeTable()
 	{
-		std::string output;
-		output.reserve(input.size() * 6 / 5);
+		std::array<char, 256> table{};
+		for (std::size_t ch{0}; ch < 0x20; ++ch)
+			table[ch] = 'u';
+
+		table['"'] = '"';
+		table['\\'] = '\\';
+		table['\b'] = 'b';
+		table['\f'] = 'f';
+		table['\n'] = 'n';
+		table['\r'] = 'r';
+		table['\t'] = 't';
+		return table;
+	}
+
+	static constexpr std::array<char, 256> JSON_ESCAPE_TABLE PROGMEM {makeJsonEscapeTable()};
+
+	std::size_t json_safe_prefix_length(std::string_view input)
+	{
+		std::size_t length{0};
+		while (length < input.size() && pgm_read_byte(&JSON_ESCAPE_TABLE[static_cast<uint8_t>(input[length])]) == 0)
+			++length;
+		return length;
+	}
 
-		for (auto ch : input)
+	std::size_t json_escape_char(char ch, char* out)
+	{
+		static constexpr char HEX_DIGITS[] PROGMEM {"0123456789abcdef"};
+
+		auto escape{static_cast<char>(pgm_read_byte(&JSON_ESCAPE_TABLE[static_cast<uint8_t>(ch)]))};
+		if (escape == 0)
 		{
-			switch (ch)
-			{
-				case '"':
-					output.append(PSTR("\\\""), 2);
-				break;
-				case '\\':
-					output.append(PSTR("\\\\"), 2);
-					break;
-				case '\b':
-					output.append(PSTR("\\b"), 2);
-				break;
-				case '\f':
-					output.append(PSTR("\\f"), 2);
-				break;
-				case '\n':
-					output.append(PSTR("\\n"), 2);
-				break;
-				case '\r':
-					output.append(PSTR("\\r"), 2);
-				break;
-				case '\t':
-					output.append(PSTR("\\t"), 2);
-				break;
-				default:
-					if (static_cast<unsigned char>(ch) < 0x20)
-					{
-						unsigned int val{static_cast<unsigned char>(ch)};
-						const char hex[]{"0123456789abcdef"};
-						output += '\\';
-						output += 'u';
-						output += hex[(val >> 12) & 0xF];
-						output += hex[(val >> 8) & 0xF];
-						output += hex[(val >> 4) & 0xF];
-						output += hex[val & 0xF];
-					}
-					else output += ch;
+			*out = ch;
+			return 1;
+		}
+
+		out[0] = '\\';
+		out[1] = escape;
+		if (escape != 'u')
+			return 2;
+
+		auto val{static_cast<uint8_t>(ch)};
+		out[2] = '0';
+		out[3] = '0';
+		out[4] = pgm_read_byte(&HEX_DIGITS[val >> 4]);
+		out[5] = pgm_read_byte(&HEX_DIGITS[val & 0xF]);
+		return 6;
+	}
+
+	void json_escape_append(std::string& output, std::string_view input)
+	{
+		/* Safe bytes are not copied one by one, whole runs between escaped bytes are appended at once. */
+		while (!input.empty())
+		{
+			auto safeLength{json_safe_prefix_length(input)};
+			output.append(input.data(), safeLength);
+			if (safeLength == input.size())
 				break;
-			}
+
+			char sequence[6];
+			output.append(sequence, json_escape_char(input[safeLength], sequence));
+			input.remove_prefix(safeLength + 1);
 		}
+	}
 
+	std::string json_escape(std::string_view input)
+	{
+		std::string output;
+		output.reserve(input.size() * 6 / 5);
+		json_escape_append(output, input);
 		return output;
 	}
 
+	uint32_t crc32_update(const uint8_t* data, std::size_t length, uint32_t crc)
+	{
+		/* Nibble table is 16 times smaller than the usual byte table and still quite fast. */
+		static constexpr uint32_t CRC32_NIBBLE_TABLE[16] PROGMEM
+		{
+			0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+			0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+		};
+
+		crc = ~crc;
+		for (std::size_t i{0}; i < length; ++i)
+		{
+			crc = pgm_read_dword(&CRC32_NIBBLE_TABLE[(crc ^ data[i]) & 0x0F]) ^ (crc >> 4);
+			crc = pgm_read_dword(&CRC32_NIBBLE_TABLE[(crc ^ (data[i] >> 4)) & 0x0F]) ^ (crc >> 4);
+		}
+		return ~crc;
+	}
+
 	void loadCredentials(std::string& ssid, std::string& password)
 	{
 		USING_CONFIG_FILE(WIFI_CRED_FILENAME_TEXT)
@@ -13,7 +13,9 @@
 #include <cstdint>
 #include <limits>
 #include <string>
+#include <string_view>
 #include <charconv>
+#include <type_traits>
 #include <stdlib_noniso.h>
 
 /*! One second in milliseconds. */
@@ -27,10 +29,127 @@
 #define KSF_SEC_TO_MS(seconds) (seconds*1000UL)
 
 #ifndef KSF_MQTT_RECONNECT_DELAY_MS
-/*! MQTT reconnect delay in milliseconds. How much time in ms need to pass to retry connection. */
+/*! MQTT reconnect delay in milliseconds. How much time in ms need to pass to retry connection after the first failed attempt. */
 #define KSF_MQTT_RECONNECT_DELAY_MS 10000UL
 #endif
 
+#ifndef KSF_MQTT_RECONNECT_MAX_DELAY_MS
+/*! Upper bound of the MQTT reconnect delay in milliseconds. The delay doubles after each failed attempt. */
+#define KSF_MQTT_RECONNECT_MAX_DELAY_MS 300000UL
+#endif
+
+#ifndef KSF_MQTT_RECONNECT_JITTER_PERCENT
+/*! Random jitter applied to each MQTT reconnect delay, in percent of the delay. */
+#define KSF_MQTT_RECONNECT_JITTER_PERCENT 25U
+#endif
+
+#ifndef KSF_MQTT_BROKER_ADDRESS_TTL_MS
+/*! Time in milliseconds for which the resolved MQTT broker address is reused between reconnect attempts. */
+#define KSF_MQTT_BROKER_ADDRESS_TTL_MS 300000UL
+#endif
+
+#ifndef KSF_MQTT_KEEPALIVE_SECS
+/*! MQTT keep alive interval in seconds. */
+#define KSF_MQTT_KEEPALIVE_SECS 15U
+#endif
+
+#ifndef KSF_MQTT_RX_BUFFER_SIZE
+/*! MQTT receive buffer size in bytes. Incoming packets bigger than that are dropped. */
+#define KSF_MQTT_RX_BUFFER_SIZE 1024U
+#endif
+
+#ifndef KSF_MQTT_TX_BUFFER_SIZE
+/*! MQTT transmit buffer size in bytes. Used to coalesce headers and short payloads into a single write. */
+#define KSF_MQTT_TX_BUFFER_SIZE 128U
+#endif
+
+#ifndef KSF_MQTT_INFLIGHT_WINDOW
+/*! Maximum number of QoS 1/2 MQTT publishes waiting for acknowledgement (PUBACK, or PUBCOMP for QoS 2). */
+#define KSF_MQTT_INFLIGHT_WINDOW 8U
+#endif
+
+#ifndef KSF_MQTT_LOOP_TIME_HISTOGRAM
+/*! Set to 1 to collect histogram of time spent in MQTT client loop (power of two buckets, starting at 64 us). */
+#define KSF_MQTT_LOOP_TIME_HISTOGRAM 0
+#endif
+
+/*! Number of MQTT loop time histogram buckets. The last one collects loops longer than 64 ms. */
+#define KSF_MQTT_LOOP_TIME_HISTOGRAM_BUCKETS 12
+
+#ifndef KSF_DEVSTAT_COMPACT_BUFFER_SIZE
+/*! Size in bytes of the buffer used by ksDevStatMqttReporter to encode compact (JSON or CBOR) reports. */
+#define KSF_DEVSTAT_COMPACT_BUFFER_SIZE 384U
+#endif
+
+#ifndef KSF_LOG_RING_SIZE
+/*! Size in bytes of the application log ring (used only with APP_LOG_ENABLED). Terminal gets this much history on connection. */
+#define KSF_LOG_RING_SIZE 2048U
+#endif
+
+#ifndef KSF_LOG_PERSISTENT
+/*!
+	Set to 1 to keep the application log ring in memory that is not cleared on software reset (ESP32 only).
+	Each boot writes to one of two rings, so the log from before a watchdog reset or exception stays readable
+	after reboot. Costs two rings of KSF_LOG_RING_SIZE bytes.
+*/
+#define KSF_LOG_PERSISTENT 0
+#endif
+
+#ifndef KSF_LOG_LINE_MAX_LENGTH
+/*! Maximum length of a log line formatted by KSF_LOG_x macros (including the terminator). Longer lines are truncated. */
+#define KSF_LOG_LINE_MAX_LENGTH 192U
+#endif
+
+#ifndef KSF_WS_SEND_QUEUE_SIZE
+/*! Size in bytes of the WebSocket send queue of each client. When it's full, the oldest messages are dropped. */
+#define KSF_WS_SEND_QUEUE_SIZE 4096U
+#endif
+
+#ifndef KSF_WS_SEND_STALL_TIMEOUT_MS
+/*! Time in milliseconds after which a WebSocket client that doesn't receive queued messages is disconnected. */
+#define KSF_WS_SEND_STALL_TIMEOUT_MS 10000UL
+#endif
+
+#ifndef KSF_PORTAL_WS_FRAGMENT_SIZE
+/*! Size in bytes of Device Portal WebSocket response fragments. Responses are streamed in fragments of this size. */
+#define KSF_PORTAL_WS_FRAGMENT_SIZE 256U
+#endif
+
+#ifndef KSF_PORTAL_STREAM_CHUNK_SIZE
+/*! Size in bytes of chunks used to stream Device Portal static content from flash. Matches TCP MSS by default. */
+#define KSF_PORTAL_STREAM_CHUNK_SIZE 1460U
+#endif
+
+#ifndef KSF_OTA_BLOCK_SIZE
+/*! Size in bytes of blocks passed to the flash during OTA update. Should be a multiple of the flash sector size. */
+#define KSF_OTA_BLOCK_SIZE 4096U
+#endif
+
+#ifndef KSF_OTA_RESUME_TIMEOUT_MS
+/*! Time in milliseconds after which interrupted Device Portal OTA upload can't be resumed anymore. */
+#define KSF_OTA_RESUME_TIMEOUT_MS 60000UL
+#endif
+
+#ifndef KSF_MQTT_OTA_CHUNK_SIZE
+/*! Size in bytes of firmware chunks requested by MQTT OTA updater. Chunk with its topic and 8 byte header must fit in KSF_MQTT_RX_BUFFER_SIZE. */
+#define KSF_MQTT_OTA_CHUNK_SIZE 768U
+#endif
+
+#ifndef KSF_MQTT_OTA_WINDOW_CHUNKS
+/*! Maximum number of firmware chunks requested by MQTT OTA updater but not received yet. */
+#define KSF_MQTT_OTA_WINDOW_CHUNKS 4U
+#endif
+
+#ifndef KSF_MQTT_OTA_CHUNK_TIMEOUT_MS
+/*! Time in milliseconds without a valid chunk after which MQTT OTA updater requests missing chunks again. */
+#define KSF_MQTT_OTA_CHUNK_TIMEOUT_MS 5000UL
+#endif
+
+#ifndef KSF_MQTT_OTA_MAX_RETRIES
+/*! Number of consecutive chunk timeouts after which MQTT OTA update fails. */
+#define KSF_MQTT_OTA_MAX_RETRIES 5U
+#endif
+
 #ifndef KSF_DOMAIN_QUERY_INTERVAL_MS
 /*! Interval in milliseconds between DNS query retries. */
 #define KSF_DOMAIN_QUERY_INTERVAL_MS 3000UL
@@ -61,6 +180,28 @@
 #define KSF_WATCHDOG_TIMEOUT_SECS 10UL
 #endif
 
+#ifndef KSF_LOOP_WATCHDOG_BUDGET_MS
+/*! Time budget of a single component loop call in milliseconds. Longer calls are reported as loop stalls (0 disables the loop watchdog). */
+#define KSF_LOOP_WATCHDOG_BUDGET_MS 1000UL
+#endif
+
+#ifndef KSF_LOOP_WATCHDOG_BREAK_APP
+/*! Set to 1 to stop the application (like when a component returns false) when a component loop exceeds the budget. */
+#define KSF_LOOP_WATCHDOG_BREAK_APP 0
+#endif
+
+#ifndef KSF_LOOP_WATCHDOG_RTC_OFFSET
+/*!
+	ESP8266 only. Offset (in 32-bit words) of RTC user memory reserved for the last loop stall, which is read and cleared
+	on every boot. The record takes 11 words and must fit into the 128 words. Other users of RTC user memory (the sketch,
+	libraries) must not touch these words. -1 (default) keeps the record in RAM only, so stalls are not attributed after reset.
+*/
+#define KSF_LOOP_WATCHDOG_RTC_OFFSET -1
+#endif
+
+/*! Size of the buffer that fits any number formatted with ksf::to_chars. */
+#define KSF_TO_CHARS_BUFFER_SIZE 32
+
 /*! Helper macro for init ks Framework. */
 #define KSF_FRAMEWORK_INIT() ksf::initializeFramework();
 
@@ -117,6 +258,79 @@ namespace ksf
 	*/
 	extern uint64_t millis64();
 
+	/*!
+		@brief Writes decimal representation of an unsigned integer into the buffer.
+
+		Digits are produced two at a time from a lookup table. Values that fit into 32 bits skip 
+		64-bit division, which is emulated in software on ESP chips.
+
+		@param first Pointer to the output buffer (at least KSF_TO_CHARS_BUFFER_SIZE characters).
+		@param value Value to be converted.
+		@return Pointer past the last written character. The output is not null-terminated.
+	*/
+	extern char* format_unsigned(char* first, uint64_t value);
+
+	/*!
+		@brief Writes decimal representation of an integer into the buffer.
+
+		@tparam _Type Integer type.
+
+		@param first Pointer to the output buffer (at least KSF_TO_CHARS_BUFFER_SIZE characters).
+		@param value Value to be converted.
+		@return Pointer past the last written character. The output is not null-terminated.
+	*/
+	template <typename _Type>
+	inline std::enable_if_t<std::is_integral_v<_Type>, char*> to_chars(char* first, _Type value)
+	{
+		if constexpr (std::is_signed_v<_Type>)
+		{
+			if (value < 0)
+			{
+				/* Negate as unsigned, so the minimum value doesn't overflow. */
+				*first++ = '-';
+				return format_unsigned(first, ~static_cast<uint64_t>(static_cast<int64_t>(value)) + 1);
+			}
+		}
+
+		return format_unsigned(first, static_cast<uint64_t>(value));
+	}
+
+	/*!
+		@brief Writes fixed-precision decimal representation of a floating point value into the buffer.
+
+		Values too big for fixed notation are written in exponent notation. NaN and infinity are written as "nan" and "inf".
+
+		@param first Pointer to the output buffer (at least KSF_TO_CHARS_BUFFER_SIZE characters).
+		@param value Value to be converted.
+		@param decimals Number of decimal places (0-9, larger values are clamped).
+		@return Pointer past the last written character. The output is not null-terminated.
+	*/
+	extern char* to_chars(char* first, double value, int decimals);
+
+	/*!
+		@brief Appends decimal representation of an integer to the string, without temporary strings.
+
+		@tparam _Type Integer type.
+
+		@param out String to append to.
+		@param value Value to be appended.
+	*/
+	template <typename _Type>
+	inline std::enable_if_t<std::is_integral_v<_Type>> append_to_string(std::string& out, _Type value)
+	{
+		char buffer[KSF_TO_CHARS_BUFFER_SIZE];
+		out.append(buffer, to_chars(buffer, value));
+	}
+
+	/*!
+		@brief Appends fixed-precision decimal representation of a floating point value to the string, without temporary strings.
+
+		@param out String to append to.
+		@param value Value to be appended.
+		@param decimals Number of decimal places.
+	*/
+	extern void append_to_string(std::string& out, double value, int decimals);
+
 	/*!
 		@brief Helper function that converts double value into a string.
 
@@ -139,7 +353,9 @@ namespace ksf
 	extern std::string to_string(float value, const int base);
 
 	/*!
-		@brief Helper function template to convert a string into another type.
+		@brief Helper function template to convert a value into a string.
+
+		Integers are formatted with ksf::to_chars, other types are passed to std::to_string.
 
 		@tparam _Type Type to be converted.
 
@@ -149,7 +365,12 @@ namespace ksf
 	template <typename _Type>
 	inline std::string to_string(const _Type& input)
 	{
-		return std::to_string(input);
+		if constexpr (std::is_integral_v<_Type>)
+		{
+			char buffer[KSF_TO_CHARS_BUFFER_SIZE];
+			return std::string(buffer, to_chars(buffer, input));
+		}
+		else return std::to_string(input);
 	}
 
 	/*!
@@ -239,7 +460,42 @@ namespace ksf
 		@param input The string to be escaped.
 		@return JSON-safe escaped string.
 	*/
-	extern std::string json_escape(const std::string& input);
+	extern std::string json_escape(std::string_view input);
+
+	/*!
+		@brief Escapes a string for safe use in JSON and appends it to the output string.
+
+		Same as json_escape, but doesn't create a temporary string. Bytes that don't need escaping
+		are found with a lookup table and appended in runs.
+
+		@param output String to append the escaped input to.
+		@param input The string to be escaped.
+	*/
+	extern void json_escape_append(std::string& output, std::string_view input);
+
+	/*!
+		@brief Finds the length of the leading run of bytes that don't need JSON escaping.
+		@param input The string to be checked.
+		@return Number of leading bytes that can be copied as they are.
+	*/
+	extern std::size_t json_safe_prefix_length(std::string_view input);
+
+	/*!
+		@brief Writes JSON representation of a single character (escape sequence or the character itself).
+		@param ch Character to be escaped.
+		@param out Output buffer, must have room for 6 characters.
+		@return Number of characters written.
+	*/
+	extern std::size_t json_escape_char(char ch, char* out);
+
+	/*!
+		@brief Calculates CRC-32 (IEEE 802.3, same as zlib crc32) of the data.
+		@param data Pointer to the data.
+		@param length Length of the data.
+		@param crc CRC of the previous part of the data, to calculate CRC in parts (0 for the first part).
+		@return CRC-32 value.
+	*/
+	extern uint32_t crc32_update(const uint8_t* data, std::size_t length, uint32_t crc = 0);
 
 	/*!
 		@brief Helper function to get latest reset reason.
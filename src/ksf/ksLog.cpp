@@ -0,0 +1,113 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#include <Arduino.h>
+#include <cstdarg>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+
+#include "ksApplication.h"
+#include "misc/ksLogRing.h"
+
+#include "ksLog.h"
+
+#if APP_LOG_ENABLED
+namespace ksf
+{
+	uint8_t logLevel{KSF_LOG_LEVEL};
+
+	void setLogLevel(uint8_t level)
+	{
+		logLevel = std::min<uint8_t>(level, KSF_LOG_LEVEL);
+	}
+
+	void logFormat(const char* format, ...)
+	{
+		/* Formatted on the stack and copied into the ring, nothing is allocated. Too long lines are truncated. */
+		char line[KSF_LOG_LINE_MAX_LENGTH];
+
+		va_list args;
+		va_start(args, format);
+		auto length{vsnprintf_P(line, sizeof(line), format, args)};
+		va_end(args);
+
+		if (length < 0)
+			return;
+
+		ksApplication::getLogRing().write({line, std::min<std::size_t>(length, sizeof(line) - 1)});
+	}
+
+	ksLogRecordWriter::ksLogRecordWriter(uint8_t level, uint32_t id)
+		: record{0, level, static_cast<uint8_t>(id), static_cast<uint8_t>(id >> 8), static_cast<uint8_t>(id >> 16), static_cast<uint8_t>(id >> 24)}, length(6)
+	{}
+
+	void ksLogRecordWriter::writeVarint(uint8_t tag, uint64_t value)
+	{
+		uint8_t encoded[10];
+		uint8_t encodedLength{0};
+		for (; value >= 0x80; value >>= 7)
+			encoded[encodedLength++] = static_cast<uint8_t>(value) | 0x80;
+		encoded[encodedLength++] = static_cast<uint8_t>(value);
+
+		/* Once an argument is dropped, the following ones are dropped too, so the decoder knows where they are missing. */
+		if (isTruncated || sizeof(record) - length < 1U + encodedLength)
+		{
+			isTruncated = true;
+			return;
+		}
+
+		record[length++] = tag;
+		std::memcpy(record + length, encoded, encodedLength);
+		length += encodedLength;
+	}
+
+	void ksLogRecordWriter::writeFloat(float value)
+	{
+		if (isTruncated || sizeof(record) - length < 1 + sizeof(value))
+		{
+			isTruncated = true;
+			return;
+		}
+
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+
+		record[length++] = LOG_ARG_FLOAT;
+		for (uint8_t i{0}; i < sizeof(bits); ++i, bits >>= 8)
+			record[length++] = static_cast<uint8_t>(bits);
+	}
+
+	void ksLogRecordWriter::writeString(const char* value)
+	{
+		auto maxLength{std::exchange(stringPrecision, SIZE_MAX)};
+		std::size_t valueLength{value ? strnlen_P(value, maxLength) : 0};
+
+		/* Too long string is cut to the space left (minus tag and length), the text that fits is still useful. */
+		auto space{sizeof(record) - length};
+		auto isCut{valueLength + 3 > space};
+		if (isCut)
+			valueLength = space > 3 ? space - 3 : 0;
+
+		writeVarint(LOG_ARG_STRING, valueLength);
+		if (isTruncated)
+			return;
+
+		if (valueLength > 0)
+			memcpy_P(record + length, value, valueLength);
+		length += valueLength;
+		isTruncated = isCut;
+	}
+
+	void ksLogRecordWriter::commit()
+	{
+		ksApplication::getLogRing().write({reinterpret_cast<const char*>(record), length});
+	}
+}
+#endif
@@ -0,0 +1,292 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+#include "ksConstants.h"
+
+#define KSF_LOG_LEVEL_NONE 0		//!< No logs.
+#define KSF_LOG_LEVEL_ERROR 1		//!< Errors only.
+#define KSF_LOG_LEVEL_WARN 2		//!< Errors and warnings.
+#define KSF_LOG_LEVEL_INFO 3		//!< Errors, warnings and information.
+#define KSF_LOG_LEVEL_DEBUG 4		//!< All of the above and debug messages.
+#define KSF_LOG_LEVEL_TRACE 5		//!< Everything, including very frequent messages (e.g. each MQTT message).
+
+#ifndef KSF_LOG_LEVEL
+/*! Highest level of logs compiled in (requires APP_LOG_ENABLED). Calls above this level are removed, their arguments are not evaluated. */
+	#if APP_LOG_ENABLED
+		#define KSF_LOG_LEVEL KSF_LOG_LEVEL_DEBUG
+	#else
+		#define KSF_LOG_LEVEL KSF_LOG_LEVEL_NONE
+	#endif
+#endif
+
+#ifndef KSF_LOG_BINARY
+/*!
+	Set to 1 to store KSF_LOG_x calls as binary records (format id and raw arguments) instead of formatted text.
+	Format strings are not stored on the device, scripts/log_decoder.py renders the records using the map
+	generated at build time (ksf_log_map.json in the build directory).
+*/
+	#define KSF_LOG_BINARY 0
+#endif
+
+#if APP_LOG_ENABLED
+namespace ksf
+{
+	/*!
+		@brief Current runtime log level. Calls above this level are skipped with a single comparison.
+	*/
+	extern uint8_t logLevel;
+
+	/*!
+		@brief Sets runtime log level. Levels above KSF_LOG_LEVEL can't be enabled, because they are not compiled in.
+		@param level One of KSF_LOG_LEVEL_x values (KSF_LOG_LEVEL_NONE stops logging).
+	*/
+	extern void setLogLevel(uint8_t level);
+
+	/*!
+		@brief Formats a log line on the stack and writes it into the application log ring.
+
+		Don't call it directly, use KSF_LOG_x macros, which keep the format in flash and check the level first.
+
+		@param format Format string (printf-like, in flash).
+	*/
+	extern void logFormat(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+	/*!
+		@brief Calculates id of the log format (32-bit FNV-1a hash). Must match scripts/log_map.py.
+		@param format Format string.
+		@return Format id.
+	*/
+	constexpr uint32_t logFormatId(const char* format)
+	{
+		uint32_t hash{2166136261UL};
+		for (; *format; ++format)
+			hash = (hash ^ static_cast<uint8_t>(*format)) * 16777619UL;
+		return hash;
+	}
+
+	/*!
+		@brief Finds arguments that are precision of a string conversion (like in "%.*s").
+
+		Such strings are often not null-terminated, so the precision limits the encoded length instead of being encoded.
+
+		@param format Format string.
+		@return Mask with a bit set for each argument (by index) that is a string precision.
+	*/
+	constexpr uint32_t logPrecisionMask(const char* format)
+	{
+		uint32_t mask{0};
+		uint8_t argIndex{0};
+		while (*format)
+		{
+			if (*format++ != '%')
+				continue;
+
+			if (*format == '%')
+			{
+				++format;
+				continue;
+			}
+
+			while (*format == '-' || *format == '+' || *format == ' ' || *format == '#' || *format == '0')
+				++format;
+
+			if (*format == '*')
+			{
+				++format;
+				++argIndex;
+			}
+			while (*format >= '0' && *format <= '9')
+				++format;
+
+			int8_t precisionIndex{-1};
+			if (*format == '.')
+			{
+				if (*++format == '*')
+				{
+					++format;
+					precisionIndex = argIndex++;
+				}
+				while (*format >= '0' && *format <= '9')
+					++format;
+			}
+
+			while (*format == 'h' || *format == 'l' || *format == 'L' || *format == 'q' || *format == 'j' || *format == 'z' || *format == 't')
+				++format;
+
+			if (*format == 's' && precisionIndex >= 0 && precisionIndex < 32)
+				mask |= 1UL << precisionIndex;
+
+			if (*format)
+			{
+				++format;
+				++argIndex;
+			}
+		}
+		return mask;
+	}
+
+	/*!
+		@brief Builds a binary log record on the stack and writes it into the application log ring.
+
+		Record layout: zero byte (text lines never start with it), level, format id (little endian uint32)
+		and the arguments. Each argument is a type tag followed by the value:
+		- LOG_ARG_UNSIGNED: LEB128 varint (unsigned integers and pointers).
+		- LOG_ARG_SIGNED: zigzag encoded LEB128 varint.
+		- LOG_ARG_FLOAT: little endian float32 (doubles lose precision).
+		- LOG_ARG_STRING: varint length followed by the characters.
+
+		Arguments that don't fit into KSF_LOG_LINE_MAX_LENGTH are dropped, the decoder prints them as missing.
+	*/
+	class ksLogRecordWriter
+	{
+		public:
+			static constexpr uint8_t LOG_ARG_UNSIGNED{0};		//!< Unsigned integer tag.
+			static constexpr uint8_t LOG_ARG_SIGNED{1};			//!< Signed integer tag.
+			static constexpr uint8_t LOG_ARG_FLOAT{2};			//!< Float tag.
+			static constexpr uint8_t LOG_ARG_STRING{3};			//!< String tag.
+
+		protected:
+			uint8_t record[KSF_LOG_LINE_MAX_LENGTH];			//!< Record buffer.
+			std::size_t length{0};								//!< Length of the record.
+			std::size_t stringPrecision{SIZE_MAX};				//!< Length limit for the next string argument.
+			bool isTruncated{false};							//!< True if an argument didn't fit.
+
+			/*!
+				@brief Writes tag and LEB128 encoded value.
+				@param tag Argument tag.
+				@param value Value to be written.
+			*/
+			void writeVarint(uint8_t tag, uint64_t value);
+
+			/*!
+				@brief Writes a float argument.
+				@param value Value to be written.
+			*/
+			void writeFloat(float value);
+
+			/*!
+				@brief Writes a string argument.
+				@param value Null-terminated string (or limited by the preceding precision argument).
+			*/
+			void writeString(const char* value);
+
+		public:
+			/*!
+				@brief Starts the record.
+				@param level Log level.
+				@param id Format id.
+			*/
+			ksLogRecordWriter(uint8_t level, uint32_t id);
+
+			/*!
+				@brief Writes an argument, choosing the encoding by its type.
+				@param arg Argument.
+				@param isStringPrecision True if the argument is precision of the next string argument.
+			*/
+			template <typename TArg>
+			void add(const TArg& arg, bool isStringPrecision)
+			{
+				if constexpr (std::is_enum_v<TArg>)
+				{
+					add(static_cast<std::underlying_type_t<TArg>>(arg), isStringPrecision);
+				}
+				else if constexpr (std::is_integral_v<TArg>)
+				{
+					if (isStringPrecision)
+						stringPrecision = arg < 0 ? SIZE_MAX : static_cast<std::size_t>(arg);
+					else if constexpr (std::is_signed_v<TArg>)
+						writeVarint(LOG_ARG_SIGNED, (static_cast<uint64_t>(arg) << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(arg) >> 63));
+					else
+						writeVarint(LOG_ARG_UNSIGNED, arg);
+				}
+				else if constexpr (std::is_floating_point_v<TArg>)
+				{
+					writeFloat(static_cast<float>(arg));
+				}
+				else if constexpr (std::is_convertible_v<TArg, const char*>)
+				{
+					writeString(arg);
+				}
+				else
+				{
+					static_assert(std::is_pointer_v<TArg>, "Unsupported log argument type.");
+					writeVarint(LOG_ARG_UNSIGNED, reinterpret_cast<uintptr_t>(arg));
+				}
+			}
+
+			/*!
+				@brief Writes the record into the application log ring.
+			*/
+			void commit();
+	};
+
+	/*!
+		@brief Writes a binary log record. Don't call it directly, use KSF_LOG_x macros.
+		@param level Log level.
+		@param id Format id.
+		@param precisionMask Mask of string precision arguments (see logPrecisionMask).
+		@param args Format arguments.
+	*/
+	template <typename... TArgs>
+	void logBinary(uint8_t level, uint32_t id, uint32_t precisionMask, const TArgs&... args)
+	{
+		ksLogRecordWriter writer(level, id);
+		[[maybe_unused]] uint8_t argIndex{0};
+		(writer.add(args, (precisionMask & (1UL << argIndex++)) != 0), ...);
+		writer.commit();
+	}
+}
+
+	#if KSF_LOG_BINARY
+		#define KSF_LOG_AT(level, format, ...) do { if ((level) <= ksf::logLevel) { \
+			static constexpr uint32_t ksfLogId{ksf::logFormatId(format)}; \
+			static constexpr uint32_t ksfLogPrecisionMask{ksf::logPrecisionMask(format)}; \
+			ksf::logBinary(level, ksfLogId, ksfLogPrecisionMask, ##__VA_ARGS__); } } while (0)
+	#else
+		#define KSF_LOG_AT(level, format, ...) do { if ((level) <= ksf::logLevel) ksf::logFormat(PSTR(format), ##__VA_ARGS__); } while (0)
+	#endif
+#else
+	#define KSF_LOG_AT(level, format, ...) do {} while (0)
+#endif
+
+#if KSF_LOG_LEVEL >= KSF_LOG_LEVEL_ERROR
+	#define KSF_LOG_ERROR(format, ...) KSF_LOG_AT(KSF_LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+#else
+	#define KSF_LOG_ERROR(format, ...) do {} while (0)
+#endif
+
+#if KSF_LOG_LEVEL >= KSF_LOG_LEVEL_WARN
+	#define KSF_LOG_WARN(format, ...) KSF_LOG_AT(KSF_LOG_LEVEL_WARN, format, ##__VA_ARGS__)
+#else
+	#define KSF_LOG_WARN(format, ...) do {} while (0)
+#endif
+
+#if KSF_LOG_LEVEL >= KSF_LOG_LEVEL_INFO
+	#define KSF_LOG_INFO(format, ...) KSF_LOG_AT(KSF_LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#else
+	#define KSF_LOG_INFO(format, ...) do {} while (0)
+#endif
+
+#if KSF_LOG_LEVEL >= KSF_LOG_LEVEL_DEBUG
+	#define KSF_LOG_DEBUG(format, ...) KSF_LOG_AT(KSF_LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#else
+	#define KSF_LOG_DEBUG(format, ...) do {} while (0)
+#endif
+
+#if KSF_LOG_LEVEL >= KSF_LOG_LEVEL_TRACE
+	#define KSF_LOG_TRACE(format, ...) KSF_LOG_AT(KSF_LOG_LEVEL_TRACE, format, ##__VA_ARGS__)
+#else
+	#define KSF_LOG_TRACE(format, ...) do {} while (0)
+#endif
@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include <Arduino.h>
 #include <cstddef>
 
 namespace ksf
@@ -36,6 +37,12 @@ namespace ksf
 			*/
 			virtual std::size_t getInstanceType() const = 0;
 
+			/*!
+				@brief Retrieves class name of the object (in flash), e.g. to tell which component is being executed.
+				@return Object class name.
+			*/
+			virtual const char* getInstanceName() const = 0;
+
 			/*!
 				@brief Checks whether object is of given type.
 				@param id Type ID to check against.
@@ -81,6 +88,11 @@ namespace ksf
 			{																		\
 				return _Type::getClassType(); 										\
 			}																		\
+			virtual const char* getInstanceName() const						\
+			{																		\
+				static constexpr char name[] PROGMEM {#_Type};					\
+				return name;														\
+			}																		\
 			static std::size_t getClassType()									\
 			{																		\
 				static int d{0}; return (std::size_t)&d; 							\
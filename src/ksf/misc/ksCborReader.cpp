@@ -0,0 +1,389 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#include <cmath>
+#include <cstring>
+
+#include "ksCborReader.h"
+
+namespace ksf::misc
+{
+	static constexpr uint8_t CBOR_MAJOR_UNSIGNED{0};
+	static constexpr uint8_t CBOR_MAJOR_NEGATIVE{1};
+	static constexpr uint8_t CBOR_MAJOR_BYTES{2};
+	static constexpr uint8_t CBOR_MAJOR_TEXT{3};
+	static constexpr uint8_t CBOR_MAJOR_ARRAY{4};
+	static constexpr uint8_t CBOR_MAJOR_MAP{5};
+	static constexpr uint8_t CBOR_MAJOR_TAG{6};
+
+	static constexpr uint8_t CBOR_FALSE{0xF4};
+	static constexpr uint8_t CBOR_TRUE{0xF5};
+	static constexpr uint8_t CBOR_NULL{0xF6};
+	static constexpr uint8_t CBOR_UNDEFINED{0xF7};
+	static constexpr uint8_t CBOR_FLOAT16{0xF9};
+	static constexpr uint8_t CBOR_FLOAT32{0xFA};
+	static constexpr uint8_t CBOR_FLOAT64{0xFB};
+	static constexpr uint8_t CBOR_BREAK{0xFF};
+
+	/*!
+		@brief Converts IEEE 754 half precision number to double.
+		@param half Half precision bits.
+		@return Converted value.
+	*/
+	static double halfToDouble(uint16_t half)
+	{
+		int exponent{(half >> 10) & 0x1F};
+		int mantissa{half & 0x3FF};
+		double value;
+
+		if (exponent == 0)
+			value = std::ldexp(mantissa, -24);
+		else if (exponent != 31)
+			value = std::ldexp(mantissa + 1024, exponent - 25);
+		else
+			value = mantissa == 0 ? INFINITY : NAN;
+
+		return (half & 0x8000) ? -value : value;
+	}
+
+	ksCborReader::ksCborReader(const uint8_t* data, std::size_t size)
+		: data(data), size(size)
+	{}
+
+	ksCborReader::ksCborReader(std::string_view payload)
+		: data(reinterpret_cast<const uint8_t*>(payload.data())), size(payload.size())
+	{}
+
+	bool ksCborReader::peekHead(uint8_t& majorType, uint64_t& argument, std::size_t& headLength) const
+	{
+		if (position >= size)
+			return false;
+
+		auto initialByte{data[position]};
+		majorType = initialByte >> 5;
+		uint8_t additionalInfo = initialByte & 0x1F;
+
+		if (additionalInfo < 24)
+		{
+			argument = additionalInfo;
+			headLength = 1;
+			return true;
+		}
+
+		/* Indefinite length is allowed only for strings and containers, for simple values it means break. */
+		if (additionalInfo == 31)
+		{
+			if (majorType < CBOR_MAJOR_BYTES || majorType == CBOR_MAJOR_TAG)
+				return false;
+
+			argument = INDEFINITE_LENGTH;
+			headLength = 1;
+			return true;
+		}
+
+		/* Values 28-30 are reserved. */
+		if (additionalInfo > 27)
+			return false;
+
+		std::size_t argumentBytes = 1 << (additionalInfo - 24);
+		if (argumentBytes >= size - position)
+			return false;
+
+		argument = 0;
+		for (std::size_t i{1}; i <= argumentBytes; ++i)
+			argument = (argument << 8) | data[position + i];
+
+		headLength = 1 + argumentBytes;
+		return true;
+	}
+
+	bool ksCborReader::readHead(uint8_t expectedMajorType, uint64_t& argument)
+	{
+		uint8_t majorType;
+		std::size_t headLength;
+		if (!peekHead(majorType, argument, headLength))
+		{
+			error = error || position < size;
+			return false;
+		}
+
+		if (majorType != expectedMajorType)
+			return false;
+
+		position += headLength;
+		return true;
+	}
+
+	bool ksCborReader::readString(uint8_t majorType, std::string_view& out)
+	{
+		uint8_t actualMajorType;
+		uint64_t length;
+		std::size_t headLength;
+		if (!peekHead(actualMajorType, length, headLength))
+		{
+			error = error || position < size;
+			return false;
+		}
+
+		if (actualMajorType != majorType)
+			return false;
+
+		/* Chunked strings are not supported, truncated strings are malformed. */
+		if (length == INDEFINITE_LENGTH || length > size - position - headLength)
+		{
+			error = true;
+			return false;
+		}
+
+		out = {reinterpret_cast<const char*>(data + position + headLength), static_cast<std::size_t>(length)};
+		position += headLength + length;
+		return true;
+	}
+
+	ksCborReader::Type ksCborReader::peekType() const
+	{
+		if (position >= size)
+			return Type::End;
+
+		uint8_t majorType;
+		uint64_t argument;
+		std::size_t headLength;
+		if (!peekHead(majorType, argument, headLength))
+			return data[position] == CBOR_BREAK ? Type::Break : Type::Invalid;
+
+		switch (majorType)
+		{
+			case CBOR_MAJOR_UNSIGNED: return Type::Unsigned;
+			case CBOR_MAJOR_NEGATIVE: return Type::Negative;
+			case CBOR_MAJOR_BYTES: return Type::Bytes;
+			case CBOR_MAJOR_TEXT: return Type::Text;
+			case CBOR_MAJOR_ARRAY: return Type::Array;
+			case CBOR_MAJOR_MAP: return Type::Map;
+			case CBOR_MAJOR_TAG: return Type::Tag;
+			default: break;
+		}
+
+		switch (data[position])
+		{
+			case CBOR_FALSE:
+			case CBOR_TRUE:
+				return Type::Bool;
+			case CBOR_NULL:
+			case CBOR_UNDEFINED:
+				return Type::Null;
+			case CBOR_FLOAT16:
+			case CBOR_FLOAT32:
+			case CBOR_FLOAT64:
+				return Type::Float;
+			case CBOR_BREAK:
+				return Type::Break;
+			default:
+				return Type::Invalid;
+		}
+	}
+
+	bool ksCborReader::readUnsigned(uint64_t& value)
+	{
+		return readHead(CBOR_MAJOR_UNSIGNED, value);
+	}
+
+	bool ksCborReader::readInt(int64_t& value)
+	{
+		uint8_t majorType;
+		uint64_t argument;
+		std::size_t headLength;
+		if (!peekHead(majorType, argument, headLength))
+		{
+			error = error || position < size;
+			return false;
+		}
+
+		if ((majorType != CBOR_MAJOR_UNSIGNED && majorType != CBOR_MAJOR_NEGATIVE) || argument > INT64_MAX)
+			return false;
+
+		/* Negative integer is encoded as -1 - N, which equals to bitwise negation. */
+		value = majorType == CBOR_MAJOR_UNSIGNED ? static_cast<int64_t>(argument) : ~static_cast<int64_t>(argument);
+		position += headLength;
+		return true;
+	}
+
+	bool ksCborReader::readBool(bool& value)
+	{
+		if (position >= size || (data[position] != CBOR_FALSE && data[position] != CBOR_TRUE))
+			return false;
+
+		value = data[position++] == CBOR_TRUE;
+		return true;
+	}
+
+	bool ksCborReader::readNull()
+	{
+		if (position >= size || (data[position] != CBOR_NULL && data[position] != CBOR_UNDEFINED))
+			return false;
+
+		++position;
+		return true;
+	}
+
+	bool ksCborReader::readFloat(double& value)
+	{
+		if (position >= size)
+			return false;
+
+		auto initialByte{data[position]};
+		if (initialByte != CBOR_FLOAT16 && initialByte != CBOR_FLOAT32 && initialByte != CBOR_FLOAT64)
+		{
+			int64_t intValue;
+			if (!readInt(intValue))
+				return false;
+
+			value = static_cast<double>(intValue);
+			return true;
+		}
+
+		uint8_t majorType;
+		uint64_t bits;
+		std::size_t headLength;
+		if (!peekHead(majorType, bits, headLength))
+		{
+			error = true;
+			return false;
+		}
+
+		if (initialByte == CBOR_FLOAT16)
+		{
+			value = halfToDouble(static_cast<uint16_t>(bits));
+		}
+		else if (initialByte == CBOR_FLOAT32)
+		{
+			float singleValue;
+			auto singleBits{static_cast<uint32_t>(bits)};
+			std::memcpy(&singleValue, &singleBits, sizeof(singleValue));
+			value = singleValue;
+		}
+		else
+		{
+			std::memcpy(&value, &bits, sizeof(value));
+		}
+
+		position += headLength;
+		return true;
+	}
+
+	bool ksCborReader::readText(std::string_view& text)
+	{
+		return readString(CBOR_MAJOR_TEXT, text);
+	}
+
+	bool ksCborReader::readBytes(std::string_view& bytes)
+	{
+		return readString(CBOR_MAJOR_BYTES, bytes);
+	}
+
+	bool ksCborReader::readArray(uint64_t& count)
+	{
+		return readHead(CBOR_MAJOR_ARRAY, count);
+	}
+
+	bool ksCborReader::readMap(uint64_t& count)
+	{
+		return readHead(CBOR_MAJOR_MAP, count);
+	}
+
+	bool ksCborReader::readTag(uint64_t& tag)
+	{
+		return readHead(CBOR_MAJOR_TAG, tag);
+	}
+
+	bool ksCborReader::isBreak() const
+	{
+		return position < size && data[position] == CBOR_BREAK;
+	}
+
+	bool ksCborReader::readBreak()
+	{
+		if (!isBreak())
+			return false;
+
+		++position;
+		return true;
+	}
+
+	bool ksCborReader::skip(uint8_t depth)
+	{
+		if (depth > MAX_SKIP_DEPTH)
+		{
+			error = true;
+			return false;
+		}
+
+		uint64_t count;
+		std::string_view str;
+
+		switch (peekType())
+		{
+			case Type::Bytes:
+				return readBytes(str);
+
+			case Type::Text:
+				return readText(str);
+
+			case Type::Tag:
+				return readTag(count) && skip(depth + 1);
+
+			case Type::Array:
+			case Type::Map:
+			{
+				auto isMap{peekType() == Type::Map};
+				if (!(isMap ? readMap(count) : readArray(count)))
+					return false;
+
+				if (count == INDEFINITE_LENGTH)
+				{
+					while (!isBreak())
+						if (!skip(depth + 1))
+							return false;
+					return readBreak();
+				}
+
+				/* Each map entry consists of two items. Truncated input stops the loop early. */
+				for (uint64_t i{0}; i < count; ++i)
+					if (!skip(depth + 1) || (isMap && !skip(depth + 1)))
+						return false;
+				return true;
+			}
+
+			case Type::Unsigned:
+			case Type::Negative:
+			case Type::Bool:
+			case Type::Null:
+			case Type::Float:
+			{
+				uint8_t majorType;
+				std::size_t headLength;
+				if (!peekHead(majorType, count, headLength))
+					break;
+
+				position += headLength;
+				return true;
+			}
+
+			case Type::End:
+				/* Missing item inside of a container means truncated input. */
+				error = error || depth > 0;
+				return false;
+
+			default:
+				break;
+		}
+
+		error = true;
+		return false;
+	}
+}
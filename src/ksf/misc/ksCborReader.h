@@ -0,0 +1,221 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+namespace ksf::misc
+{
+	/*!
+		@brief Streaming CBOR (RFC 8949) decoder.
+
+		Reads items one after another directly from the caller memory, without any heap allocation and without copying.
+		Strings are returned as views into the input, so they are valid as long as the input is (e.g. in case of an
+		MQTT message - until the message callback returns).
+
+		Each read method checks the type of the next item. On type mismatch it returns false and doesn't move
+		forward, so the caller can try another type. Malformed or truncated input sets the sticky error flag.
+
+		Indefinite-length (chunked) strings are not supported. Indefinite-length arrays and maps are supported,
+		the end of such container is detected with isBreak and consumed with readBreak.
+	*/
+	class ksCborReader
+	{
+		public:
+			/*!
+				@brief Type of the next item.
+			*/
+			enum class Type : uint8_t
+			{
+				Unsigned,		//!< Unsigned integer.
+				Negative,		//!< Negative integer.
+				Bytes,			//!< Byte string.
+				Text,			//!< UTF-8 text string.
+				Array,			//!< Array.
+				Map,			//!< Map.
+				Tag,			//!< Semantic tag.
+				Bool,			//!< Boolean.
+				Null,			//!< Null or undefined.
+				Float,			//!< Half, single or double precision float.
+				Break,			//!< End of indefinite-length container.
+				End,			//!< No more data.
+				Invalid			//!< Malformed data.
+			};
+
+			static constexpr uint64_t INDEFINITE_LENGTH{UINT64_MAX};	//!< Container length reported for indefinite-length containers.
+
+		protected:
+			static constexpr uint8_t MAX_SKIP_DEPTH{16};				//!< Maximum nesting depth handled by skip.
+
+			const uint8_t* data{nullptr};								//!< Input data.
+			std::size_t size{0};										//!< Input size.
+			std::size_t position{0};									//!< Current read position.
+			bool error{false};											//!< True if malformed input has been detected.
+
+			/*!
+				@brief Decodes the head of the next item without moving forward.
+				@param majorType Output major type.
+				@param argument Output argument (value, length or simple value).
+				@param headLength Output length of the head.
+				@return True on success, false if the head is malformed or truncated.
+			*/
+			bool peekHead(uint8_t& majorType, uint64_t& argument, std::size_t& headLength) const;
+
+			/*!
+				@brief Reads the head of the next item if it has the expected major type.
+				@param expectedMajorType Expected major type.
+				@param argument Output argument.
+				@return True on success, false on type mismatch or malformed input.
+			*/
+			bool readHead(uint8_t expectedMajorType, uint64_t& argument);
+
+			/*!
+				@brief Reads the body of a definite-length string.
+				@param majorType Major type of the string (bytes or text).
+				@param out Output view of the string.
+				@return True on success, otherwise false.
+			*/
+			bool readString(uint8_t majorType, std::string_view& out);
+
+			/*!
+				@brief Skips the next item including nested items.
+				@param depth Current nesting depth.
+				@return True on success, otherwise false.
+			*/
+			bool skip(uint8_t depth);
+
+		public:
+			/*!
+				@brief Constructs the decoder.
+				@param data Pointer to the input data.
+				@param size Size of the input data.
+			*/
+			ksCborReader(const uint8_t* data, std::size_t size);
+
+			/*!
+				@brief Constructs the decoder over a payload (e.g. an MQTT message).
+				@param payload Input data.
+			*/
+			explicit ksCborReader(std::string_view payload);
+
+			/*!
+				@brief Retrieves the type of the next item.
+				@return Type of the next item.
+			*/
+			Type peekType() const;
+
+			/*!
+				@brief Reads an unsigned integer.
+				@param value Output value.
+				@return True on success, otherwise false.
+			*/
+			bool readUnsigned(uint64_t& value);
+
+			/*!
+				@brief Reads a signed integer (positive or negative).
+				@param value Output value.
+				@return True on success, false on type mismatch or if the value doesn't fit into int64_t.
+			*/
+			bool readInt(int64_t& value);
+
+			/*!
+				@brief Reads a boolean.
+				@param value Output value.
+				@return True on success, otherwise false.
+			*/
+			bool readBool(bool& value);
+
+			/*!
+				@brief Reads null or undefined.
+				@return True on success, otherwise false.
+			*/
+			bool readNull();
+
+			/*!
+				@brief Reads a floating point number. Integers are accepted and converted.
+				@param value Output value.
+				@return True on success, otherwise false.
+			*/
+			bool readFloat(double& value);
+
+			/*!
+				@brief Reads a text string.
+				@param text Output view of the text, pointing into the input data.
+				@return True on success, otherwise false.
+			*/
+			bool readText(std::string_view& text);
+
+			/*!
+				@brief Reads a byte string.
+				@param bytes Output view of the bytes, pointing into the input data.
+				@return True on success, otherwise false.
+			*/
+			bool readBytes(std::string_view& bytes);
+
+			/*!
+				@brief Reads the head of an array.
+				@param count Output number of items or INDEFINITE_LENGTH.
+				@return True on success, otherwise false.
+			*/
+			bool readArray(uint64_t& count);
+
+			/*!
+				@brief Reads the head of a map.
+				@param count Output number of key-value pairs or INDEFINITE_LENGTH.
+				@return True on success, otherwise false.
+			*/
+			bool readMap(uint64_t& count);
+
+			/*!
+				@brief Reads a semantic tag. The tagged item follows.
+				@param tag Output tag number.
+				@return True on success, otherwise false.
+			*/
+			bool readTag(uint64_t& tag);
+
+			/*!
+				@brief Checks whether the next item is the end of an indefinite-length container.
+				@return True if the next item is a break, otherwise false.
+			*/
+			bool isBreak() const;
+
+			/*!
+				@brief Consumes the end of an indefinite-length container.
+				@return True on success, otherwise false.
+			*/
+			bool readBreak();
+
+			/*!
+				@brief Skips the next item, including all nested items of containers.
+				@return True on success, otherwise false.
+			*/
+			bool skip() { return skip(0); }
+
+			/*!
+				@brief Checks if malformed input has been detected.
+				@return True if an error occurred, otherwise false.
+			*/
+			bool hasError() const { return error; }
+
+			/*!
+				@brief Checks if all the input has been read.
+				@return True if there is no more data, otherwise false.
+			*/
+			bool isAtEnd() const { return position >= size; }
+
+			/*!
+				@brief Retrieves the current read position.
+				@return Number of bytes consumed so far.
+			*/
+			std::size_t getPosition() const { return position; }
+	};
+}
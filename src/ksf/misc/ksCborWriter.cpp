@@ -0,0 +1,171 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#include <cstring>
+
+#include "ksCborWriter.h"
+
+namespace ksf::misc
+{
+	static constexpr uint8_t CBOR_MAJOR_UNSIGNED{0};
+	static constexpr uint8_t CBOR_MAJOR_NEGATIVE{1};
+	static constexpr uint8_t CBOR_MAJOR_BYTES{2};
+	static constexpr uint8_t CBOR_MAJOR_TEXT{3};
+	static constexpr uint8_t CBOR_MAJOR_ARRAY{4};
+	static constexpr uint8_t CBOR_MAJOR_MAP{5};
+
+	static constexpr uint8_t CBOR_FALSE{0xF4};
+	static constexpr uint8_t CBOR_TRUE{0xF5};
+	static constexpr uint8_t CBOR_NULL{0xF6};
+	static constexpr uint8_t CBOR_FLOAT32{0xFA};
+	static constexpr uint8_t CBOR_FLOAT64{0xFB};
+	static constexpr uint8_t CBOR_INDEFINITE_ARRAY{0x9F};
+	static constexpr uint8_t CBOR_INDEFINITE_MAP{0xBF};
+	static constexpr uint8_t CBOR_BREAK{0xFF};
+
+	ksCborWriter::ksCborWriter(uint8_t* buffer, std::size_t capacity)
+		: buffer(buffer), capacity(capacity)
+	{}
+
+	void ksCborWriter::reset()
+	{
+		length = 0;
+		overflow = false;
+	}
+
+	uint8_t* ksCborWriter::reserve(std::size_t size)
+	{
+		if (overflow || size > capacity - length)
+		{
+			overflow = true;
+			return nullptr;
+		}
+
+		auto ptr{buffer + length};
+		length += size;
+		return ptr;
+	}
+
+	void ksCborWriter::writeHead(uint8_t majorType, uint64_t argument)
+	{
+		/* Pick the shortest argument encoding: inline (< 24), 1, 2, 4 or 8 bytes. */
+		int8_t argumentBytes = argument < 24 ? 0 : argument <= UINT8_MAX ? 1 : argument <= UINT16_MAX ? 2 : argument <= UINT32_MAX ? 4 : 8;
+		auto ptr{reserve(1 + argumentBytes)};
+		if (!ptr)
+			return;
+
+		majorType <<= 5;
+		switch (argumentBytes)
+		{
+			case 0: *ptr = majorType | static_cast<uint8_t>(argument); return;
+			case 1: *ptr++ = majorType | 24; break;
+			case 2: *ptr++ = majorType | 25; break;
+			case 4: *ptr++ = majorType | 26; break;
+			default: *ptr++ = majorType | 27; break;
+		}
+
+		/* Argument is stored in network byte order. */
+		for (int8_t shift = (argumentBytes - 1) * 8; shift >= 0; shift -= 8)
+			*ptr++ = static_cast<uint8_t>(argument >> shift);
+	}
+
+	void ksCborWriter::writeUnsigned(uint64_t value)
+	{
+		writeHead(CBOR_MAJOR_UNSIGNED, value);
+	}
+
+	void ksCborWriter::writeInt(int64_t value)
+	{
+		/* Negative integer N is encoded as -1 - N, which equals to bitwise negation. */
+		if (value < 0)
+			writeHead(CBOR_MAJOR_NEGATIVE, ~static_cast<uint64_t>(value));
+		else
+			writeHead(CBOR_MAJOR_UNSIGNED, static_cast<uint64_t>(value));
+	}
+
+	void ksCborWriter::writeBool(bool value)
+	{
+		if (auto ptr{reserve(1)})
+			*ptr = value ? CBOR_TRUE : CBOR_FALSE;
+	}
+
+	void ksCborWriter::writeNull()
+	{
+		if (auto ptr{reserve(1)})
+			*ptr = CBOR_NULL;
+	}
+
+	void ksCborWriter::writeFloat(float value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+
+		if (auto ptr{reserve(5)})
+		{
+			*ptr++ = CBOR_FLOAT32;
+			for (int8_t shift{24}; shift >= 0; shift -= 8)
+				*ptr++ = static_cast<uint8_t>(bits >> shift);
+		}
+	}
+
+	void ksCborWriter::writeDouble(double value)
+	{
+		uint64_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+
+		if (auto ptr{reserve(9)})
+		{
+			*ptr++ = CBOR_FLOAT64;
+			for (int8_t shift{56}; shift >= 0; shift -= 8)
+				*ptr++ = static_cast<uint8_t>(bits >> shift);
+		}
+	}
+
+	void ksCborWriter::writeText(std::string_view text)
+	{
+		writeHead(CBOR_MAJOR_TEXT, text.size());
+		if (auto ptr{reserve(text.size())})
+			std::memcpy(ptr, text.data(), text.size());
+	}
+
+	void ksCborWriter::writeBytes(const uint8_t* data, std::size_t size)
+	{
+		writeHead(CBOR_MAJOR_BYTES, size);
+		if (auto ptr{reserve(size)})
+			std::memcpy(ptr, data, size);
+	}
+
+	void ksCborWriter::beginArray(std::size_t count)
+	{
+		writeHead(CBOR_MAJOR_ARRAY, count);
+	}
+
+	void ksCborWriter::beginMap(std::size_t count)
+	{
+		writeHead(CBOR_MAJOR_MAP, count);
+	}
+
+	void ksCborWriter::beginIndefiniteArray()
+	{
+		if (auto ptr{reserve(1)})
+			*ptr = CBOR_INDEFINITE_ARRAY;
+	}
+
+	void ksCborWriter::beginIndefiniteMap()
+	{
+		if (auto ptr{reserve(1)})
+			*ptr = CBOR_INDEFINITE_MAP;
+	}
+
+	void ksCborWriter::endIndefinite()
+	{
+		if (auto ptr{reserve(1)})
+			*ptr = CBOR_BREAK;
+	}
+}
@@ -0,0 +1,156 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+namespace ksf::misc
+{
+	/*!
+		@brief Streaming CBOR (RFC 8949) encoder.
+
+		Writes items one after another into a buffer provided by the caller, without any heap allocation.
+		Integers always use the shortest possible encoding. Containers can be written either with a known
+		item count or as indefinite-length containers closed with endIndefinite.
+
+		When an item doesn't fit into the remaining space, it is not written and the overflow flag is set.
+		The flag is sticky, so it is enough to check it once after encoding the whole document.
+	*/
+	class ksCborWriter
+	{
+		protected:
+			uint8_t* buffer{nullptr};						//!< Output buffer.
+			std::size_t capacity{0};						//!< Output buffer capacity.
+			std::size_t length{0};							//!< Number of bytes written.
+			bool overflow{false};							//!< True if any item didn't fit into the buffer.
+
+			/*!
+				@brief Reserves space for an item.
+				@param size Number of bytes required.
+				@return Pointer to the reserved space or nullptr if the item doesn't fit.
+			*/
+			uint8_t* reserve(std::size_t size);
+
+			/*!
+				@brief Writes item head (major type and argument) using the shortest encoding.
+				@param majorType CBOR major type (0-7).
+				@param argument Head argument.
+			*/
+			void writeHead(uint8_t majorType, uint64_t argument);
+
+		public:
+			/*!
+				@brief Constructs the encoder.
+				@param buffer Pointer to the output buffer.
+				@param capacity Capacity of the output buffer.
+			*/
+			ksCborWriter(uint8_t* buffer, std::size_t capacity);
+
+			/*!
+				@brief Discards all written data and clears the overflow flag.
+			*/
+			void reset();
+
+			/*!
+				@brief Writes an unsigned integer.
+				@param value Value to be written.
+			*/
+			void writeUnsigned(uint64_t value);
+
+			/*!
+				@brief Writes a signed integer.
+				@param value Value to be written.
+			*/
+			void writeInt(int64_t value);
+
+			/*!
+				@brief Writes a boolean.
+				@param value Value to be written.
+			*/
+			void writeBool(bool value);
+
+			/*!
+				@brief Writes null.
+			*/
+			void writeNull();
+
+			/*!
+				@brief Writes a single precision float.
+				@param value Value to be written.
+			*/
+			void writeFloat(float value);
+
+			/*!
+				@brief Writes a double precision float.
+				@param value Value to be written.
+			*/
+			void writeDouble(double value);
+
+			/*!
+				@brief Writes a UTF-8 text string.
+				@param text Text to be written.
+			*/
+			void writeText(std::string_view text);
+
+			/*!
+				@brief Writes a byte string.
+				@param data Pointer to the data.
+				@param size Size of the data.
+			*/
+			void writeBytes(const uint8_t* data, std::size_t size);
+
+			/*!
+				@brief Starts an array of known size. Must be followed by exactly count items.
+				@param count Number of items.
+			*/
+			void beginArray(std::size_t count);
+
+			/*!
+				@brief Starts a map of known size. Must be followed by exactly count key-value pairs.
+				@param count Number of key-value pairs.
+			*/
+			void beginMap(std::size_t count);
+
+			/*!
+				@brief Starts an indefinite-length array. Must be closed with endIndefinite.
+			*/
+			void beginIndefiniteArray();
+
+			/*!
+				@brief Starts an indefinite-length map. Must be closed with endIndefinite.
+			*/
+			void beginIndefiniteMap();
+
+			/*!
+				@brief Closes the innermost indefinite-length container.
+			*/
+			void endIndefinite();
+
+			/*!
+				@brief Retrieves pointer to the encoded data.
+				@return Pointer to the encoded data.
+			*/
+			const uint8_t* getData() const { return buffer; }
+
+			/*!
+				@brief Retrieves the number of bytes written.
+				@return Length of the encoded data.
+			*/
+			std::size_t getLength() const { return length; }
+
+			/*!
+				@brief Checks if any item didn't fit into the buffer.
+				@return True if the buffer was too small, otherwise false.
+			*/
+			bool hasOverflow() const { return overflow; }
+	};
+}
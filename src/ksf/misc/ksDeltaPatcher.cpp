@@ -0,0 +1,187 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#include <cstring>
+#include <algorithm>
+
+#include "ksDeltaPatcher.h"
+
+namespace ksf::misc
+{
+	static constexpr uint8_t PATCH_MAGIC[]{'K', 'S', 'D', '1'};
+
+	/*!
+		@brief Reads little endian uint32 value.
+		@param data Pointer to the data.
+		@return Decoded value.
+	*/
+	static uint32_t readUint32LE(const uint8_t* data)
+	{
+		return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t>(data[3]) << 24);
+	}
+
+	ksDeltaPatcher::ksDeltaPatcher(ksDeltaSourceReadFunc_t readSource, ksDeltaHeaderFunc_t validateHeader)
+		: readSource(std::move(readSource)), validateHeader(std::move(validateHeader))
+	{}
+
+	bool ksDeltaPatcher::collect(uint8_t size, const uint8_t*& data, const uint8_t* end)
+	{
+		auto length{std::min<std::size_t>(size - fieldLength, end - data)};
+		std::memcpy(fieldBuffer + fieldLength, data, length);
+		fieldLength += length;
+		data += length;
+
+		if (fieldLength < size)
+			return false;
+
+		fieldLength = 0;
+		return true;
+	}
+
+	bool ksDeltaPatcher::parseHeader()
+	{
+		if (std::memcmp(fieldBuffer, PATCH_MAGIC, sizeof(PATCH_MAGIC)) != 0)
+			return false;
+
+		header.sourceSize = readUint32LE(fieldBuffer + 4);
+		header.targetSize = readUint32LE(fieldBuffer + 8);
+		std::memcpy(header.sourceMD5, fieldBuffer + 12, sizeof(header.sourceMD5));
+		std::memcpy(header.targetMD5, fieldBuffer + 28, sizeof(header.targetMD5));
+
+		return !validateHeader || validateHeader(header);
+	}
+
+	bool ksDeltaPatcher::parseControl()
+	{
+		auto diffLength{readUint32LE(fieldBuffer)};
+		extraLength = readUint32LE(fieldBuffer + 4);
+		seek = static_cast<int32_t>(readUint32LE(fieldBuffer + 8));
+
+		/* Records must not produce more than the target size nor read outside of the source. */
+		auto targetLeft{header.targetSize - targetPos};
+		if (diffLength > targetLeft || extraLength > targetLeft - diffLength)
+			return false;
+
+		if (diffLength != 0 && (sourcePos > header.sourceSize || diffLength > header.sourceSize - sourcePos))
+			return false;
+
+		remaining = diffLength;
+		state = EState::Diff;
+		return true;
+	}
+
+	void ksDeltaPatcher::nextState()
+	{
+		if (state == EState::Diff)
+		{
+			remaining = extraLength;
+			state = EState::Extra;
+			return;
+		}
+
+		/* Seek is validated by the next record that reads the source. */
+		sourcePos += seek;
+		state = targetPos == header.targetSize ? EState::Done : EState::Control;
+	}
+
+	bool ksDeltaPatcher::apply(const uint8_t* data, std::size_t length, const ksDecompressedFunc_t& output)
+	{
+		auto end{data + length};
+
+		while (true)
+		{
+			switch (state)
+			{
+				case EState::Header:
+					if (!collect(HEADER_SIZE, data, end))
+						return true;
+
+					state = parseHeader() ? (header.targetSize == 0 ? EState::Done : EState::Control) : EState::Error;
+					continue;
+
+				case EState::Control:
+					if (!collect(CONTROL_SIZE, data, end))
+						return true;
+
+					if (!parseControl())
+						state = EState::Error;
+					continue;
+
+				case EState::Diff:
+				{
+					if (remaining == 0)
+					{
+						nextState();
+						continue;
+					}
+
+					if (data == end)
+						return true;
+
+					/* Diff bytes are added to the source bytes, chunk by chunk. */
+					uint8_t buffer[SOURCE_CHUNK_SIZE];
+					auto chunkLength{std::min<std::size_t>({static_cast<std::size_t>(remaining), static_cast<std::size_t>(end - data), sizeof(buffer)})};
+					if (!readSource(sourcePos, buffer, chunkLength))
+					{
+						state = EState::Error;
+						continue;
+					}
+
+					for (std::size_t i{0}; i < chunkLength; ++i)
+						buffer[i] += data[i];
+
+					if (!output(buffer, chunkLength))
+					{
+						state = EState::Error;
+						continue;
+					}
+
+					data += chunkLength;
+					sourcePos += chunkLength;
+					targetPos += chunkLength;
+					remaining -= chunkLength;
+					continue;
+				}
+
+				case EState::Extra:
+				{
+					if (remaining == 0)
+					{
+						nextState();
+						continue;
+					}
+
+					if (data == end)
+						return true;
+
+					auto chunkLength{std::min<std::size_t>(remaining, end - data)};
+					if (!output(data, chunkLength))
+					{
+						state = EState::Error;
+						continue;
+					}
+
+					data += chunkLength;
+					targetPos += chunkLength;
+					remaining -= chunkLength;
+					continue;
+				}
+
+				case EState::Done:
+					/* Data after the end of the patch means malformed patch. */
+					if (data != end)
+						state = EState::Error;
+					return data == end;
+
+				default:
+					return false;
+			}
+		}
+	}
+}
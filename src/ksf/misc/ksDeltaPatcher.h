@@ -0,0 +1,141 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+#include "ksHeatshrinkDecoder.h"
+
+namespace ksf::misc
+{
+	/*!
+		@brief Callback function typedef for reading the source (currently running) image.
+		@param offset Offset in the source image.
+		@param data Output buffer.
+		@param length Number of bytes to read.
+		@return True on success, otherwise false.
+	*/
+	typedef std::function<bool(uint32_t offset, uint8_t* data, std::size_t length)> ksDeltaSourceReadFunc_t;
+
+	/*!
+		@brief Streaming applier of binary delta patches (bsdiff-like), produced by scripts/ota_delta.py.
+
+		The patch starts with a header: "KSD1", source size, target size (both little endian uint32), source MD5
+		and target MD5 (16 bytes each). The header is followed by records, each consisting of a control block
+		(diff length, extra length, source seek - little endian uint32, uint32 and int32), diff bytes
+		(added to the source bytes) and extra bytes (copied as they are). The source position moves forward
+		with diff bytes and then by the seek value. The patch ends when the whole target has been produced.
+
+		Patch data can be fed in pieces of any size. Source is read in small parts through the callback,
+		so the memory usage is fixed and small.
+	*/
+	class ksDeltaPatcher
+	{
+		public:
+			/*!
+				@brief Patch header.
+			*/
+			struct Header
+			{
+				uint32_t sourceSize;				//!< Size of the source image.
+				uint32_t targetSize;				//!< Size of the target image.
+				uint8_t sourceMD5[16];				//!< MD5 of the source image.
+				uint8_t targetMD5[16];				//!< MD5 of the target image.
+			};
+
+			/*!
+				@brief Callback function typedef for header validation.
+				@param header Parsed patch header.
+				@return True if the patch can be applied, otherwise false.
+			*/
+			typedef std::function<bool(const Header& header)> ksDeltaHeaderFunc_t;
+
+			static constexpr uint8_t HEADER_SIZE{44};			//!< Size of the serialized header.
+			static constexpr uint8_t CONTROL_SIZE{12};			//!< Size of the serialized control block.
+			static constexpr uint16_t SOURCE_CHUNK_SIZE{256};	//!< Size of the source read buffer.
+
+		protected:
+			/*!
+				@brief Patcher state.
+			*/
+			enum class EState : uint8_t
+			{
+				Header,			//!< Reading header.
+				Control,		//!< Reading control block.
+				Diff,			//!< Applying diff bytes.
+				Extra,			//!< Copying extra bytes.
+				Done,			//!< Whole target produced.
+				Error			//!< Malformed patch or I/O error.
+			};
+
+			ksDeltaSourceReadFunc_t readSource;					//!< Source read callback.
+			ksDeltaHeaderFunc_t validateHeader;					//!< Header validation callback.
+			Header header{};									//!< Parsed header.
+			uint8_t fieldBuffer[HEADER_SIZE];					//!< Buffer for header and control blocks split between inputs.
+			uint8_t fieldLength{0};								//!< Number of bytes in fieldBuffer.
+			uint32_t sourcePos{0};								//!< Current source position.
+			uint32_t targetPos{0};								//!< Number of target bytes produced.
+			uint32_t remaining{0};								//!< Bytes remaining in current diff or extra block.
+			uint32_t extraLength{0};							//!< Extra length of current record.
+			int32_t seek{0};									//!< Source seek of current record.
+			EState state{EState::Header};						//!< Current state.
+
+			/*!
+				@brief Collects fixed-size block (header or control) from the input.
+				@param size Size of the block.
+				@param data Input pointer (moved forward).
+				@param end End of the input.
+				@return True when the whole block is collected in fieldBuffer.
+			*/
+			bool collect(uint8_t size, const uint8_t*& data, const uint8_t* end);
+
+			/*!
+				@brief Parses the header from fieldBuffer.
+				@return True on success, otherwise false.
+			*/
+			bool parseHeader();
+
+			/*!
+				@brief Parses the control block from fieldBuffer and moves to the next state.
+				@return True on success, otherwise false.
+			*/
+			bool parseControl();
+
+			/*!
+				@brief Moves to the state after a finished block.
+			*/
+			void nextState();
+
+		public:
+			/*!
+				@brief Constructs the patcher.
+				@param readSource Callback that reads the source image.
+				@param validateHeader Callback that checks whether the patch applies to the source.
+			*/
+			ksDeltaPatcher(ksDeltaSourceReadFunc_t readSource, ksDeltaHeaderFunc_t validateHeader);
+
+			/*!
+				@brief Applies a part of the patch.
+				@param data Pointer to the patch data.
+				@param length Length of the patch data.
+				@param output Callback receiving target image data.
+				@return True on success, false if the patch is malformed or reading/writing failed.
+			*/
+			bool apply(const uint8_t* data, std::size_t length, const ksDecompressedFunc_t& output);
+
+			/*!
+				@brief Checks whether the whole target image has been produced.
+				@return True if complete, otherwise false.
+			*/
+			bool isComplete() const { return state == EState::Done; }
+	};
+}
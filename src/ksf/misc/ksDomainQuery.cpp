@@ -67,6 +67,11 @@ namespace ksf::misc
 		return false;
 	}
 	
+	uint32_t ksDomainQuery::getResolvedTimeMs() const
+	{
+		return resolvedTimeMs;
+	}
+
 	void ksDomainQuery::sendQuery()
 	{
 		/* Begin a packet. */
@@ -173,6 +178,7 @@ namespace ksf::misc
 			{
 				/* Read the IP octects and construct the IP address. */
 				resolvedIP = IPAddress(buffer[pos], buffer[pos + 1], buffer[pos + 2], buffer[pos + 3]);
+				resolvedTimeMs = millis();
 				return;
 			}
 
@@ -196,7 +202,10 @@ namespace ksf::misc
 		{
 			/* If there's a valid IP, return immediately, we're done. */
 			if (resolvedIP.fromString(domain.c_str()))
+			{
+				resolvedTimeMs = millis();
 				return;
+			}
 
 			/* Send the DNS query and update the last query send time. */
 			sendQuery();
@@ -46,6 +46,8 @@ namespace ksf::misc
 			uint16_t transactionID{0};
 			/* Last query send time. */
 			uint32_t lastQuerySendTimeMs{0};
+			/* Time at which the IP address has been resolved. */
+			uint32_t resolvedTimeMs{0};
 
 			/*!
 				@brief Sends DNS query to the DNS server.
@@ -92,6 +94,12 @@ namespace ksf::misc
 			*/
 			bool getResolvedIP(IPAddress& ip) const;
 
+			/*!
+				@brief Retrieves the time at which the IP address has been resolved.
+				@return Value of millis() at the moment of resolution. Meaningful only if getResolvedIP returns true.
+			*/
+			uint32_t getResolvedTimeMs() const;
+
 			/*!
 				@brief Handles resolver tasks, such as sending queries and receiving responses.
 			*/
@@ -0,0 +1,79 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#include "ksFlashContent.h"
+
+namespace ksf::misc
+{
+	/*!
+		@brief Parses a decimal number.
+		@param str String to be parsed (digits only).
+		@param value Output value.
+		@return True on success, otherwise false.
+	*/
+	static bool parseSize(std::string_view str, size_t& value)
+	{
+		if (str.empty() || str.size() > 9)
+			return false;
+
+		value = 0;
+		for (auto ch : str)
+		{
+			if (ch < '0' || ch > '9')
+				return false;
+
+			value = value * 10 + (ch - '0');
+		}
+		return true;
+	}
+
+	ERangeResult parseByteRange(std::string_view header, size_t size, size_t& start, size_t& length)
+	{
+		if (header.substr(0, 6) != PSTR("bytes="))
+			return ERangeResult::None;
+
+		header.remove_prefix(6);
+		auto dashPos{header.find('-')};
+		if (dashPos == std::string_view::npos || header.find(',') != std::string_view::npos)
+			return ERangeResult::None;
+
+		auto first{header.substr(0, dashPos)};
+		auto last{header.substr(dashPos + 1)};
+		size_t firstPos, lastPos;
+
+		/* Suffix range, like "-500" (last 500 bytes). */
+		if (first.empty())
+		{
+			if (!parseSize(last, lastPos))
+				return ERangeResult::None;
+
+			if (lastPos == 0 || size == 0)
+				return ERangeResult::Unsatisfiable;
+
+			length = std::min(lastPos, size);
+			start = size - length;
+			return ERangeResult::Partial;
+		}
+
+		if (!parseSize(first, firstPos))
+			return ERangeResult::None;
+
+		if (last.empty())
+			lastPos = size - 1;
+		else if (!parseSize(last, lastPos) || lastPos < firstPos)
+			return ERangeResult::None;
+
+		if (firstPos >= size)
+			return ERangeResult::Unsatisfiable;
+
+		start = firstPos;
+		length = std::min(lastPos, size - 1) - firstPos + 1;
+		return ERangeResult::Partial;
+	}
+}
@@ -0,0 +1,74 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+
+#include "../ksConstants.h"
+
+namespace ksf::misc
+{
+	/*!
+		@brief Result of HTTP Range header parsing.
+	*/
+	enum class ERangeResult
+	{
+		None,				//!< No range or unsupported range syntax (full content should be sent).
+		Partial,			//!< Valid range (partial content should be sent).
+		Unsatisfiable		//!< Range outside of the content.
+	};
+
+	/*!
+		@brief Parses single byte range of HTTP Range header, like "bytes=0-499", "bytes=500-" or "bytes=-500".
+		@param header Range header value.
+		@param size Size of the content.
+		@param start Output offset of the first byte.
+		@param length Output number of bytes.
+		@return Parsing result. Multiple ranges are not supported, so they result in full content.
+	*/
+	ERangeResult parseByteRange(std::string_view header, size_t size, size_t& start, size_t& length);
+
+	/*!
+		@brief Writes flash-resident content to the client, without staging it in RAM.
+
+		Chunks of KSF_PORTAL_STREAM_CHUNK_SIZE bytes (TCP segment size) let the stack send full segments and allow
+		to stop early when the peer goes away. Writing stops when the client disconnects or accepts no data.
+
+		@param client Client to write to (WiFiClient or compatible).
+		@param data Pointer to the content in flash.
+		@param length Number of bytes to write.
+		@return Number of bytes written.
+	*/
+	template <typename TClient>
+	size_t writeFlashContent(TClient& client, const uint8_t* data, size_t length)
+	{
+		size_t offset{0};
+		while (offset < length && client.connected())
+		{
+			auto chunkSize{std::min<size_t>(KSF_PORTAL_STREAM_CHUNK_SIZE, length - offset)};
+#if defined(ESP8266)
+			auto written{client.write_P(reinterpret_cast<PGM_P>(data + offset), chunkSize)};
+#elif defined(ESP32)
+			auto written{client.write(data + offset, chunkSize)};
+#else
+			#error Platform not implemented.
+#endif
+			if (written == 0)
+				break;
+
+			offset += written;
+			yield();
+		}
+		return offset;
+	}
+}
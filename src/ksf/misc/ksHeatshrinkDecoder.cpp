@@ -0,0 +1,143 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#include <algorithm>
+
+#include "ksHeatshrinkDecoder.h"
+
+namespace ksf::misc
+{
+	static constexpr uint8_t HEADER_MAGIC[]{'K', 'S', 'H'};
+	static constexpr uint8_t MIN_WINDOW_BITS{8};
+	static constexpr uint8_t MIN_LOOKAHEAD_BITS{3};
+
+	bool ksHeatshrinkDecoder::needBits(uint8_t count, const uint8_t*& data, const uint8_t* end)
+	{
+		while (bitCount < count && data < end)
+		{
+			bitBuffer = (bitBuffer << 8) | *data++;
+			bitCount += 8;
+		}
+		return bitCount >= count;
+	}
+
+	uint16_t ksHeatshrinkDecoder::takeBits(uint8_t count)
+	{
+		bitCount -= count;
+		return (bitBuffer >> bitCount) & ((1U << count) - 1);
+	}
+
+	bool ksHeatshrinkDecoder::parseHeaderByte(uint8_t byte)
+	{
+		if (headerPos < sizeof(HEADER_MAGIC))
+			return byte == HEADER_MAGIC[headerPos++];
+
+		windowBits = byte >> 4;
+		lookaheadBits = byte & 0x0F;
+		++headerPos;
+
+		/* Lookahead must be shorter than the window, otherwise a backreference could overwrite itself while flushing. */
+		if (windowBits < MIN_WINDOW_BITS || windowBits > MAX_WINDOW_BITS || lookaheadBits < MIN_LOOKAHEAD_BITS || lookaheadBits >= windowBits)
+			return false;
+
+		window = std::make_unique<uint8_t[]>(1U << windowBits);
+		windowMask = (1U << windowBits) - 1;
+		return true;
+	}
+
+	bool ksHeatshrinkDecoder::flushPending(const ksDecompressedFunc_t& output)
+	{
+		if (pendingLength == 0)
+			return true;
+
+		/* Pending bytes end at the write position, they may wrap around the window end. */
+		auto start{static_cast<uint16_t>((windowPos - pendingLength) & windowMask)};
+		auto firstLength{static_cast<uint16_t>(std::min<uint32_t>(pendingLength, windowMask + 1U - start))};
+		auto secondLength{static_cast<uint16_t>(pendingLength - firstLength)};
+		pendingLength = 0;
+
+		if (!output(window.get() + start, firstLength))
+			return false;
+
+		return secondLength == 0 || output(window.get(), secondLength);
+	}
+
+	bool ksHeatshrinkDecoder::decode(const uint8_t* data, std::size_t length, const ksDecompressedFunc_t& output)
+	{
+		auto end{data + length};
+
+		while (state != EState::Error)
+		{
+			switch (state)
+			{
+				case EState::Header:
+					if (data == end)
+						return true;
+
+					state = parseHeaderByte(*data++) ? (headerPos == HEADER_SIZE ? EState::Tag : EState::Header) : EState::Error;
+					continue;
+
+				case EState::Tag:
+					/* Keep room for the longest backreference, so pending bytes are never overwritten. */
+					if (pendingLength > windowMask - (1U << lookaheadBits) && !flushPending(output))
+						return false;
+
+					if (!needBits(1, data, end))
+						return flushPending(output);
+
+					state = takeBits(1) ? EState::Literal : EState::Index;
+					continue;
+
+				case EState::Literal:
+					if (!needBits(8, data, end))
+						return flushPending(output);
+
+					putByte(static_cast<uint8_t>(takeBits(8)));
+					state = EState::Tag;
+					continue;
+
+				case EState::Index:
+					if (!needBits(windowBits, data, end))
+						return flushPending(output);
+
+					backrefIndex = takeBits(windowBits) + 1;
+					state = backrefIndex > totalOutput ? EState::Error : EState::Count;
+					continue;
+
+				case EState::Count:
+				{
+					if (!needBits(lookaheadBits, data, end))
+						return flushPending(output);
+
+					/* Byte by byte copy, because the source may overlap with the bytes being written. */
+					auto count{takeBits(lookaheadBits) + 1};
+					while (count-- > 0)
+						putByte(window[(windowPos - backrefIndex) & windowMask]);
+
+					state = EState::Tag;
+					continue;
+				}
+
+				default:
+					break;
+			}
+		}
+
+		return false;
+	}
+
+	bool ksHeatshrinkDecoder::isComplete() const
+	{
+		if (state != EState::Tag && state != EState::Index)
+			return false;
+
+		/* The encoder pads the last byte with zero bits, which look like a beginning of a backreference. */
+		return bitCount < 8 && (bitBuffer & ((1U << bitCount) - 1)) == 0 && pendingLength == 0;
+	}
+}
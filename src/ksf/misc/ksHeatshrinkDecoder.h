@@ -0,0 +1,135 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+namespace ksf::misc
+{
+	/*!
+		@brief Callback function typedef for decompressed output.
+		@param data Pointer to the decompressed data. Valid only during the call.
+		@param length Length of the data.
+		@return True on success, false to stop decompression.
+	*/
+	typedef std::function<bool(const uint8_t* data, std::size_t length)> ksDecompressedFunc_t;
+
+	/*!
+		@brief Streaming heatshrink (LZSS) decoder.
+
+		Input can be fed in pieces of any size, the decoder keeps its state between the calls. Decompressed data
+		is passed to the output callback in contiguous parts of the window, so the only memory used is the window
+		itself (2^windowBits bytes), allocated when the stream header is parsed.
+
+		The stream starts with a 4 byte header: "KSH" followed by a byte holding window bits (upper nibble) and
+		lookahead bits (lower nibble). The rest is a standard heatshrink bitstream, like the one produced
+		by scripts/ota_compress.py.
+	*/
+	class ksHeatshrinkDecoder
+	{
+		public:
+			static constexpr uint8_t MAX_WINDOW_BITS{12};		//!< Maximum supported window size (4 KB).
+			static constexpr uint8_t HEADER_SIZE{4};			//!< Size of the stream header.
+
+		protected:
+			/*!
+				@brief Decoder state.
+			*/
+			enum class EState : uint8_t
+			{
+				Header,			//!< Reading stream header.
+				Tag,			//!< Reading literal/backreference tag bit.
+				Literal,		//!< Reading literal byte.
+				Index,			//!< Reading backreference index.
+				Count,			//!< Reading backreference count.
+				Error			//!< Malformed stream.
+			};
+
+			std::unique_ptr<uint8_t[]> window;					//!< Window (last decompressed bytes).
+			uint16_t windowMask{0};								//!< Window size - 1.
+			uint16_t windowPos{0};								//!< Next write position in the window.
+			uint16_t pendingLength{0};							//!< Number of decompressed bytes not yet passed to the output.
+			uint16_t backrefIndex{0};							//!< Index of the backreference being decoded.
+			uint8_t windowBits{0};								//!< Window size bits.
+			uint8_t lookaheadBits{0};							//!< Lookahead (backreference count) bits.
+			uint8_t headerPos{0};								//!< Number of header bytes read.
+			uint8_t bitCount{0};								//!< Number of valid bits in bitBuffer.
+			uint32_t bitBuffer{0};								//!< Input bits not consumed yet.
+			uint32_t totalOutput{0};							//!< Total number of decompressed bytes.
+			EState state{EState::Header};						//!< Current state.
+
+			/*!
+				@brief Ensures that the bit buffer holds the specified number of bits, consuming the input.
+				@param count Number of bits.
+				@param data Input pointer (moved forward).
+				@param end End of the input.
+				@return True if enough bits are available, false if more input is needed.
+			*/
+			bool needBits(uint8_t count, const uint8_t*& data, const uint8_t* end);
+
+			/*!
+				@brief Takes bits from the bit buffer (MSB first).
+				@param count Number of bits.
+				@return Bits value.
+			*/
+			uint16_t takeBits(uint8_t count);
+
+			/*!
+				@brief Parses a header byte.
+				@param byte Header byte.
+				@return True on success, false if the header is invalid.
+			*/
+			bool parseHeaderByte(uint8_t byte);
+
+			/*!
+				@brief Appends a byte to the window.
+				@param byte Decompressed byte.
+			*/
+			void putByte(uint8_t byte)
+			{
+				window[windowPos] = byte;
+				windowPos = (windowPos + 1) & windowMask;
+				++pendingLength;
+				++totalOutput;
+			}
+
+			/*!
+				@brief Passes pending decompressed bytes to the output.
+				@param output Output callback.
+				@return True on success, otherwise false.
+			*/
+			bool flushPending(const ksDecompressedFunc_t& output);
+
+		public:
+			/*!
+				@brief Decompresses a part of the stream.
+				@param data Pointer to the compressed data.
+				@param length Length of the compressed data.
+				@param output Callback receiving decompressed data.
+				@return True on success, false if the stream is malformed or the output callback failed.
+			*/
+			bool decode(const uint8_t* data, std::size_t length, const ksDecompressedFunc_t& output);
+
+			/*!
+				@brief Checks whether the stream ended in a valid state (only the final padding bits left).
+				@return True if the stream is complete, otherwise false.
+			*/
+			bool isComplete() const;
+
+			/*!
+				@brief Retrieves the total number of decompressed bytes.
+				@return Number of bytes.
+			*/
+			uint32_t getTotalOutput() const { return totalOutput; }
+	};
+}
@@ -0,0 +1,196 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#include <Arduino.h>
+#include <cstring>
+#include <algorithm>
+
+#include "ksJsonWriter.h"
+
+namespace ksf::misc
+{
+	ksJsonWriter::ksJsonWriter(std::string& output)
+		: output(&output)
+	{}
+
+	ksJsonWriter::ksJsonWriter(char* buffer, std::size_t capacity, ksJsonFlushFunc_t flushFunc)
+		: chunkBuffer(buffer), chunkCapacity(capacity), flushFunc(std::move(flushFunc))
+	{}
+
+	void ksJsonWriter::flushChunk(bool isFinal)
+	{
+		if (!bitflags.failed && !flushFunc({chunkBuffer, chunkLength}, isFinal))
+			bitflags.failed = true;
+
+		chunkLength = 0;
+	}
+
+	void ksJsonWriter::write(std::string_view data)
+	{
+		bytesWritten += data.size();
+
+		if (output)
+		{
+			output->append(data.data(), data.size());
+			return;
+		}
+
+		/* After a failed flush there is nobody to receive the data, so it's dropped. */
+		while (!bitflags.failed && !data.empty())
+		{
+			auto length{std::min(data.size(), chunkCapacity - chunkLength)};
+			std::memcpy(chunkBuffer + chunkLength, data.data(), length);
+			chunkLength += length;
+			data.remove_prefix(length);
+
+			/* The last chunk is flushed by finish, so the callback knows when the document ends. */
+			if (chunkLength == chunkCapacity && !data.empty())
+				flushChunk(false);
+		}
+	}
+
+	void ksJsonWriter::write(char ch)
+	{
+		write({&ch, 1});
+	}
+
+	void ksJsonWriter::writeEscaped(std::string_view str)
+	{
+		while (!str.empty())
+		{
+			auto safeLength{ksf::json_safe_prefix_length(str)};
+			write(str.substr(0, safeLength));
+			if (safeLength == str.size())
+				break;
+
+			char sequence[6];
+			write({sequence, ksf::json_escape_char(str[safeLength], sequence)});
+			str.remove_prefix(safeLength + 1);
+		}
+	}
+
+	void ksJsonWriter::writeEscaped_P(PGM_P str)
+	{
+		/* Flash can't be read byte by byte on ESP8266, so the string is copied to the stack in parts. */
+		char part[32];
+		for (auto remaining{strlen_P(str)}; remaining > 0;)
+		{
+			auto length{std::min(remaining, sizeof(part))};
+			memcpy_P(part, str, length);
+			writeEscaped({part, length});
+			str += length;
+			remaining -= length;
+		}
+	}
+
+	void ksJsonWriter::beforeItem()
+	{
+		if (bitflags.afterKey)
+		{
+			bitflags.afterKey = false;
+			return;
+		}
+
+		auto levelBit{1UL << std::min(depth, MAX_DEPTH)};
+		if (hasItemsMask & levelBit)
+			write(',');
+
+		hasItemsMask |= levelBit;
+	}
+
+	void ksJsonWriter::beginContainer(char ch)
+	{
+		beforeItem();
+		write(ch);
+
+		if (depth < MAX_DEPTH)
+			++depth;
+
+		hasItemsMask &= ~(1UL << depth);
+	}
+
+	void ksJsonWriter::endContainer(char ch)
+	{
+		if (depth > 0)
+			--depth;
+
+		write(ch);
+	}
+
+	void ksJsonWriter::key(std::string_view name)
+	{
+		beforeItem();
+		write('"');
+		writeEscaped(name);
+		write({"\":", 2});
+		bitflags.afterKey = true;
+	}
+
+	void ksJsonWriter::key_P(PGM_P name)
+	{
+		beforeItem();
+		write('"');
+		writeEscaped_P(name);
+		write({"\":", 2});
+		bitflags.afterKey = true;
+	}
+
+	void ksJsonWriter::value(std::string_view str)
+	{
+		beginString();
+		writeEscaped(str);
+		endString();
+	}
+
+	void ksJsonWriter::value_P(PGM_P str)
+	{
+		beginString();
+		writeEscaped_P(str);
+		endString();
+	}
+
+	void ksJsonWriter::value(bool val)
+	{
+		beforeItem();
+		write(val ? std::string_view{"true", 4} : std::string_view{"false", 5});
+	}
+
+	void ksJsonWriter::value(double val, int decimals)
+	{
+		beforeItem();
+		char buffer[KSF_TO_CHARS_BUFFER_SIZE];
+		write({buffer, static_cast<std::size_t>(ksf::to_chars(buffer, val, decimals) - buffer)});
+	}
+
+	void ksJsonWriter::valueNull()
+	{
+		beforeItem();
+		write({"null", 4});
+	}
+
+	void ksJsonWriter::valueRaw(std::string_view json)
+	{
+		beforeItem();
+		write(json);
+	}
+
+	void ksJsonWriter::beginString()
+	{
+		beforeItem();
+		write('"');
+	}
+
+	bool ksJsonWriter::finish()
+	{
+		if (!output)
+			flushChunk(true);
+
+		return !bitflags.failed;
+	}
+}
@@ -0,0 +1,311 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <string_view>
+#include <type_traits>
+
+#include "../ksConstants.h"
+
+namespace ksf::misc
+{
+	/*!
+		@brief Callback function typedef for JSON chunk output.
+		@param chunk Part of the document. Valid only during the call.
+		@param isFinal True if this is the last part of the document.
+		@return True on success, false to stop writing (the rest of the document is dropped).
+	*/
+	typedef std::function<bool(std::string_view chunk, bool isFinal)> ksJsonFlushFunc_t;
+
+	/*!
+		@brief Streaming JSON writer.
+
+		Takes care of commas between object members and array items, string escaping and number formatting.
+		The output goes either to a string (appended, so the caller can prepend a header and reserve memory)
+		or to a fixed buffer provided by the caller, that is passed to the flush callback whenever it's full.
+		In the latter case memory usage doesn't depend on the size of the document.
+
+		String values can be also built from parts with beginString, addString and endString, which avoids
+		temporary strings when the value is composed of text and numbers.
+
+		Strings in flash (PSTR, PROGMEM) must be passed to the methods with _P suffix. Escaping reads the input
+		byte by byte, which raises an exception on ESP8266 when done directly on flash.
+	*/
+	class ksJsonWriter
+	{
+		protected:
+			static constexpr uint8_t MAX_DEPTH{31};			//!< Maximum supported nesting depth.
+
+			std::string* output{nullptr};					//!< Output string (string mode).
+			char* chunkBuffer{nullptr};						//!< Chunk buffer (chunk mode).
+			std::size_t chunkCapacity{0};					//!< Capacity of the chunk buffer.
+			std::size_t chunkLength{0};						//!< Number of bytes waiting in the chunk buffer.
+			ksJsonFlushFunc_t flushFunc;					//!< Callback receiving full chunks.
+			std::size_t bytesWritten{0};					//!< Total number of bytes produced.
+			uint32_t hasItemsMask{0};						//!< Bit per nesting level, set if the container has items.
+			uint8_t depth{0};								//!< Current nesting depth.
+
+			struct
+			{
+				bool afterKey : 1;							//!< True if a key has been written and a value is expected.
+				bool failed : 1;							//!< True if the flush callback reported an error.
+			} bitflags = {false, false};
+
+			/*!
+				@brief Writes raw bytes to the output.
+				@param data Bytes to be written.
+			*/
+			void write(std::string_view data);
+
+			/*!
+				@brief Writes a single raw character to the output.
+				@param ch Character to be written.
+			*/
+			void write(char ch);
+
+			/*!
+				@brief Writes an escaped string (without quotes).
+				@param str String to be escaped.
+			*/
+			void writeEscaped(std::string_view str);
+
+			/*!
+				@brief Writes an escaped null-terminated string (without quotes), copying it to the stack in small parts.
+				@param str String to be escaped. It can point to flash (PROGMEM) or RAM.
+			*/
+			void writeEscaped_P(PGM_P str);
+
+			/*!
+				@brief Writes a comma if needed before the next item.
+			*/
+			void beforeItem();
+
+			/*!
+				@brief Opens a container.
+				@param ch Opening character.
+			*/
+			void beginContainer(char ch);
+
+			/*!
+				@brief Closes a container.
+				@param ch Closing character.
+			*/
+			void endContainer(char ch);
+
+			/*!
+				@brief Passes the chunk buffer content to the flush callback.
+				@param isFinal True if this is the last part of the document.
+			*/
+			void flushChunk(bool isFinal);
+
+		public:
+			/*!
+				@brief Constructs the writer that appends to a string.
+				@param output Output string. Must outlive the writer.
+			*/
+			explicit ksJsonWriter(std::string& output);
+
+			/*!
+				@brief Constructs the writer that outputs the document in chunks.
+				@param buffer Chunk buffer. Must outlive the writer.
+				@param capacity Capacity of the chunk buffer.
+				@param flushFunc Callback that receives the chunks.
+			*/
+			ksJsonWriter(char* buffer, std::size_t capacity, ksJsonFlushFunc_t flushFunc);
+
+			/*!
+				@brief Starts an object. Must be closed with endObject.
+			*/
+			void beginObject() { beginContainer('{'); }
+
+			/*!
+				@brief Closes the innermost object.
+			*/
+			void endObject() { endContainer('}'); }
+
+			/*!
+				@brief Starts an array. Must be closed with endArray.
+			*/
+			void beginArray() { beginContainer('['); }
+
+			/*!
+				@brief Closes the innermost array.
+			*/
+			void endArray() { endContainer(']'); }
+
+			/*!
+				@brief Writes an object member key. Must be followed by a value, object or array.
+				@param name Name of the member.
+			*/
+			void key(std::string_view name);
+
+			/*!
+				@brief Writes an object member key. Must be followed by a value, object or array.
+				@param name Name of the member. It can point to flash (PROGMEM) or RAM.
+			*/
+			void key_P(PGM_P name);
+
+			/*!
+				@brief Writes a string value.
+				@param str Value (escaped by the writer).
+			*/
+			void value(std::string_view str);
+
+			/*!
+				@brief Writes a string value.
+				@param str Value (escaped by the writer).
+			*/
+			void value(const char* str) { value(std::string_view(str)); }
+
+			/*!
+				@brief Writes a string value.
+				@param str Value (escaped by the writer).
+			*/
+			void value(const std::string& str) { value(std::string_view(str)); }
+
+			/*!
+				@brief Writes a string value.
+				@param str Value (escaped by the writer). It can point to flash (PROGMEM) or RAM.
+			*/
+			void value_P(PGM_P str);
+
+			/*!
+				@brief Writes a boolean value.
+				@param val Value to be written.
+			*/
+			void value(bool val);
+
+			/*!
+				@brief Writes an integer value.
+				@param val Value to be written.
+			*/
+			template <typename _Type>
+			std::enable_if_t<std::is_integral_v<_Type> && !std::is_same_v<_Type, bool>> value(_Type val)
+			{
+				beforeItem();
+				char buffer[KSF_TO_CHARS_BUFFER_SIZE];
+				write({buffer, static_cast<std::size_t>(ksf::to_chars(buffer, val) - buffer)});
+			}
+
+			/*!
+				@brief Writes a floating point value.
+				@param val Value to be written.
+				@param decimals Number of decimal places.
+			*/
+			void value(double val, int decimals = 2);
+
+			/*!
+				@brief Writes a null value.
+			*/
+			void valueNull();
+
+			/*!
+				@brief Writes an already encoded JSON value as is.
+				@param json Encoded value.
+			*/
+			void valueRaw(std::string_view json);
+
+			/*!
+				@brief Writes bytes as they are, without separators (e.g. a protocol header in front of the document).
+				@param data Bytes to be written.
+			*/
+			void raw(std::string_view data) { write(data); }
+
+			/*!
+				@brief Writes object member (key and value).
+				@param name Name of the member.
+				@param val Value of the member.
+			*/
+			template <typename _Type>
+			void member(std::string_view name, const _Type& val)
+			{
+				key(name);
+				value(val);
+			}
+
+			/*!
+				@brief Writes object member (key and value).
+				@param name Name of the member. It can point to flash (PROGMEM) or RAM.
+				@param val Value of the member.
+			*/
+			template <typename _Type>
+			void member_P(PGM_P name, const _Type& val)
+			{
+				key_P(name);
+				value(val);
+			}
+
+			/*!
+				@brief Writes object member with a string value.
+				@param name Name of the member. It can point to flash (PROGMEM) or RAM.
+				@param val Value of the member. It can point to flash (PROGMEM) or RAM.
+			*/
+			void member_P(PGM_P name, PGM_P val)
+			{
+				key_P(name);
+				value_P(val);
+			}
+
+			/*!
+				@brief Starts a string value built from parts. Must be closed with endString.
+			*/
+			void beginString();
+
+			/*!
+				@brief Adds text to the string value started with beginString.
+				@param str Text (escaped by the writer).
+			*/
+			void addString(std::string_view str) { writeEscaped(str); }
+
+			/*!
+				@brief Adds text to the string value started with beginString.
+				@param str Text (escaped by the writer). It can point to flash (PROGMEM) or RAM.
+			*/
+			void addString_P(PGM_P str) { writeEscaped_P(str); }
+
+			/*!
+				@brief Adds a formatted integer to the string value started with beginString.
+				@param val Value to be added.
+			*/
+			template <typename _Type>
+			std::enable_if_t<std::is_integral_v<_Type>> addString(_Type val)
+			{
+				char buffer[KSF_TO_CHARS_BUFFER_SIZE];
+				write({buffer, static_cast<std::size_t>(ksf::to_chars(buffer, val) - buffer)});
+			}
+
+			/*!
+				@brief Closes the string value started with beginString.
+			*/
+			void endString() { write('"'); }
+
+			/*!
+				@brief Finishes the document. In chunk mode passes the rest of the buffer as the final chunk.
+				@return True on success, false if the flush callback reported an error.
+			*/
+			bool finish();
+
+			/*!
+				@brief Checks if the flush callback reported an error.
+				@return True if writing has failed, otherwise false.
+			*/
+			bool hasFailed() const { return bitflags.failed; }
+
+			/*!
+				@brief Retrieves the total number of bytes produced so far.
+				@return Number of bytes.
+			*/
+			std::size_t getBytesWritten() const { return bytesWritten; }
+	};
+}
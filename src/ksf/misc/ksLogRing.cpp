@@ -0,0 +1,151 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#include <Arduino.h>
+#include <cstring>
+#include <algorithm>
+
+#include "ksLogRing.h"
+
+namespace ksf::misc
+{
+	ksLogRing::ksLogRing(std::size_t capacity)
+		: ownedStorage(std::make_unique<uint8_t[]>(getStorageSize(capacity)))
+	{
+		attach(ownedStorage.get(), getStorageSize(capacity), false);
+	}
+
+	ksLogRing::ksLogRing(uint8_t* storage, std::size_t storageSize, bool restore)
+	{
+		attach(storage, storageSize, restore);
+	}
+
+	void ksLogRing::attach(uint8_t* storage, std::size_t storageSize, bool restore)
+	{
+		state = reinterpret_cast<State*>(storage);
+		buffer = storage + sizeof(State);
+		capacity = storageSize - sizeof(State);
+
+		if (!restore || !isStateValid())
+			*state = {STATE_MAGIC, capacity, 0, {}, {}};
+	}
+
+	bool ksLogRing::isStateValid() const
+	{
+		if (state->magic != STATE_MAGIC || state->capacity != capacity || state->usedBytes > capacity)
+			return false;
+
+		if (state->first.offset >= capacity || state->next.offset >= capacity || getLineCount() > capacity / LINE_HEADER_SIZE)
+			return false;
+
+		/* Memory that survived a reset might be damaged, the lines have to end exactly where the state says. */
+		auto offset{state->first.offset};
+		uint32_t walkedBytes{0};
+		for (uint32_t line{0}; line < getLineCount(); ++line)
+		{
+			auto size{static_cast<uint32_t>(LINE_HEADER_SIZE + lineLength(offset))};
+			walkedBytes += size;
+			if (walkedBytes > state->usedBytes)
+				return false;
+
+			offset = (offset + size) % capacity;
+		}
+
+		return walkedBytes == state->usedBytes && offset == state->next.offset;
+	}
+
+	void ksLogRing::copyIn(uint32_t offset, const uint8_t* data, std::size_t length)
+	{
+		auto firstLength{std::min<std::size_t>(length, capacity - offset)};
+		std::memcpy(buffer + offset, data, firstLength);
+		std::memcpy(buffer, data + firstLength, length - firstLength);
+	}
+
+	void ksLogRing::copyOut(uint32_t offset, uint8_t* data, std::size_t length) const
+	{
+		auto firstLength{std::min<std::size_t>(length, capacity - offset)};
+		std::memcpy(data, buffer + offset, firstLength);
+		std::memcpy(data + firstLength, buffer, length - firstLength);
+	}
+
+	uint16_t ksLogRing::lineLength(uint32_t offset) const
+	{
+		uint8_t header[LINE_HEADER_SIZE];
+		copyOut(offset, header, sizeof(header));
+		return header[0] | (header[1] << 8);
+	}
+
+	void ksLogRing::dropOldest()
+	{
+		auto& first{state->first};
+		auto size{static_cast<uint32_t>(LINE_HEADER_SIZE + lineLength(first.offset))};
+		first.offset = (first.offset + size) % capacity;
+		++first.sequence;
+		state->usedBytes -= size;
+	}
+
+	void ksLogRing::write(std::string_view line)
+	{
+		if (capacity <= LINE_HEADER_SIZE)
+			return;
+
+		auto length{static_cast<uint16_t>(std::min<std::size_t>({line.size(), capacity - LINE_HEADER_SIZE, UINT16_MAX}))};
+		auto size{static_cast<uint32_t>(LINE_HEADER_SIZE + length)};
+
+		while (capacity - state->usedBytes < size)
+			dropOldest();
+
+		/* The line is copied before the state is updated, so a reset while writing never exposes a partially written line. */
+		auto& next{state->next};
+		uint8_t header[LINE_HEADER_SIZE]{static_cast<uint8_t>(length), static_cast<uint8_t>(length >> 8)};
+		copyIn(next.offset, header, sizeof(header));
+		copyIn((next.offset + LINE_HEADER_SIZE) % capacity, reinterpret_cast<const uint8_t*>(line.data()), length);
+
+		next.offset = (next.offset + size) % capacity;
+		++next.sequence;
+		state->usedBytes += size;
+	}
+
+	bool ksLogRing::read(Cursor& cursor, std::string& out) const
+	{
+		/* Sequence numbers are compared relative to the oldest line, so the wrap-around doesn't matter. */
+		auto distance{cursor.sequence - state->first.sequence};
+		if (distance > getLineCount())
+			cursor = static_cast<int32_t>(distance) < 0 ? state->first : state->next;
+
+		if (cursor.sequence == state->next.sequence)
+			return false;
+
+		auto length{lineLength(cursor.offset)};
+		auto outLength{out.size()};
+		out.resize(outLength + length);
+		copyOut((cursor.offset + LINE_HEADER_SIZE) % capacity, reinterpret_cast<uint8_t*>(out.data()) + outLength, length);
+
+		cursor.offset = (cursor.offset + LINE_HEADER_SIZE + length) % capacity;
+		++cursor.sequence;
+		return true;
+	}
+
+	void ksLogRing::appendAsText(std::string_view line, std::string& out)
+	{
+		if (line.empty() || line.front() != '\0')
+		{
+			out += line;
+			return;
+		}
+
+		static constexpr char HEX_DIGITS[] PROGMEM {"0123456789abcdef"};
+		out += '#';
+		for (auto byte : line)
+		{
+			out += pgm_read_byte(&HEX_DIGITS[static_cast<uint8_t>(byte) >> 4]);
+			out += pgm_read_byte(&HEX_DIGITS[static_cast<uint8_t>(byte) & 0x0F]);
+		}
+	}
+}
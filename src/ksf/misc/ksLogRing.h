@@ -0,0 +1,172 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+namespace ksf::misc
+{
+	/*!
+		@brief Fixed-size ring of log lines.
+
+		Lines are stored one after another (2 byte length followed by the text) in a single buffer allocated
+		at construction, so writing a line is just a copy. When there's no room for a new line, the oldest
+		lines are dropped.
+
+		Every line gets a sequence number. Consumers (portal terminal, serial output, MQTT) keep their own cursor
+		and read at their own pace. A cursor that points to an already dropped line is moved to the oldest one,
+		so a slow consumer loses lines instead of blocking the writer. A new consumer can start from the oldest
+		line to get recent history.
+
+		The ring can also work on external storage (state followed by the buffer), e.g. in memory that is not
+		cleared on reset. Such ring can be restored - its lines are kept if the state is consistent.
+	*/
+	class ksLogRing
+	{
+		public:
+			/*!
+				@brief Position of a line in the ring.
+			*/
+			struct Cursor
+			{
+				uint32_t sequence{0};							//!< Sequence number of the line.
+				uint32_t offset{0};								//!< Offset of the line in the buffer.
+			};
+
+			/*!
+				@brief State of the ring, stored in front of the buffer.
+			*/
+			struct State
+			{
+				uint32_t magic{0};								//!< STATE_MAGIC if the state has been initialized.
+				uint32_t capacity{0};							//!< Size of the buffer.
+				uint32_t usedBytes{0};							//!< Number of bytes occupied by lines.
+				Cursor first;									//!< Oldest line.
+				Cursor next;									//!< Position of the next line to be written.
+			};
+
+			static constexpr uint8_t LINE_HEADER_SIZE{2};		//!< Size of the line header (length).
+			static constexpr uint32_t STATE_MAGIC{0x4B534C52};	//!< Magic value of initialized state.
+
+		protected:
+			std::unique_ptr<uint8_t[]> ownedStorage;			//!< Storage allocated by the ring (empty for external storage).
+			State* state{nullptr};								//!< Ring state (at the beginning of the storage).
+			uint8_t* buffer{nullptr};							//!< Line buffer (right after the state).
+			uint32_t capacity{0};								//!< Size of the buffer.
+
+			/*!
+				@brief Sets up the ring on the storage.
+				@param storage Pointer to the storage (aligned for State).
+				@param storageSize Size of the storage.
+				@param restore True to keep the lines if the state is valid, false to clear the ring.
+			*/
+			void attach(uint8_t* storage, std::size_t storageSize, bool restore);
+
+			/*!
+				@brief Checks if the state is consistent with the buffer (walks through all the lines).
+				@return True if the lines can be read, otherwise false.
+			*/
+			bool isStateValid() const;
+
+			/*!
+				@brief Copies data into the buffer, wrapping at the end.
+				@param offset Offset in the buffer.
+				@param data Pointer to the data.
+				@param length Length of the data.
+			*/
+			void copyIn(uint32_t offset, const uint8_t* data, std::size_t length);
+
+			/*!
+				@brief Copies data from the buffer, wrapping at the end.
+				@param offset Offset in the buffer.
+				@param data Output pointer.
+				@param length Length of the data.
+			*/
+			void copyOut(uint32_t offset, uint8_t* data, std::size_t length) const;
+
+			/*!
+				@brief Reads the length of the line at the offset.
+				@param offset Offset of the line.
+				@return Length of the line text.
+			*/
+			uint16_t lineLength(uint32_t offset) const;
+
+			/*!
+				@brief Drops the oldest line.
+			*/
+			void dropOldest();
+
+		public:
+			/*!
+				@brief Constructs the ring.
+				@param capacity Size of the buffer in bytes.
+			*/
+			explicit ksLogRing(std::size_t capacity);
+
+			/*!
+				@brief Constructs the ring on external storage, which must outlive the ring.
+				@param storage Pointer to the storage (aligned for State).
+				@param storageSize Size of the storage in bytes (see getStorageSize).
+				@param restore True to keep the lines if the state is valid (e.g. after reset), false to clear the ring.
+			*/
+			ksLogRing(uint8_t* storage, std::size_t storageSize, bool restore);
+
+			/*!
+				@brief Calculates the size of storage needed for the buffer of given size.
+				@param capacity Size of the buffer in bytes.
+				@return Size of the storage in bytes.
+			*/
+			static constexpr std::size_t getStorageSize(std::size_t capacity) { return sizeof(State) + capacity; }
+
+			/*!
+				@brief Writes a line, dropping the oldest lines if needed. Lines longer than the ring are truncated.
+				@param line Line to be written.
+			*/
+			void write(std::string_view line);
+
+			/*!
+				@brief Reads a line and moves the cursor to the next one.
+				@param cursor Cursor of the consumer. Moved to the oldest line if it points to an already dropped line.
+				@param out String the line is appended to.
+				@return True if a line has been read, false if there are no more lines.
+			*/
+			bool read(Cursor& cursor, std::string& out) const;
+
+			/*!
+				@brief Appends a line read from the ring as text. Binary records (KSF_LOG_BINARY) are written in hex, prefixed
+				with '#', which is the format scripts/log_decoder.py --dump decodes.
+				@param line Line read from the ring.
+				@param out String the text is appended to.
+			*/
+			static void appendAsText(std::string_view line, std::string& out);
+
+			/*!
+				@brief Retrieves cursor of the oldest line.
+				@return Cursor of the oldest line.
+			*/
+			Cursor begin() const { return state->first; }
+
+			/*!
+				@brief Retrieves cursor past the newest line. Consumer starting from here reads only new lines.
+				@return Cursor past the newest line.
+			*/
+			Cursor end() const { return state->next; }
+
+			/*!
+				@brief Retrieves the number of lines in the ring.
+				@return Number of lines.
+			*/
+			uint32_t getLineCount() const { return state->next.sequence - state->first.sequence; }
+	};
+}
@@ -0,0 +1,135 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#include <Arduino.h>
+#include <Ticker.h>
+#include <cstring>
+#include <algorithm>
+#if defined(ESP32)
+	#include <esp_attr.h>
+#endif
+
+#include "../ksLog.h"
+
+#include "ksLoopWatchdog.h"
+
+namespace ksf::misc
+{
+	static_assert(sizeof(ksLoopWatchdog::Stall) % sizeof(uint32_t) == 0, "Stall record must be made of 32-bit words.");
+
+#if defined(ESP32)
+	static constexpr bool HAS_PERSISTENT_STALL{true};
+
+	/* Raw words, an object with constructor would be initialized on boot. */
+	static __NOINIT_ATTR uint32_t persistentStall[sizeof(ksLoopWatchdog::Stall) / sizeof(uint32_t)];
+#elif defined(ESP8266)
+	/* RTC user memory is shared with the application, so the record is kept there only if the words are reserved for it. */
+	static constexpr bool HAS_PERSISTENT_STALL{KSF_LOOP_WATCHDOG_RTC_OFFSET >= 0};
+	static_assert(KSF_LOOP_WATCHDOG_RTC_OFFSET + sizeof(ksLoopWatchdog::Stall) / sizeof(uint32_t) <= 128, "Stall record must fit into RTC user memory (128 words).");
+#else
+	#error Platform not implemented.
+#endif
+
+	static Ticker stallTicker;
+
+	/*!
+		@brief Writes the stall record into memory that survives software reset.
+		@param stall Stall record.
+	*/
+	static void writePersistentStall(const ksLoopWatchdog::Stall& stall)
+	{
+#if defined(ESP32)
+		std::memcpy(persistentStall, &stall, sizeof(stall));
+#elif defined(ESP8266)
+		if constexpr (HAS_PERSISTENT_STALL)
+			ESP.rtcUserMemoryWrite(KSF_LOOP_WATCHDOG_RTC_OFFSET, reinterpret_cast<uint32_t*>(const_cast<ksLoopWatchdog::Stall*>(&stall)), sizeof(stall));
+#endif
+	}
+
+	/*!
+		@brief Reads the stall record from memory that survives software reset.
+		@param stall Output stall record.
+	*/
+	static void readPersistentStall(ksLoopWatchdog::Stall& stall)
+	{
+#if defined(ESP32)
+		std::memcpy(&stall, persistentStall, sizeof(stall));
+#elif defined(ESP8266)
+		if constexpr (HAS_PERSISTENT_STALL)
+			ESP.rtcUserMemoryRead(KSF_LOOP_WATCHDOG_RTC_OFFSET, reinterpret_cast<uint32_t*>(&stall), sizeof(stall));
+#endif
+	}
+
+	void ksLoopWatchdog::begin()
+	{
+		if constexpr (KSF_LOOP_WATCHDOG_BUDGET_MS == 0)
+			return;
+
+		/* Without persistent memory stalls are only logged when the call returns, the record and the timer are of no use. */
+		if constexpr (!HAS_PERSISTENT_STALL)
+			return;
+
+		/* Record is taken over by this boot. After power on the memory holds random data, so it has to be validated. */
+		readPersistentStall(previousStall);
+		auto& name{previousStall.componentName};
+		if (previousStall.magic != STALL_MAGIC || std::memchr(name, '\0', sizeof(name)) == nullptr)
+			previousStall = Stall{};
+
+		writePersistentStall(Stall{});
+
+		if (auto stall{getPreviousStall()})
+		{
+			if (stall->hasReturned)
+				KSF_LOG_WARN("[ LoopWatchdog ] Last stall before reset: %s loop took %u ms.", stall->componentName, static_cast<unsigned>(stall->durationMs));
+			else
+				KSF_LOG_WARN("[ LoopWatchdog ] Reset while %s loop was running for at least %u ms.", stall->componentName, static_cast<unsigned>(stall->durationMs));
+		}
+
+		stallTicker.attach_ms(KSF_LOOP_WATCHDOG_BUDGET_MS, &ksLoopWatchdog::onTimer);
+	}
+
+	ksLoopWatchdog::Stall ksLoopWatchdog::saveStall(const char* componentName, uint32_t durationMs, bool hasReturned)
+	{
+		Stall stall{STALL_MAGIC, durationMs, hasReturned, {}};
+		strncpy_P(stall.componentName, componentName, sizeof(stall.componentName) - 1);
+		writePersistentStall(stall);
+		return stall;
+	}
+
+	void ksLoopWatchdog::onTimer()
+	{
+		/* Runs concurrently with the loop (ESP32), so it only saves the record, logging is left to the loop. */
+		auto componentName{currentComponent};
+		if (!componentName)
+			return;
+
+		auto durationMs{millis() - entryTime};
+		if (durationMs > KSF_LOOP_WATCHDOG_BUDGET_MS && componentName == currentComponent)
+			saveStall(componentName, durationMs, false);
+	}
+
+	bool ksLoopWatchdog::onStall(const char* componentName, uint32_t durationMs)
+	{
+		++stallCount;
+		maxStallMs = std::max(maxStallMs, durationMs);
+
+		/* Name is copied out of flash with the record, so it can be printed on any platform. */
+		auto stall{saveStall(componentName, durationMs, true)};
+		KSF_LOG_WARN("[ LoopWatchdog ] %s loop took %u ms (budget %u ms).", stall.componentName, static_cast<unsigned>(durationMs),
+			static_cast<unsigned>(KSF_LOOP_WATCHDOG_BUDGET_MS));
+
+		if constexpr (KSF_LOOP_WATCHDOG_BREAK_APP != 0)
+		{
+			KSF_LOG_ERROR("[ LoopWatchdog ] Stopping the application.");
+			return false;
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,133 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <cstdint>
+
+#include "../ksConstants.h"
+
+namespace ksf::misc
+{
+	/*!
+		@brief Software watchdog of component loops.
+
+		ksApplication marks each component loop call with enter and leave, which only store the component name and the time.
+		A call longer than KSF_LOOP_WATCHDOG_BUDGET_MS is a stall. It's logged, counted and saved as the last culprit in memory
+		that survives software reset, so it can be read after reboot. ESP32 uses no-init RAM. ESP8266 uses RTC user memory only
+		if the application reserves words for it with KSF_LOOP_WATCHDOG_RTC_OFFSET, otherwise stalls are only logged.
+
+		Calls that never return are caught by a timer, which keeps saving the culprit while the call is still running. This way,
+		after a hardware watchdog reset it's known which component blocked the loop. On ESP32 the timer runs in a separate task.
+		On ESP8266 it runs only when the blocking code yields (delay, most network calls), so code that doesn't yield at all
+		is attributed only if it returns.
+	*/
+	class ksLoopWatchdog
+	{
+		public:
+			static constexpr uint8_t COMPONENT_NAME_LENGTH{32};		//!< Maximum length of saved component name (including the terminator).
+			static constexpr uint32_t STALL_MAGIC{0x4B53574C};		//!< Magic value of valid stall record.
+
+			/*!
+				@brief Stall record saved for the next boot. Plain words, so it can live in memory that is not initialized on boot.
+			*/
+			struct Stall
+			{
+				uint32_t magic;										//!< STALL_MAGIC if the record is valid.
+				uint32_t durationMs;								//!< Duration of the call (so far, if it hasn't returned).
+				uint32_t hasReturned;								//!< Zero if the call was still running when last saved (e.g. reset in the middle).
+				char componentName[COMPONENT_NAME_LENGTH];			//!< Class name of the component.
+			};
+
+		protected:
+			static inline const char* volatile currentComponent{nullptr};	//!< Name of the component being executed (nullptr between calls).
+			static inline volatile uint32_t entryTime{0};					//!< Time of entering the current call (milliseconds).
+			static inline uint32_t stallCount{0};							//!< Number of stalls since boot.
+			static inline uint32_t maxStallMs{0};							//!< Duration of the longest stall since boot.
+			static inline Stall previousStall{};							//!< Last stall of the previous boot.
+
+			/*!
+				@brief Saves the stall record in memory that survives software reset.
+				@param componentName Class name of the component (in flash).
+				@param durationMs Duration of the call.
+				@param hasReturned True if the call has returned.
+				@return Saved record.
+			*/
+			static Stall saveStall(const char* componentName, uint32_t durationMs, bool hasReturned);
+
+			/*!
+				@brief Timer callback. Saves the current call if it's over the budget.
+			*/
+			static void onTimer();
+
+			/*!
+				@brief Handles the call that has returned over the budget.
+				@param componentName Class name of the component.
+				@param durationMs Duration of the call.
+				@return False if the application should be stopped (KSF_LOOP_WATCHDOG_BREAK_APP), otherwise true.
+			*/
+			static bool onStall(const char* componentName, uint32_t durationMs);
+
+		public:
+			/*!
+				@brief Reads the stall record of the previous boot and starts the timer. Called from initializeFramework.
+			*/
+			static void begin();
+
+			/*!
+				@brief Marks the beginning of a component call.
+				@param componentName Class name of the component (see ksRtti::getInstanceName).
+			*/
+			static void enter(const char* componentName)
+			{
+				if constexpr (KSF_LOOP_WATCHDOG_BUDGET_MS > 0)
+				{
+					entryTime = millis();
+					currentComponent = componentName;
+				}
+			}
+
+			/*!
+				@brief Marks the end of a component call and checks the budget.
+				@return False if the call exceeded the budget and the application should be stopped, otherwise true.
+			*/
+			static bool leave()
+			{
+				if constexpr (KSF_LOOP_WATCHDOG_BUDGET_MS > 0)
+				{
+					auto durationMs{millis() - entryTime};
+					auto componentName{currentComponent};
+					currentComponent = nullptr;
+
+					if (durationMs > KSF_LOOP_WATCHDOG_BUDGET_MS)
+						return onStall(componentName, durationMs);
+				}
+				return true;
+			}
+
+			/*!
+				@brief Retrieves the number of stalls since boot.
+				@return Number of stalls.
+			*/
+			static uint32_t getStallCount() { return stallCount; }
+
+			/*!
+				@brief Retrieves the duration of the longest stall since boot.
+				@return Duration in milliseconds.
+			*/
+			static uint32_t getMaxStallMs() { return maxStallMs; }
+
+			/*!
+				@brief Retrieves the last stall of the previous boot.
+				@return Pointer to the stall record or nullptr if there was no stall before the reset.
+			*/
+			static const Stall* getPreviousStall() { return previousStall.magic == STALL_MAGIC ? &previousStall : nullptr; }
+	};
+}
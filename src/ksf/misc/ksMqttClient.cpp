@@ -0,0 +1,577 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#include <Arduino.h>
+#include <Client.h>
+#include <cstring>
+#include <algorithm>
+
+#include "ksMqttClient.h"
+
+namespace ksf::misc
+{
+	/* MQTT 3.1.1 control packet headers (type and mandatory flags). */
+	constexpr uint8_t MQTT_CONNECT{0x10};
+	constexpr uint8_t MQTT_CONNACK{0x20};
+	constexpr uint8_t MQTT_PUBLISH{0x30};
+	constexpr uint8_t MQTT_PUBACK{0x40};
+	constexpr uint8_t MQTT_PUBREC{0x50};
+	constexpr uint8_t MQTT_PUBREL{0x62};
+	constexpr uint8_t MQTT_PUBCOMP{0x70};
+	constexpr uint8_t MQTT_SUBSCRIBE{0x82};
+	constexpr uint8_t MQTT_UNSUBSCRIBE{0xA2};
+	constexpr uint8_t MQTT_PINGREQ{0xC0};
+	constexpr uint8_t MQTT_PINGRESP{0xD0};
+	constexpr uint8_t MQTT_DISCONNECT{0xE0};
+
+	/* Fixed header takes up to 5 bytes, so the transmit buffer must hold at least that. */
+	constexpr uint16_t MIN_TX_BUFFER_SIZE{16};
+
+	inline uint16_t readUint16(const uint8_t* buffer)
+	{
+		return static_cast<uint16_t>((buffer[0] << 8) | buffer[1]);
+	}
+
+	ksMqttClient::ksMqttClient(Client& client, uint16_t rxBufferSize, uint16_t txBufferSize, uint8_t inFlightWindow)
+		: client(client), rxBufferSize(rxBufferSize), txBufferSize(std::max(txBufferSize, MIN_TX_BUFFER_SIZE)), inFlightWindow(inFlightWindow)
+	{
+		rxBuffer = std::make_unique<uint8_t[]>(this->rxBufferSize);
+		txBuffer = std::make_unique<uint8_t[]>(this->txBufferSize);
+		if (inFlightWindow > 0)
+			inFlightIds = std::make_unique<uint16_t[]>(inFlightWindow);
+	}
+
+	ksMqttClient::~ksMqttClient() = default;
+
+	void ksMqttClient::setCallback(ksMqttMessageFunc_t callback)
+	{
+		onMessage = std::move(callback);
+	}
+
+	void ksMqttClient::setKeepAlive(uint16_t keepAliveSec)
+	{
+		this->keepAliveSec = keepAliveSec;
+	}
+
+	uint16_t ksMqttClient::nextPacketId()
+	{
+		if (++lastPacketId == 0)
+			lastPacketId = 1;
+		return lastPacketId;
+	}
+
+	bool ksMqttClient::writeRaw(const uint8_t* data, std::size_t length)
+	{
+		if (length == 0)
+			return true;
+
+		if (client.write(data, length) != length)
+			return false;
+
+		stats.bytesOut += length;
+		lastOutActivityMs = millis();
+		return true;
+	}
+
+	void ksMqttClient::beginPacket(uint8_t header, uint32_t remainingLength)
+	{
+		txPosition = 0;
+		txBuffer[txPosition++] = header;
+
+		/* Encode remaining length (7 bits per byte, MSB is the continuation flag). */
+		do
+		{
+			auto encodedByte{static_cast<uint8_t>(remainingLength & 0x7F)};
+			remainingLength >>= 7;
+			if (remainingLength > 0)
+				encodedByte |= 0x80;
+			txBuffer[txPosition++] = encodedByte;
+		}
+		while (remainingLength > 0);
+	}
+
+	bool ksMqttClient::appendRaw(const uint8_t* data, std::size_t length)
+	{
+		/* Small pieces are coalesced in the transmit buffer. */
+		if (txPosition + length <= txBufferSize)
+		{
+			std::memcpy(txBuffer.get() + txPosition, data, length);
+			txPosition += length;
+			return true;
+		}
+
+		/* Flush what is waiting, then write bigger pieces directly from the caller memory. */
+		if (!writeRaw(txBuffer.get(), txPosition))
+			return false;
+
+		txPosition = 0;
+		if (length <= txBufferSize)
+		{
+			std::memcpy(txBuffer.get(), data, length);
+			txPosition = length;
+			return true;
+		}
+
+		return writeRaw(data, length);
+	}
+
+	bool ksMqttClient::appendUint16(uint16_t value)
+	{
+		const uint8_t bytes[]{static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value & 0xFF)};
+		return appendRaw(bytes, sizeof(bytes));
+	}
+
+	bool ksMqttClient::appendString(std::string_view str)
+	{
+		return appendUint16(static_cast<uint16_t>(str.size())) && appendRaw(reinterpret_cast<const uint8_t*>(str.data()), str.size());
+	}
+
+	bool ksMqttClient::appendTopic(std::string_view topicPrefix, std::string_view topic)
+	{
+		return appendUint16(static_cast<uint16_t>(topicPrefix.size() + topic.size())) &&
+			appendRaw(reinterpret_cast<const uint8_t*>(topicPrefix.data()), topicPrefix.size()) &&
+			appendRaw(reinterpret_cast<const uint8_t*>(topic.data()), topic.size());
+	}
+
+	bool ksMqttClient::endPacket()
+	{
+		auto result{writeRaw(txBuffer.get(), txPosition)};
+		txPosition = 0;
+		return result;
+	}
+
+	bool ksMqttClient::sendAck(uint8_t header, uint16_t packetId)
+	{
+		beginPacket(header, 2);
+		return appendUint16(packetId) && endPacket();
+	}
+
+	void ksMqttClient::dropConnection()
+	{
+		client.stop();
+		bitflags.connected = false;
+		bitflags.pingOutstanding = false;
+		bitflags.streaming = false;
+		rxState = ERxState::FixedHeader;
+		txPosition = 0;
+		inFlightCount = 0;
+	}
+
+	bool ksMqttClient::connect(std::string_view clientId, std::string_view login, std::string_view password, std::string_view willTopic,
+		uint8_t willQos, bool willRetain, std::string_view willMessage, bool cleanSession, uint32_t timeoutMs)
+	{
+		/* Reset protocol state, it may be a reconnection. */
+		bitflags = {false, false, false, false, false};
+		rxState = ERxState::FixedHeader;
+		inFlightCount = 0;
+
+		/* Variable header: protocol name (6), protocol level (1), flags (1), keep alive (2). */
+		uint32_t remainingLength{10 + 2 + static_cast<uint32_t>(clientId.size())};
+		uint8_t connectFlags{0};
+
+		if (cleanSession)
+			connectFlags |= 0x02;
+
+		if (!willTopic.empty())
+		{
+			connectFlags |= 0x04 | ((willQos & 0x03) << 3) | (willRetain ? 0x20 : 0x00);
+			remainingLength += 4 + willTopic.size() + willMessage.size();
+		}
+
+		/* Password is allowed only together with user name. */
+		if (!login.empty())
+		{
+			connectFlags |= 0x80;
+			remainingLength += 2 + login.size();
+
+			if (!password.empty())
+			{
+				connectFlags |= 0x40;
+				remainingLength += 2 + password.size();
+			}
+		}
+
+		static constexpr uint8_t PROTOCOL_HEADER[]{0x00, 0x04, 'M', 'Q', 'T', 'T', 0x04};
+		beginPacket(MQTT_CONNECT, remainingLength);
+		auto success{appendRaw(PROTOCOL_HEADER, sizeof(PROTOCOL_HEADER)) && appendRaw(&connectFlags, 1) &&
+			appendUint16(keepAliveSec) && appendString(clientId)};
+
+		if (success && !willTopic.empty())
+			success = appendString(willTopic) && appendString(willMessage);
+
+		if (success && !login.empty())
+		{
+			success = appendString(login);
+			if (success && !password.empty())
+				success = appendString(password);
+		}
+
+		if (!success || !endPacket())
+		{
+			dropConnection();
+			return false;
+		}
+
+		/* Wait for CONNACK. */
+		auto startTimeMs{millis()};
+		while (!bitflags.connackReceived && millis() - startTimeMs < timeoutMs && client.connected())
+		{
+			receive();
+			if (!bitflags.connackReceived)
+				delay(1);
+		}
+
+		if (!bitflags.connackAccepted)
+		{
+			dropConnection();
+			return false;
+		}
+
+		bitflags.connected = true;
+		lastInActivityMs = lastOutActivityMs = millis();
+		return true;
+	}
+
+	void ksMqttClient::disconnect()
+	{
+		if (bitflags.connected)
+		{
+			beginPacket(MQTT_DISCONNECT, 0);
+			endPacket();
+		}
+
+		dropConnection();
+	}
+
+	bool ksMqttClient::connected()
+	{
+		if (bitflags.connected && !client.connected())
+			dropConnection();
+
+		return bitflags.connected;
+	}
+
+	void ksMqttClient::receive()
+	{
+		/* Consume only what is already there, never wait for the missing bytes. */
+		for (auto available{client.available()}; available > 0;)
+		{
+			switch (rxState)
+			{
+				case ERxState::FixedHeader:
+				{
+					auto byte{client.read()};
+					if (byte < 0)
+						return;
+
+					--available;
+					++stats.bytesIn;
+					rxHeader = static_cast<uint8_t>(byte);
+					rxLength = 0;
+					rxLengthShift = 0;
+					rxState = ERxState::RemainingLength;
+				}
+				break;
+
+				case ERxState::RemainingLength:
+				{
+					auto byte{client.read()};
+					if (byte < 0)
+						return;
+
+					--available;
+					++stats.bytesIn;
+					rxLength |= static_cast<uint32_t>(byte & 0x7F) << rxLengthShift;
+					rxLengthShift += 7;
+
+					if (byte & 0x80)
+					{
+						/* Remaining length is encoded on at most 4 bytes. */
+						if (rxLengthShift >= 28)
+						{
+							dropConnection();
+							return;
+						}
+						break;
+					}
+
+					rxPosition = 0;
+					if (rxLength > 0)
+					{
+						rxState = ERxState::Body;
+						break;
+					}
+
+					rxState = ERxState::FixedHeader;
+					handlePacket();
+				}
+				break;
+
+				case ERxState::Body:
+				{
+					/* Packets that don't fit are read into the buffer start and thrown away. */
+					auto fits{rxLength <= rxBufferSize};
+					auto toRead{std::min<uint32_t>(available, rxLength - rxPosition)};
+					if (!fits)
+						toRead = std::min<uint32_t>(toRead, rxBufferSize);
+
+					auto bytesRead{client.read(rxBuffer.get() + (fits ? rxPosition : 0), toRead)};
+					if (bytesRead <= 0)
+						return;
+
+					available -= bytesRead;
+					rxPosition += bytesRead;
+					stats.bytesIn += bytesRead;
+
+					if (rxPosition < rxLength)
+						break;
+
+					rxState = ERxState::FixedHeader;
+					if (fits)
+						handlePacket();
+					else
+						lastInActivityMs = millis();
+				}
+				break;
+			}
+		}
+	}
+
+	void ksMqttClient::handlePacket()
+	{
+		lastInActivityMs = millis();
+
+		switch (rxHeader & 0xF0)
+		{
+			case MQTT_CONNACK:
+				if (rxLength >= 2)
+				{
+					bitflags.connackReceived = true;
+					bitflags.connackAccepted = rxBuffer[1] == 0;
+				}
+			break;
+
+			case MQTT_PUBLISH:
+				handlePublish();
+			break;
+
+			/* QoS 1 publish ends with PUBACK, QoS 2 publish ends with PUBCOMP. */
+			case MQTT_PUBACK:
+			case MQTT_PUBCOMP:
+				if (rxLength >= 2)
+				{
+					auto packetId{readUint16(rxBuffer.get())};
+					auto inFlightEnd{inFlightIds.get() + inFlightCount};
+					if (auto it{std::find(inFlightIds.get(), inFlightEnd, packetId)}; it != inFlightEnd)
+					{
+						*it = *(inFlightEnd - 1);
+						--inFlightCount;
+					}
+				}
+			break;
+
+			/* QoS 2 publish stays in flight until PUBCOMP arrives. */
+			case MQTT_PUBREC:
+				if (rxLength >= 2 && !sendAck(MQTT_PUBREL, readUint16(rxBuffer.get())))
+					dropConnection();
+			break;
+
+			case (MQTT_PUBREL & 0xF0):
+				if (rxLength >= 2 && !sendAck(MQTT_PUBCOMP, readUint16(rxBuffer.get())))
+					dropConnection();
+			break;
+
+			case MQTT_PINGRESP:
+				if (bitflags.pingOutstanding)
+					stats.pingRoundTripMs = lastInActivityMs - pingSentTimeMs;
+				bitflags.pingOutstanding = false;
+			break;
+
+			default: break;
+		}
+	}
+
+	void ksMqttClient::handlePublish()
+	{
+		if (rxLength < 2)
+			return;
+
+		uint32_t topicLength{readUint16(rxBuffer.get())};
+		uint32_t payloadStart{2 + topicLength};
+		uint8_t qos((rxHeader >> 1) & 0x03);
+
+		if (qos > 0)
+			payloadStart += 2;
+
+		if (payloadStart > rxLength)
+			return;
+
+		++stats.messagesIn;
+
+		/* Acknowledge first, so the callback is free to publish. */
+		if (qos > 0)
+		{
+			auto packetId{readUint16(rxBuffer.get() + payloadStart - 2)};
+			if (!sendAck(qos == 1 ? MQTT_PUBACK : MQTT_PUBREC, packetId))
+			{
+				dropConnection();
+				return;
+			}
+		}
+
+		if (!onMessage)
+			return;
+
+		std::string_view topic{reinterpret_cast<const char*>(rxBuffer.get() + 2), topicLength};
+		std::string_view payload{reinterpret_cast<const char*>(rxBuffer.get() + payloadStart), rxLength - payloadStart};
+		onMessage(topic, payload);
+	}
+
+	bool ksMqttClient::loop()
+	{
+		if (!connected())
+			return false;
+
+		/* Nothing can be sent in the middle of streamed publish. */
+		if (bitflags.streaming)
+			return true;
+
+		receive();
+
+		if (!bitflags.connected)
+			return false;
+
+		/* Keep alive - send PINGREQ when idle, drop the connection if the previous one was not answered. */
+		auto nowMs{millis()};
+		auto keepAliveMs{keepAliveSec * 1000UL};
+		if (keepAliveMs > 0 && (nowMs - lastInActivityMs >= keepAliveMs || nowMs - lastOutActivityMs >= keepAliveMs))
+		{
+			if (bitflags.pingOutstanding)
+			{
+				dropConnection();
+				return false;
+			}
+
+			beginPacket(MQTT_PINGREQ, 0);
+			if (!endPacket())
+			{
+				dropConnection();
+				return false;
+			}
+
+			bitflags.pingOutstanding = true;
+			pingSentTimeMs = lastInActivityMs = nowMs;
+		}
+
+		return true;
+	}
+
+	bool ksMqttClient::publish(std::string_view topicPrefix, std::string_view topic, std::string_view payload, bool retain, uint8_t qos)
+	{
+		return beginPublish(topicPrefix, topic, payload.size(), retain, qos) && 
+			writePayload(reinterpret_cast<const uint8_t*>(payload.data()), payload.size()) && endPublish();
+	}
+
+	bool ksMqttClient::beginPublish(std::string_view topicPrefix, std::string_view topic, uint32_t payloadLength, bool retain, uint8_t qos)
+	{
+		if (bitflags.streaming || !connected() || (qos > 0 && inFlightCount >= inFlightWindow))
+		{
+			++stats.publishFailures;
+			return false;
+		}
+
+		qos = std::min<uint8_t>(qos, 2);
+
+		uint32_t remainingLength{2 + static_cast<uint32_t>(topicPrefix.size() + topic.size()) + payloadLength};
+		streamPacketId = 0;
+		if (qos > 0)
+		{
+			streamPacketId = nextPacketId();
+			remainingLength += 2;
+		}
+
+		beginPacket(MQTT_PUBLISH | (qos << 1) | (retain ? 0x01 : 0x00), remainingLength);
+		if (!appendTopic(topicPrefix, topic) || (qos > 0 && !appendUint16(streamPacketId)))
+		{
+			++stats.publishFailures;
+			dropConnection();
+			return false;
+		}
+
+		streamRemaining = payloadLength;
+		bitflags.streaming = true;
+		return true;
+	}
+
+	bool ksMqttClient::writePayload(const uint8_t* data, std::size_t length)
+	{
+		/* Nothing has been sent without a started stream (e.g. beginPublish failed), so the session stays. */
+		if (!bitflags.streaming)
+			return false;
+
+		/* Started packet can't be completed, the broker would take next bytes as its payload. */
+		if (length > streamRemaining || !appendRaw(data, length))
+		{
+			++stats.publishFailures;
+			dropConnection();
+			return false;
+		}
+
+		streamRemaining -= length;
+		return true;
+	}
+
+	bool ksMqttClient::endPublish()
+	{
+		if (!bitflags.streaming)
+			return false;
+
+		/* Packet length has been already sent, so a short payload leaves the stream in undefined state. */
+		if (streamRemaining != 0 || !endPacket())
+		{
+			++stats.publishFailures;
+			dropConnection();
+			return false;
+		}
+
+		++stats.messagesOut;
+		bitflags.streaming = false;
+		if (streamPacketId != 0)
+			inFlightIds[inFlightCount++] = streamPacketId;
+
+		return true;
+	}
+
+	bool ksMqttClient::subscribe(std::string_view topicPrefix, std::string_view topic, uint8_t qos)
+	{
+		if (bitflags.streaming || !connected())
+			return false;
+
+		uint8_t requestedQos(qos & 0x03);
+		beginPacket(MQTT_SUBSCRIBE, 2 + 2 + topicPrefix.size() + topic.size() + 1);
+		if (appendUint16(nextPacketId()) && appendTopic(topicPrefix, topic) && appendRaw(&requestedQos, 1) && endPacket())
+			return true;
+
+		dropConnection();
+		return false;
+	}
+
+	bool ksMqttClient::unsubscribe(std::string_view topicPrefix, std::string_view topic)
+	{
+		if (bitflags.streaming || !connected())
+			return false;
+
+		beginPacket(MQTT_UNSUBSCRIBE, 2 + 2 + topicPrefix.size() + topic.size());
+		if (appendUint16(nextPacketId()) && appendTopic(topicPrefix, topic) && endPacket())
+			return true;
+
+		dropConnection();
+		return false;
+	}
+}
@@ -0,0 +1,341 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <functional>
+#include <string_view>
+
+class Client;
+
+namespace ksf::misc
+{
+	/*!
+		@brief Callback function typedef for incoming MQTT messages.
+
+		Both views point directly into the receive buffer of the client. They are valid only until the callback returns.
+
+		@param topic Topic of the message.
+		@param payload Payload of the message.
+	*/
+	typedef std::function<void(std::string_view topic, std::string_view payload)> ksMqttMessageFunc_t;
+
+	/*!
+		@brief Traffic counters of the MQTT client. All counters are accumulated since client creation.
+	*/
+	struct ksMqttClientStats
+	{
+		uint32_t bytesIn{0};				//!< Number of bytes received.
+		uint32_t bytesOut{0};				//!< Number of bytes sent.
+		uint32_t messagesIn{0};				//!< Number of PUBLISH packets received.
+		uint32_t messagesOut{0};			//!< Number of PUBLISH packets sent.
+		uint32_t publishFailures{0};		//!< Number of publishes that couldn't be sent.
+		uint32_t pingRoundTripMs{0};		//!< Round-trip time of the last PINGREQ/PINGRESP exchange (milliseconds).
+	};
+
+	/*!
+		@brief Incremental MQTT 3.1.1 client.
+
+		Works on top of any Arduino Client (plain or secure). Incoming data is consumed with bulk reads of what is
+		currently available and fed into a streaming packet parser, so loop never waits for the missing bytes.
+		A packet that doesn't fit into the receive buffer is skipped without breaking the connection.
+
+		Outgoing packets are assembled in a small transmit buffer. Data that doesn't fit (usually the payload) is
+		written straight from the caller memory, so publish does not copy the message.
+
+		QoS 1 and QoS 2 publishes are tracked in a fixed in-flight window until PUBACK (QoS 1) or PUBCOMP (QoS 2)
+		arrives. When the window is full, publish returns false and the caller can retry later. In-flight messages
+		are not retransmitted after reconnection. Incoming QoS 2 messages are delivered on PUBLISH, so a message
+		redelivered by the broker after reconnection can reach the callback twice.
+
+		Reading never blocks. Writing does - packets are handed to Client::write, which returns once the network stack
+		has accepted the data. When the send buffer is full, this waits for the peer to acknowledge, no longer than
+		the timeout of the network client (ksMqttConnector sets it to KSF_MQTT_TIMEOUT_MS). A write that couldn't be
+		completed drops the connection. Connecting additionally waits for CONNACK, no longer than the timeout passed
+		to connect.
+	*/
+	class ksMqttClient
+	{
+		protected:
+			/*!
+				@brief Receive state of the streaming packet parser.
+			*/
+			enum class ERxState : uint8_t
+			{
+				FixedHeader,		//!< Waiting for the packet type byte.
+				RemainingLength,	//!< Decoding the variable length field.
+				Body				//!< Reading the packet body.
+			};
+
+			Client& client;											//!< Network client.
+			ksMqttMessageFunc_t onMessage;							//!< Incoming message callback.
+
+			std::unique_ptr<uint8_t[]> rxBuffer;					//!< Receive buffer (holds one packet body).
+			uint16_t rxBufferSize{0};								//!< Receive buffer capacity.
+			ERxState rxState{ERxState::FixedHeader};				//!< Parser state.
+			uint8_t rxHeader{0};									//!< Fixed header byte of the current packet.
+			uint8_t rxLengthShift{0};								//!< Bit shift of the next remaining length byte.
+			uint32_t rxLength{0};									//!< Body length of the current packet.
+			uint32_t rxPosition{0};									//!< Number of body bytes read so far.
+
+			std::unique_ptr<uint8_t[]> txBuffer;					//!< Transmit buffer (used to coalesce small writes).
+			uint16_t txBufferSize{0};								//!< Transmit buffer capacity.
+			uint16_t txPosition{0};									//!< Number of bytes waiting in the transmit buffer.
+
+			uint16_t keepAliveSec{15};								//!< Keep alive interval (seconds).
+			uint32_t lastInActivityMs{0};							//!< Time of the last received packet (milliseconds).
+			uint32_t lastOutActivityMs{0};							//!< Time of the last sent packet (milliseconds).
+			uint32_t pingSentTimeMs{0};								//!< Time of the last sent PINGREQ (milliseconds).
+			uint16_t lastPacketId{0};								//!< Last used packet identifier.
+			uint32_t streamRemaining{0};							//!< Payload bytes left to write in the streamed publish.
+			uint16_t streamPacketId{0};								//!< Packet identifier of the streamed publish (0 for QoS 0).
+
+			std::unique_ptr<uint16_t[]> inFlightIds;				//!< Identifiers of QoS 1/2 publishes waiting for PUBACK/PUBCOMP.
+			uint8_t inFlightWindow{0};								//!< Maximum number of QoS 1/2 publishes in flight.
+			uint8_t inFlightCount{0};								//!< Current number of QoS 1/2 publishes in flight.
+			ksMqttClientStats stats;								//!< Traffic counters.
+
+			struct
+			{
+				bool connected : 1;									//!< True if CONNACK has been accepted.
+				bool pingOutstanding : 1;							//!< True if PINGREQ has been sent and PINGRESP not yet received.
+				bool connackReceived : 1;							//!< True if CONNACK has been received.
+				bool connackAccepted : 1;							//!< True if received CONNACK accepted the connection.
+				bool streaming : 1;									//!< True if streamed publish is in progress.
+			}
+			bitflags = {false, false, false, false, false};
+
+			/*!
+				@brief Reads and parses all data that is currently available on the socket.
+			*/
+			void receive();
+
+			/*!
+				@brief Handles a completely received packet.
+			*/
+			void handlePacket();
+
+			/*!
+				@brief Handles a completely received PUBLISH packet.
+			*/
+			void handlePublish();
+
+			/*!
+				@brief Generates next non-zero packet identifier.
+				@return Packet identifier.
+			*/
+			uint16_t nextPacketId();
+
+			/*!
+				@brief Starts a new outgoing packet. Writes the fixed header into the transmit buffer.
+				@param header Fixed header byte (type and flags).
+				@param remainingLength Length of the packet without the fixed header.
+			*/
+			void beginPacket(uint8_t header, uint32_t remainingLength);
+
+			/*!
+				@brief Appends raw data to the outgoing packet.
+				@param data Pointer to the data.
+				@param length Length of the data.
+				@return True on success, false if the socket write failed.
+			*/
+			bool appendRaw(const uint8_t* data, std::size_t length);
+
+			/*!
+				@brief Appends a 16-bit big endian value to the outgoing packet.
+				@param value Value to be appended.
+				@return True on success, false if the socket write failed.
+			*/
+			bool appendUint16(uint16_t value);
+
+			/*!
+				@brief Appends a length-prefixed UTF-8 string to the outgoing packet.
+				@param str String to be appended.
+				@return True on success, false if the socket write failed.
+			*/
+			bool appendString(std::string_view str);
+
+			/*!
+				@brief Appends a length-prefixed topic built from two parts to the outgoing packet.
+				@param topicPrefix First part of the topic.
+				@param topic Second part of the topic.
+				@return True on success, false if the socket write failed.
+			*/
+			bool appendTopic(std::string_view topicPrefix, std::string_view topic);
+
+			/*!
+				@brief Writes raw data to the socket.
+				@param data Pointer to the data.
+				@param length Length of the data.
+				@return True if all bytes have been written, otherwise false.
+			*/
+			bool writeRaw(const uint8_t* data, std::size_t length);
+
+			/*!
+				@brief Writes out the rest of the outgoing packet.
+				@return True on success, false if the socket write failed.
+			*/
+			bool endPacket();
+
+			/*!
+				@brief Sends a packet that consists of the fixed header and a packet identifier only.
+				@param header Fixed header byte (type and flags).
+				@param packetId Packet identifier.
+				@return True on success, false if the socket write failed.
+			*/
+			bool sendAck(uint8_t header, uint16_t packetId);
+
+			/*!
+				@brief Drops the connection and resets the protocol state.
+			*/
+			void dropConnection();
+
+		public:
+			/*!
+				@brief Constructs the MQTT client.
+				@param client Reference to the network client used to transfer the data.
+				@param rxBufferSize Receive buffer size, limits the size of incoming packets.
+				@param txBufferSize Transmit buffer size, used to coalesce small writes.
+				@param inFlightWindow Maximum number of QoS 1/2 publishes waiting for acknowledgement.
+			*/
+			ksMqttClient(Client& client, uint16_t rxBufferSize, uint16_t txBufferSize, uint8_t inFlightWindow);
+
+			/*!
+				@brief Destructs the MQTT client.
+			*/
+			virtual ~ksMqttClient();
+
+			/*!
+				@brief Sets callback that receives incoming messages.
+				@param callback Callback function.
+			*/
+			void setCallback(ksMqttMessageFunc_t callback);
+
+			/*!
+				@brief Sets keep alive interval.
+				@param keepAliveSec Keep alive interval in seconds. Must be set before connect.
+			*/
+			void setKeepAlive(uint16_t keepAliveSec);
+
+			/*!
+				@brief Performs MQTT handshake over an already connected socket.
+				@param clientId Client identifier.
+				@param login User name (empty to skip).
+				@param password Password (empty to skip).
+				@param willTopic Last will topic (empty to skip last will).
+				@param willQos Last will QoS level.
+				@param willRetain True if last will message should be retained.
+				@param willMessage Last will message.
+				@param cleanSession True to request a clean session.
+				@param timeoutMs Maximum time to wait for CONNACK (milliseconds).
+				@return True if the broker accepted the connection, otherwise false.
+			*/
+			bool connect(std::string_view clientId, std::string_view login, std::string_view password, std::string_view willTopic,
+				uint8_t willQos, bool willRetain, std::string_view willMessage, bool cleanSession, uint32_t timeoutMs);
+
+			/*!
+				@brief Sends DISCONNECT and closes the socket.
+			*/
+			void disconnect();
+
+			/*!
+				@brief Retrieves connection state.
+				@return True if connected, otherwise false.
+			*/
+			bool connected();
+
+			/*!
+				@brief Processes incoming data and keep alive.
+				@return True if still connected, otherwise false.
+			*/
+			bool loop();
+
+			/*!
+				@brief Publishes a message.
+
+				Topic is passed in two parts, so the caller can skip building the full topic string.
+
+				@param topicPrefix First part of the topic (can be empty).
+				@param topic Second part of the topic.
+				@param payload Message payload.
+				@param retain True if the message should be retained.
+				@param qos QoS level (0, 1 or 2).
+				@return True if the message has been sent, false if not connected, socket failed or in-flight window is full.
+			*/
+			bool publish(std::string_view topicPrefix, std::string_view topic, std::string_view payload, bool retain = false, uint8_t qos = 0);
+
+			/*!
+				@brief Starts a streamed publish. Sends the packet header and the topic.
+
+				The payload must be then written with writePayload in one or more chunks, exactly payloadLength bytes in total,
+				followed by endPublish. Chunks go straight to the socket, so the whole payload never has to exist in memory.
+				Other packets can't be sent in between, so loop, publish, subscribe and unsubscribe must not be called
+				until endPublish returns (publish, subscribe and unsubscribe will fail meanwhile).
+
+				@param topicPrefix First part of the topic (can be empty).
+				@param topic Second part of the topic.
+				@param payloadLength Total length of the payload.
+				@param retain True if the message should be retained.
+				@param qos QoS level (0, 1 or 2).
+				@return True if the header has been sent, false if not connected, socket failed or in-flight window is full.
+			*/
+			bool beginPublish(std::string_view topicPrefix, std::string_view topic, uint32_t payloadLength, bool retain = false, uint8_t qos = 0);
+
+			/*!
+				@brief Writes a chunk of the streamed publish payload.
+				@param data Pointer to the chunk.
+				@param length Length of the chunk.
+				@return True on success, false if no stream is started, the chunk exceeds declared payload length or socket failed.
+					Without a started stream nothing is sent and the connection stays, otherwise the started packet can't be
+					completed and the connection is dropped.
+			*/
+			bool writePayload(const uint8_t* data, std::size_t length);
+
+			/*!
+				@brief Finishes the streamed publish.
+
+				If less bytes than declared have been written, the packet can't be completed and the connection is dropped.
+
+				@return True if the message has been sent completely, otherwise false.
+			*/
+			bool endPublish();
+
+			/*!
+				@brief Subscribes to a topic.
+				@param topicPrefix First part of the topic (can be empty).
+				@param topic Second part of the topic.
+				@param qos Requested QoS level.
+				@return True if SUBSCRIBE has been sent, otherwise false.
+			*/
+			bool subscribe(std::string_view topicPrefix, std::string_view topic, uint8_t qos = 0);
+
+			/*!
+				@brief Unsubscribes from a topic.
+				@param topicPrefix First part of the topic (can be empty).
+				@param topic Second part of the topic.
+				@return True if UNSUBSCRIBE has been sent, otherwise false.
+			*/
+			bool unsubscribe(std::string_view topicPrefix, std::string_view topic);
+
+			/*!
+				@brief Retrieves the number of QoS 1/2 publishes waiting for acknowledgement.
+				@return Number of messages in flight.
+			*/
+			uint8_t getInFlightCount() const { return inFlightCount; }
+
+			/*!
+				@brief Retrieves traffic counters.
+				@return Reference to the traffic counters.
+			*/
+			const ksMqttClientStats& getStats() const { return stats; }
+	};
+}
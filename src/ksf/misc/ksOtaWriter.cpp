@@ -0,0 +1,230 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#include <cstring>
+#include <algorithm>
+#include <Arduino.h>
+#if defined(ESP8266)
+	#include <Updater.h>
+#elif defined(ESP32)
+	#include <Update.h>
+	#include <esp_ota_ops.h>
+#else
+	#error Platform not implemented.
+#endif
+
+#include "../ksConstants.h"
+
+#include "ksDeltaPatcher.h"
+#include "ksHeatshrinkDecoder.h"
+#include "ksOtaWriter.h"
+
+namespace ksf::misc
+{
+	/*!
+		@brief Reads the currently running firmware image.
+		@param offset Offset in the image.
+		@param data Output buffer.
+		@param length Number of bytes to read.
+		@return True on success, otherwise false.
+	*/
+	static bool readRunningImage(uint32_t offset, uint8_t* data, std::size_t length)
+	{
+#if defined(ESP8266)
+		/* The image (together with the bootloader) starts at the beginning of the flash. */
+		return ESP.flashRead(offset, data, length);
+#elif defined(ESP32)
+		auto partition{esp_ota_get_running_partition()};
+		return partition && esp_partition_read(partition, offset, data, length) == ESP_OK;
+#else
+		#error Platform not implemented.
+#endif
+	}
+
+	/*!
+		@brief Converts MD5 digest to a hex string.
+		@param digest MD5 digest (16 bytes).
+		@return Hex string.
+	*/
+	static std::string md5ToHex(const uint8_t* digest)
+	{
+		static constexpr char HEX_DIGITS[] PROGMEM {"0123456789abcdef"};
+
+		std::string hex;
+		hex.reserve(32);
+		for (uint8_t i{0}; i < 16; ++i)
+		{
+			hex += pgm_read_byte(&HEX_DIGITS[digest[i] >> 4]);
+			hex += pgm_read_byte(&HEX_DIGITS[digest[i] & 0x0F]);
+		}
+		return hex;
+	}
+
+	/*!
+		@brief Checks whether the delta patch applies to the running image and sets the target image MD5.
+		@param header Patch header.
+		@return True if the patch can be applied, otherwise false.
+	*/
+	static bool validateDeltaHeader(const ksDeltaPatcher::Header& header)
+	{
+		if (header.sourceSize != ESP.getSketchSize())
+			return false;
+
+		if (md5ToHex(header.sourceMD5) != ESP.getSketchMD5().c_str())
+			return false;
+
+		return Update.setMD5(md5ToHex(header.targetMD5).c_str());
+	}
+
+	ksOtaWriter::ksOtaWriter() = default;
+
+	ksOtaWriter::~ksOtaWriter()
+	{
+		abort();
+	}
+
+	bool ksOtaWriter::begin(uint32_t expectedSize, const std::string& expectedMD5, Encoding encoding)
+	{
+		if (isActive())
+			abort();
+
+#if defined(ESP8266)
+		Update.runAsync(true);
+		auto maxSketchSpace{(ESP.getFreeSketchSpace() - 0x1000) & 0xFFFFF000};
+#elif defined(ESP32)
+		auto maxSketchSpace{UPDATE_SIZE_UNKNOWN};
+#else
+		#error Platform not implemented.
+#endif
+
+		/* Size of compressed image says nothing about the size of the image itself. */
+		auto imageSize{encoding == Encoding::Raw && expectedSize != 0 ? expectedSize : maxSketchSpace};
+		if (imageSize > maxSketchSpace)
+			return false;
+
+		if (!Update.begin(imageSize, U_FLASH))
+			return false;
+
+		if (!expectedMD5.empty() && !Update.setMD5(expectedMD5.c_str()))
+		{
+			Update.end();
+			return false;
+		}
+
+		if (encoding != Encoding::Raw)
+			decoder = std::make_unique<ksHeatshrinkDecoder>();
+
+		if (encoding == Encoding::Delta)
+			patcher = std::make_unique<ksDeltaPatcher>(readRunningImage, validateDeltaHeader);
+
+		block = std::make_unique<uint8_t[]>(KSF_OTA_BLOCK_SIZE);
+		blockLength = 0;
+		receivedBytes = 0;
+		this->expectedSize = expectedSize;
+		lastActivityTime = millis();
+		return true;
+	}
+
+	bool ksOtaWriter::flushBlock()
+	{
+		if (blockLength == 0)
+			return true;
+
+		auto written{Update.write(block.get(), blockLength)};
+		blockLength = 0;
+		return written > 0 && !Update.hasError();
+	}
+
+	bool ksOtaWriter::write(const uint8_t* data, std::size_t length)
+	{
+		if (!isActive())
+			return false;
+
+		if (expectedSize != 0 && length > expectedSize - receivedBytes)
+			return false;
+
+		lastActivityTime = millis();
+		receivedBytes += length;
+
+		if (patcher)
+		{
+			return decoder->decode(data, length, [this](const uint8_t* data, std::size_t length) {
+				return patcher->apply(data, length, [this](const uint8_t* data, std::size_t length) { return writeImage(data, length); });
+			});
+		}
+
+		if (decoder)
+			return decoder->decode(data, length, [this](const uint8_t* data, std::size_t length) { return writeImage(data, length); });
+
+		return writeImage(data, length);
+	}
+
+	bool ksOtaWriter::writeImage(const uint8_t* data, std::size_t length)
+	{
+		while (length > 0)
+		{
+			auto chunkLength{std::min(length, KSF_OTA_BLOCK_SIZE - blockLength)};
+			std::memcpy(block.get() + blockLength, data, chunkLength);
+			blockLength += chunkLength;
+			data += chunkLength;
+			length -= chunkLength;
+
+			if (blockLength == KSF_OTA_BLOCK_SIZE && !flushBlock())
+				return false;
+		}
+
+		return true;
+	}
+
+	bool ksOtaWriter::end()
+	{
+		if (!isActive())
+			return false;
+
+		/* With known size the image must be complete. Otherwise everything received so far is the image. */
+		if (!flushBlock() || (expectedSize != 0 && receivedBytes != expectedSize) || (decoder && !decoder->isComplete()) || (patcher && !patcher->isComplete()))
+		{
+			abort();
+			return false;
+		}
+
+		/* Update.end verifies MD5 (if set) and marks the new image as bootable. */
+		block.reset();
+		decoder.reset();
+		patcher.reset();
+		return Update.end(true);
+	}
+
+	void ksOtaWriter::abort()
+	{
+		if (!isActive())
+			return;
+
+#if defined(ESP32)
+		Update.abort();
+#else
+		Update.end();
+#endif
+		block.reset();
+		decoder.reset();
+		patcher.reset();
+		blockLength = 0;
+		receivedBytes = 0;
+	}
+
+	bool ksOtaWriter::isIdle(uint32_t timeoutMs) const
+	{
+		return isActive() && millis() - lastActivityTime > timeoutMs;
+	}
+
+	std::string ksOtaWriter::getMD5() const
+	{
+		return Update.md5String().c_str();
+	}
+}
@@ -0,0 +1,144 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace ksf::misc
+{
+	class ksDeltaPatcher;
+	class ksHeatshrinkDecoder;
+
+	/*!
+		@brief Writes firmware image into the update partition in flash-sector-sized blocks.
+
+		Incoming data of any size is collected in a block buffer and passed to the Update class in full sectors,
+		so flash is written (and erased) sector by sector, without partial writes. MD5 of the image is computed by the
+		Update class while writing and verified on end, if the expected MD5 has been provided.
+
+		The image can be also sent compressed (see ksHeatshrinkDecoder), then it's decompressed on the fly
+		and the expected size and resume offset refer to the compressed stream, while MD5 refers to the image.
+
+		A delta patch is applied against the currently running image. The patch carries MD5 of both images, so the
+		running image is checked before anything is written and the result is verified as usual.
+
+		The session survives a dropped connection. The sender can ask for the number of received bytes
+		and continue from that offset. The session should be aborted if it's not continued in reasonable time.
+	*/
+	class ksOtaWriter
+	{
+		public:
+			/*!
+				@brief Encoding of the incoming image data.
+			*/
+			enum class Encoding : uint8_t
+			{
+				Raw,			//!< Plain firmware image.
+				Heatshrink,		//!< Heatshrink-compressed image (scripts/ota_compress.py).
+				Delta			//!< Heatshrink-compressed delta patch against the running image (scripts/ota_delta.py).
+			};
+
+		protected:
+			std::unique_ptr<ksHeatshrinkDecoder> decoder;		//!< Decompressor (only for compressed images).
+			std::unique_ptr<ksDeltaPatcher> patcher;			//!< Delta patch applier (only for delta updates).
+			std::unique_ptr<uint8_t[]> block;					//!< Block buffer (allocated only during the session).
+			std::size_t blockLength{0};							//!< Number of bytes waiting in the block buffer.
+			uint32_t receivedBytes{0};							//!< Number of bytes received in the session.
+			uint32_t expectedSize{0};							//!< Expected size of the incoming data (0 if unknown).
+			uint32_t lastActivityTime{0};						//!< Time of last write (millis).
+
+			/*!
+				@brief Passes the block buffer content to the Update class.
+				@return True on success, otherwise false.
+			*/
+			bool flushBlock();
+
+			/*!
+				@brief Writes decoded image data through the block buffer.
+				@param data Pointer to the data.
+				@param length Length of the data.
+				@return True on success, otherwise false.
+			*/
+			bool writeImage(const uint8_t* data, std::size_t length);
+
+		public:
+			/*!
+				@brief Constructs the writer.
+			*/
+			ksOtaWriter();
+
+			/*!
+				@brief Destructs the writer, aborting active session.
+			*/
+			virtual ~ksOtaWriter();
+
+			/*!
+				@brief Starts a new update session. Aborts the previous one if it's still active.
+				@param expectedSize Size of the incoming data or 0 if unknown.
+				@param expectedMD5 Expected MD5 of the image (hex string) or empty string to skip verification.
+				@param encoding Encoding of the incoming data.
+				@return True on success, otherwise false.
+			*/
+			bool begin(uint32_t expectedSize = 0, const std::string& expectedMD5 = {}, Encoding encoding = Encoding::Raw);
+
+			/*!
+				@brief Writes next part of the image.
+				@param data Pointer to the data.
+				@param length Length of the data.
+				@return True on success, otherwise false (the session should be aborted).
+			*/
+			bool write(const uint8_t* data, std::size_t length);
+
+			/*!
+				@brief Writes remaining data and finishes the session, verifying the image.
+				@return True if the image has been written and verified, otherwise false.
+			*/
+			bool end();
+
+			/*!
+				@brief Aborts the session. The update partition stays invalid.
+			*/
+			void abort();
+
+			/*!
+				@brief Checks if the update session is active.
+				@return True if active, otherwise false.
+			*/
+			bool isActive() const { return static_cast<bool>(block); }
+
+			/*!
+				@brief Checks if the session hasn't received any data for the specified time.
+				@param timeoutMs Time in milliseconds.
+				@return True if the session is active and idle for longer than the timeout, otherwise false.
+			*/
+			bool isIdle(uint32_t timeoutMs) const;
+
+			/*!
+				@brief Retrieves the number of bytes received so far. This is the offset to resume from.
+				@return Number of received bytes.
+			*/
+			uint32_t getReceivedBytes() const { return receivedBytes; }
+
+			/*!
+				@brief Retrieves the expected size of the incoming data.
+				@return Expected size or 0 if unknown.
+			*/
+			uint32_t getExpectedSize() const { return expectedSize; }
+
+			/*!
+				@brief Retrieves MD5 computed from the image. Valid after successful end.
+				@return MD5 (hex string).
+			*/
+			std::string getMD5() const;
+	};
+}
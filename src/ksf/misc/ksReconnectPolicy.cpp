@@ -0,0 +1,79 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#include "ksReconnectPolicy.h"
+
+namespace ksf::misc
+{
+	ksReconnectPolicy::ksReconnectPolicy(uint32_t baseDelayMs, uint32_t maxDelayMs, uint8_t jitterPercent, uint32_t addressTtlMs)
+		: baseDelayMs(baseDelayMs), maxDelayMs(maxDelayMs < baseDelayMs ? baseDelayMs : maxDelayMs),
+		  addressTtlMs(addressTtlMs), jitterPercent(jitterPercent > 100 ? 100 : jitterPercent)
+	{}
+
+	void ksReconnectPolicy::setSeed(uint32_t seed)
+	{
+		randomState = seed != 0 ? seed : 0x9E3779B9;
+	}
+
+	uint32_t ksReconnectPolicy::nextRandom()
+	{
+		randomState ^= randomState << 13;
+		randomState ^= randomState >> 17;
+		randomState ^= randomState << 5;
+		return randomState;
+	}
+
+	uint32_t ksReconnectPolicy::applyJitter(uint32_t delayMs)
+	{
+		/* Spread the delay evenly in the range of <delay - jitter, delay + jitter>. */
+		auto jitterMs{static_cast<uint32_t>(static_cast<uint64_t>(delayMs) * jitterPercent / 100)};
+		if (jitterMs == 0)
+			return delayMs;
+
+		return delayMs - jitterMs + nextRandom() % (2 * jitterMs + 1);
+	}
+
+	bool ksReconnectPolicy::shouldAttempt(uint32_t nowMs) const
+	{
+		/* Signed difference handles millis() rollover. */
+		return static_cast<int32_t>(nowMs - nextAttemptTimeMs) >= 0;
+	}
+
+	void ksReconnectPolicy::onConnected()
+	{
+		failedAttempts = 0;
+		currentDelayMs = 0;
+	}
+
+	void ksReconnectPolicy::onDisconnected(uint32_t nowMs)
+	{
+		failedAttempts = 0;
+		currentDelayMs = 0;
+		nextAttemptTimeMs = nowMs;
+	}
+
+	void ksReconnectPolicy::onAttemptFailed(uint32_t nowMs)
+	{
+		if (failedAttempts < UINT16_MAX)
+			++failedAttempts;
+
+		/* Double the delay for each failed attempt, saturate at max delay. */
+		auto delayMs{static_cast<uint64_t>(baseDelayMs)};
+		for (auto i{1}; i < failedAttempts && delayMs < maxDelayMs; ++i)
+			delayMs <<= 1;
+
+		currentDelayMs = applyJitter(delayMs < maxDelayMs ? static_cast<uint32_t>(delayMs) : maxDelayMs);
+		nextAttemptTimeMs = nowMs + currentDelayMs;
+	}
+
+	bool ksReconnectPolicy::isAddressExpired(uint32_t resolvedTimeMs, uint32_t nowMs) const
+	{
+		return addressTtlMs != 0 && nowMs - resolvedTimeMs >= addressTtlMs;
+	}
+}
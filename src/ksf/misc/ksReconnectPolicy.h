@@ -0,0 +1,118 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace ksf::misc
+{
+	/*!
+		@brief Reconnection policy with exponential backoff, jitter and cached address lifetime.
+
+		The policy decides when the next connection attempt should happen. After a clean disconnect (the link was up
+		and then went down) the first retry is allowed immediately. Every failed attempt doubles the delay, starting
+		from the base delay and saturating at the maximum delay. Each delay is randomized by a jitter percentage,
+		so devices that lost the broker at the same moment won't retry in lockstep.
+
+		The policy also tells whether a previously resolved broker address is old enough to be resolved again.
+
+		It does not read the clock nor any hardware random source on its own. Time is passed as a parameter and the
+		jitter generator is seeded explicitly, so the class can be driven with simulated time on the host.
+	*/
+	class ksReconnectPolicy
+	{
+		protected:
+			uint32_t baseDelayMs{0};						//!< Delay after the first failed attempt (milliseconds).
+			uint32_t maxDelayMs{0};							//!< Upper bound of the backoff delay (milliseconds).
+			uint32_t addressTtlMs{0};						//!< Lifetime of the resolved address (milliseconds, 0 - infinite).
+			uint8_t jitterPercent{0};						//!< Jitter applied to each delay (percent of the delay).
+
+			uint32_t randomState{0x9E3779B9};				//!< Xorshift state used to generate jitter.
+			uint32_t nextAttemptTimeMs{0};					//!< Time of the next allowed attempt (milliseconds).
+			uint32_t currentDelayMs{0};						//!< Delay used to schedule the next attempt (milliseconds).
+			uint16_t failedAttempts{0};						//!< Number of consecutive failed attempts.
+
+			/*!
+				@brief Generates next pseudo-random number (xorshift32).
+				@return Pseudo-random 32-bit number.
+			*/
+			uint32_t nextRandom();
+
+			/*!
+				@brief Applies jitter to the delay value.
+				@param delayMs Delay in milliseconds.
+				@return Delay randomized by the jitter percentage.
+			*/
+			uint32_t applyJitter(uint32_t delayMs);
+
+		public:
+			/*!
+				@brief Constructs the reconnect policy.
+				@param baseDelayMs Delay after the first failed attempt (milliseconds).
+				@param maxDelayMs Upper bound of the backoff delay (milliseconds).
+				@param jitterPercent Jitter applied to each delay (0-100, percent of the delay).
+				@param addressTtlMs Lifetime of the resolved address (milliseconds, 0 means that address never expires).
+			*/
+			ksReconnectPolicy(uint32_t baseDelayMs, uint32_t maxDelayMs, uint8_t jitterPercent, uint32_t addressTtlMs);
+
+			/*!
+				@brief Seeds the jitter generator.
+				@param seed Seed value. Zero is replaced with a non-zero constant, as xorshift requires non-zero state.
+			*/
+			void setSeed(uint32_t seed);
+
+			/*!
+				@brief Checks whether the next connection attempt is allowed.
+				@param nowMs Current time (milliseconds).
+				@return True if the attempt should be made now, otherwise false.
+			*/
+			bool shouldAttempt(uint32_t nowMs) const;
+
+			/*!
+				@brief Notifies the policy about a successful connection. Resets the backoff.
+			*/
+			void onConnected();
+
+			/*!
+				@brief Notifies the policy about the loss of an established connection.
+
+				The first retry after a clean disconnect is allowed immediately.
+
+				@param nowMs Current time (milliseconds).
+			*/
+			void onDisconnected(uint32_t nowMs);
+
+			/*!
+				@brief Notifies the policy about a failed connection attempt. Schedules the next attempt with backoff.
+				@param nowMs Current time (milliseconds).
+			*/
+			void onAttemptFailed(uint32_t nowMs);
+
+			/*!
+				@brief Checks whether the resolved address should be refreshed.
+				@param resolvedTimeMs Time at which the address has been resolved (milliseconds).
+				@param nowMs Current time (milliseconds).
+				@return True if the address lifetime has expired, otherwise false.
+			*/
+			bool isAddressExpired(uint32_t resolvedTimeMs, uint32_t nowMs) const;
+
+			/*!
+				@brief Retrieves the number of consecutive failed attempts.
+				@return Number of consecutive failed attempts.
+			*/
+			uint16_t getFailedAttempts() const { return failedAttempts; }
+
+			/*!
+				@brief Retrieves the delay used to schedule the next attempt.
+				@return Delay in milliseconds (after jitter).
+			*/
+			uint32_t getCurrentDelayMs() const { return currentDelayMs; }
+	};
+}
@@ -0,0 +1,157 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#include <Arduino.h>
+#include <algorithm>
+#include <cstring>
+
+#include "ksSha256.h"
+
+namespace ksf::misc
+{
+	static constexpr uint32_t ROUND_CONSTANTS[64] PROGMEM {
+		0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+		0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+		0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+		0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+		0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+		0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+		0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+		0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+	};
+
+	static inline uint32_t rotr(uint32_t value, uint8_t bits)
+	{
+		return (value >> bits) | (value << (32 - bits));
+	}
+
+	ksSha256::ksSha256()
+		: state{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19}
+	{}
+
+	void ksSha256::processBlock(const uint8_t* data)
+	{
+		uint32_t w[64];
+		for (uint8_t i{0}; i < 16; ++i)
+			w[i] = static_cast<uint32_t>(data[i * 4]) << 24 | data[i * 4 + 1] << 16 | data[i * 4 + 2] << 8 | data[i * 4 + 3];
+
+		for (uint8_t i{16}; i < 64; ++i)
+		{
+			auto s0{rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3)};
+			auto s1{rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10)};
+			w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+		}
+
+		auto a{state[0]}, b{state[1]}, c{state[2]}, d{state[3]}, e{state[4]}, f{state[5]}, g{state[6]}, h{state[7]};
+		for (uint8_t i{0}; i < 64; ++i)
+		{
+			auto t1{h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + pgm_read_dword(&ROUND_CONSTANTS[i]) + w[i]};
+			auto t2{(rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c))};
+			h = g;
+			g = f;
+			f = e;
+			e = d + t1;
+			d = c;
+			c = b;
+			b = a;
+			a = t1 + t2;
+		}
+
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+		state[5] += f;
+		state[6] += g;
+		state[7] += h;
+	}
+
+	void ksSha256::update(const uint8_t* data, std::size_t length)
+	{
+		totalLength += length;
+
+		while (length > 0)
+		{
+			/* Full blocks are processed straight from the input, only the remainder is buffered. */
+			if (blockLength == 0 && length >= BLOCK_SIZE)
+			{
+				processBlock(data);
+				data += BLOCK_SIZE;
+				length -= BLOCK_SIZE;
+				continue;
+			}
+
+			auto partLength{std::min<std::size_t>(BLOCK_SIZE - blockLength, length)};
+			memcpy(block + blockLength, data, partLength);
+			blockLength += partLength;
+			data += partLength;
+			length -= partLength;
+
+			if (blockLength == BLOCK_SIZE)
+			{
+				processBlock(block);
+				blockLength = 0;
+			}
+		}
+	}
+
+	void ksSha256::finish(uint8_t* digest)
+	{
+		auto bitLength{totalLength * 8};
+
+		/* Padding: 0x80, zeros up to 56 bytes of the block and the message length in bits (big endian). */
+		block[blockLength++] = 0x80;
+		if (blockLength > BLOCK_SIZE - 8)
+		{
+			memset(block + blockLength, 0, BLOCK_SIZE - blockLength);
+			processBlock(block);
+			blockLength = 0;
+		}
+
+		memset(block + blockLength, 0, BLOCK_SIZE - 8 - blockLength);
+		for (uint8_t i{0}; i < 8; ++i)
+			block[BLOCK_SIZE - 1 - i] = static_cast<uint8_t>(bitLength >> (i * 8));
+		processBlock(block);
+
+		for (uint8_t i{0}; i < DIGEST_SIZE; ++i)
+			digest[i] = static_cast<uint8_t>(state[i / 4] >> (24 - (i % 4) * 8));
+	}
+
+	void ksSha256::hmac(std::string_view key, std::string_view message, uint8_t* digest)
+	{
+		/* Keys longer than the block are hashed first, shorter ones are padded with zeros. */
+		uint8_t keyBlock[BLOCK_SIZE]{};
+		if (key.size() > BLOCK_SIZE)
+		{
+			ksSha256 keyHash;
+			keyHash.update(key);
+			keyHash.finish(keyBlock);
+		}
+		else memcpy(keyBlock, key.data(), key.size());
+
+		uint8_t pad[BLOCK_SIZE];
+		for (uint8_t i{0}; i < BLOCK_SIZE; ++i)
+			pad[i] = keyBlock[i] ^ 0x36;
+
+		ksSha256 inner;
+		inner.update(pad, BLOCK_SIZE);
+		inner.update(message);
+		uint8_t innerDigest[DIGEST_SIZE];
+		inner.finish(innerDigest);
+
+		for (uint8_t i{0}; i < BLOCK_SIZE; ++i)
+			pad[i] = keyBlock[i] ^ 0x5c;
+
+		ksSha256 outer;
+		outer.update(pad, BLOCK_SIZE);
+		outer.update(innerDigest, DIGEST_SIZE);
+		outer.finish(digest);
+	}
+}
@@ -0,0 +1,78 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace ksf::misc
+{
+	/*!
+		@brief Incremental SHA-256 hash (FIPS 180-4) with HMAC-SHA256 (RFC 2104) helper.
+
+		Portable implementation that works the same on both platforms and on the host, used to authenticate
+		update commands. Round constants are kept in flash.
+	*/
+	class ksSha256
+	{
+		public:
+			static constexpr std::size_t DIGEST_SIZE{32};		//!< Size of the digest (bytes).
+			static constexpr std::size_t BLOCK_SIZE{64};		//!< Size of the processed block (bytes).
+
+		protected:
+			uint32_t state[8];									//!< Hash state.
+			uint8_t block[BLOCK_SIZE];							//!< Buffered input, not processed yet.
+			uint64_t totalLength{0};							//!< Number of bytes hashed so far.
+			uint8_t blockLength{0};								//!< Number of bytes in the block buffer.
+
+			/*!
+				@brief Processes a full block of input.
+				@param data Pointer to BLOCK_SIZE bytes.
+			*/
+			void processBlock(const uint8_t* data);
+
+		public:
+			/*!
+				@brief Constructs the hash with the initial state.
+			*/
+			ksSha256();
+
+			/*!
+				@brief Hashes the next part of the input.
+				@param data Pointer to the data.
+				@param length Length of the data.
+			*/
+			void update(const uint8_t* data, std::size_t length);
+
+			/*!
+				@brief Hashes the next part of the input.
+				@param data Data (RAM).
+			*/
+			void update(std::string_view data)
+			{
+				update(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+			}
+
+			/*!
+				@brief Finishes hashing and retrieves the digest. The object must not be updated afterwards.
+				@param digest Output buffer of DIGEST_SIZE bytes.
+			*/
+			void finish(uint8_t* digest);
+
+			/*!
+				@brief Computes HMAC-SHA256 of the message.
+				@param key Secret key (RAM).
+				@param message Message (RAM).
+				@param digest Output buffer of DIGEST_SIZE bytes.
+			*/
+			static void hmac(std::string_view key, std::string_view message, uint8_t* digest);
+	};
+}
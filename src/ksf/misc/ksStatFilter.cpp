@@ -0,0 +1,135 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#include <Arduino.h>
+#include <cmath>
+
+#include "ksStatFilter.h"
+
+namespace ksf::misc
+{
+	uint32_t ksStatFilter::hashPath(std::string_view str, uint32_t hash)
+	{
+		/* Stat names are usually kept in flash, so each byte is read with pgm_read_byte (plain load on ESP32). */
+		for (std::size_t i{0}; i < str.size(); ++i)
+		{
+			hash ^= pgm_read_byte(str.data() + i);
+			hash *= 16777619UL;
+		}
+		return hash;
+	}
+
+	ksStatFilter::Entry& ksStatFilter::findOrCreate(uint32_t pathHash)
+	{
+		for (auto& entry : entries)
+			if (entry.pathHash == pathHash)
+				return entry;
+
+		auto& entry{entries.emplace_back()};
+		entry.pathHash = pathHash;
+		return entry;
+	}
+
+	void ksStatFilter::setThreshold(std::string_view path, float threshold)
+	{
+		findOrCreate(hashPath(path)).threshold = threshold;
+	}
+
+	bool ksStatFilter::update(uint32_t pathHash, double value, bool force)
+	{
+		auto& entry{findOrCreate(pathHash)};
+
+		if (!force && entry.reported)
+		{
+			if (value == entry.lastValue)
+				return false;
+
+			/* Infinite threshold never passes, such stat is reported on heartbeat only. */
+			if (std::fabs(value - entry.lastValue) < entry.threshold)
+				return false;
+		}
+
+		entry.reported = true;
+		entry.lastValue = value;
+		return true;
+	}
+
+	void ksStatFilter::reset()
+	{
+		for (auto& entry : entries)
+			entry.reported = false;
+	}
+
+	ksFilteredStatWriter::ksFilteredStatWriter(ksStatWriter& target, ksStatFilter& filter, bool force)
+		: target(target), filter(filter), force(force)
+	{
+		groupHashes[0] = ksStatFilter::hashPath({});
+	}
+
+	uint32_t ksFilteredStatWriter::pathHashOf(std::string_view name) const
+	{
+		return ksStatFilter::hashPath(name, groupHashes[groupDepth]);
+	}
+
+	void ksFilteredStatWriter::beginGroup(std::string_view name)
+	{
+		/* Groups nested deeper than supported share the path hash of the deepest supported one. */
+		if (groupDepth < MAX_GROUP_DEPTH)
+		{
+			groupHashes[groupDepth + 1] = ksStatFilter::hashPath("/", ksStatFilter::hashPath(name, groupHashes[groupDepth]));
+			++groupDepth;
+		}
+
+		target.beginGroup(name);
+	}
+
+	void ksFilteredStatWriter::endGroup()
+	{
+		if (groupDepth > 0)
+			--groupDepth;
+
+		target.endGroup();
+	}
+
+	void ksFilteredStatWriter::addInt(std::string_view name, int64_t value)
+	{
+		if (!filter.update(pathHashOf(name), static_cast<double>(value), force))
+			return;
+
+		target.addInt(name, value);
+		++forwardedCount;
+	}
+
+	void ksFilteredStatWriter::addUnsigned(std::string_view name, uint64_t value)
+	{
+		if (!filter.update(pathHashOf(name), static_cast<double>(value), force))
+			return;
+
+		target.addUnsigned(name, value);
+		++forwardedCount;
+	}
+
+	void ksFilteredStatWriter::addFloat(std::string_view name, double value, uint8_t decimals)
+	{
+		if (!filter.update(pathHashOf(name), value, force))
+			return;
+
+		target.addFloat(name, value, decimals);
+		++forwardedCount;
+	}
+
+	void ksFilteredStatWriter::addString(std::string_view name, std::string_view value)
+	{
+		if (!filter.update(pathHashOf(name), ksStatFilter::hashPath(value), force))
+			return;
+
+		target.addString(name, value);
+		++forwardedCount;
+	}
+}
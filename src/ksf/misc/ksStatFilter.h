@@ -0,0 +1,130 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <string_view>
+
+#include "ksStatWriter.h"
+
+namespace ksf::misc
+{
+	/*!
+		@brief Remembers last reported stat values and decides whether a new value is worth reporting.
+
+		Stats are identified by a hash of their path (group names and stat name joined with slashes, e.g. "mqtt/bytesIn").
+		Each stat can have its own change threshold. A value is reported when it differs from the last reported value
+		by at least the threshold. Threshold of 0 means any change, infinity means the stat is reported on heartbeat only.
+		Stats without explicitly set threshold use 0.
+	*/
+	class ksStatFilter
+	{
+		protected:
+			/*!
+				@brief State of a single stat.
+			*/
+			struct Entry
+			{
+				uint32_t pathHash{0};			//!< Hash of the stat path.
+				float threshold{0};				//!< Minimum change that triggers a report.
+				bool reported{false};			//!< True if the stat has been reported at least once.
+				double lastValue{0};			//!< Last reported value.
+			};
+
+			std::vector<Entry> entries;			//!< Known stats.
+
+			/*!
+				@brief Finds the entry of a stat or creates a new one.
+				@param pathHash Hash of the stat path.
+				@return Reference to the entry.
+			*/
+			Entry& findOrCreate(uint32_t pathHash);
+
+		public:
+			/*!
+				@brief Hashes a part of the stat path (FNV-1a).
+				@param str Part of the path. It can point to flash (PROGMEM) or RAM.
+				@param hash Hash of the preceding part of the path (or initial value).
+				@return Hash of the path.
+			*/
+			static uint32_t hashPath(std::string_view str, uint32_t hash = 2166136261UL);
+
+			/*!
+				@brief Sets the change threshold of a stat.
+				@param path Path of the stat (e.g. "rssi" or "mqtt/bytesIn").
+				@param threshold Minimum change that triggers a report (0 - any change, infinity - heartbeat only).
+			*/
+			void setThreshold(std::string_view path, float threshold);
+
+			/*!
+				@brief Checks whether the value should be reported and, if so, remembers it as the last reported one.
+				@param pathHash Hash of the stat path.
+				@param value Current value.
+				@param force True to report regardless of the threshold (heartbeat).
+				@return True if the value should be reported, otherwise false.
+			*/
+			bool update(uint32_t pathHash, double value, bool force);
+
+			/*!
+				@brief Forgets all reported values, so every stat is reported on the next update. Thresholds are kept.
+			*/
+			void reset();
+	};
+
+	/*!
+		@brief Stat writer that forwards to another writer only those values that changed significantly.
+
+		The decision is made by ksStatFilter, which holds the state between reports. The writer itself is meant
+		to be constructed for a single report. Groups are always forwarded, so a compact document may contain
+		empty groups. String values are compared by their hash.
+	*/
+	class ksFilteredStatWriter : public ksStatWriter
+	{
+		protected:
+			static constexpr uint8_t MAX_GROUP_DEPTH{4};		//!< Maximum supported group nesting.
+
+			ksStatWriter& target;								//!< Writer that receives forwarded values.
+			ksStatFilter& filter;								//!< Filter that holds reported values.
+			uint32_t groupHashes[MAX_GROUP_DEPTH + 1];			//!< Path hashes of the open groups (index 0 is the root).
+			uint8_t groupDepth{0};								//!< Number of open groups.
+			uint16_t forwardedCount{0};							//!< Number of forwarded values.
+			bool force{false};									//!< True if all values should be forwarded (heartbeat).
+
+			/*!
+				@brief Computes the path hash of a stat in the current group.
+				@param name Name of the stat.
+				@return Hash of the stat path.
+			*/
+			uint32_t pathHashOf(std::string_view name) const;
+
+		public:
+			/*!
+				@brief Constructs the filtered stat writer.
+				@param target Writer that receives forwarded values.
+				@param filter Filter that decides which values are forwarded.
+				@param force True to forward all values (heartbeat report).
+			*/
+			ksFilteredStatWriter(ksStatWriter& target, ksStatFilter& filter, bool force);
+
+			void beginGroup(std::string_view name) override;
+			void endGroup() override;
+			void addInt(std::string_view name, int64_t value) override;
+			void addUnsigned(std::string_view name, uint64_t value) override;
+			void addFloat(std::string_view name, double value, uint8_t decimals = 2) override;
+			void addString(std::string_view name, std::string_view value) override;
+
+			/*!
+				@brief Retrieves the number of values forwarded to the target writer.
+				@return Number of forwarded values.
+			*/
+			uint16_t getForwardedCount() const { return forwardedCount; }
+	};
+}
@@ -0,0 +1,210 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#include <cmath>
+#include <cstring>
+
+#include "../ksConstants.h"
+#include "ksCborWriter.h"
+#include "ksStatWriter.h"
+
+namespace ksf::misc
+{
+	static constexpr uint8_t CBOR_INDEFINITE_MAP{0xBF};
+	static constexpr uint8_t CBOR_BREAK{0xFF};
+	static constexpr std::size_t MAX_JSON_ESCAPE_LENGTH{6};		// Longest JSON escape sequence (\u00XX).
+
+	ksCompactStatWriter::ksCompactStatWriter(Format format, uint8_t* buffer, std::size_t capacity)
+		: buffer(buffer), capacity(capacity), format(format)
+	{}
+
+	void ksCompactStatWriter::append(const void* data, std::size_t size)
+	{
+		if (overflow || size > capacity - length)
+		{
+			overflow = true;
+			return;
+		}
+
+		std::memcpy(buffer + length, data, size);
+		length += size;
+	}
+
+	void ksCompactStatWriter::appendJsonName(std::string_view name)
+	{
+		if (needsSeparator)
+			append(",", 1);
+
+		append("\"", 1);
+		appendJsonEscaped(name);
+		append("\":", 2);
+		needsSeparator = true;
+	}
+
+	void ksCompactStatWriter::appendJsonEscaped(std::string_view str)
+	{
+		/* Names are usually kept in flash, so each byte is read with pgm_read_byte (plain load on ESP32). */
+		for (std::size_t i{0}; i < str.size() && !overflow; ++i)
+		{
+			auto ch{static_cast<char>(pgm_read_byte(str.data() + i))};
+			if (capacity - length >= MAX_JSON_ESCAPE_LENGTH)
+			{
+				length += ksf::json_escape_char(ch, reinterpret_cast<char*>(buffer + length));
+				continue;
+			}
+
+			/* Close to the end of the buffer, the sequence must not be written partially. */
+			char sequence[MAX_JSON_ESCAPE_LENGTH];
+			append(sequence, ksf::json_escape_char(ch, sequence));
+		}
+	}
+
+	void ksCompactStatWriter::commitCbor(const ksCborWriter& cborWriter)
+	{
+		if (overflow || cborWriter.hasOverflow())
+			overflow = true;
+		else
+			length += cborWriter.getLength();
+	}
+
+	void ksCompactStatWriter::begin()
+	{
+		length = 0;
+		overflow = false;
+		needsSeparator = false;
+
+		if (format == Format::Json)
+			append("{", 1);
+		else
+			append(&CBOR_INDEFINITE_MAP, 1);
+	}
+
+	bool ksCompactStatWriter::end()
+	{
+		if (format == Format::Json)
+			append("}", 1);
+		else
+			append(&CBOR_BREAK, 1);
+
+		return !overflow;
+	}
+
+	void ksCompactStatWriter::beginGroup(std::string_view name)
+	{
+		if (format == Format::Json)
+		{
+			appendJsonName(name);
+			append("{", 1);
+			needsSeparator = false;
+			return;
+		}
+
+		ksCborWriter cborWriter{buffer + length, capacity - length};
+		cborWriter.writeText(name);
+		cborWriter.beginIndefiniteMap();
+		commitCbor(cborWriter);
+	}
+
+	void ksCompactStatWriter::endGroup()
+	{
+		if (format == Format::Json)
+		{
+			append("}", 1);
+			needsSeparator = true;
+			return;
+		}
+
+		append(&CBOR_BREAK, 1);
+	}
+
+	void ksCompactStatWriter::appendJsonUnsigned(uint64_t value)
+	{
+		char digits[KSF_TO_CHARS_BUFFER_SIZE];
+		append(digits, ksf::format_unsigned(digits, value) - digits);
+	}
+
+	void ksCompactStatWriter::addInt(std::string_view name, int64_t value)
+	{
+		if (format == Format::Json)
+		{
+			appendJsonName(name);
+			if (value < 0)
+			{
+				/* Negate as unsigned, so INT64_MIN doesn't overflow. */
+				append("-", 1);
+				appendJsonUnsigned(~static_cast<uint64_t>(value) + 1);
+			}
+			else appendJsonUnsigned(static_cast<uint64_t>(value));
+			return;
+		}
+
+		ksCborWriter cborWriter{buffer + length, capacity - length};
+		cborWriter.writeText(name);
+		cborWriter.writeInt(value);
+		commitCbor(cborWriter);
+	}
+
+	void ksCompactStatWriter::addUnsigned(std::string_view name, uint64_t value)
+	{
+		if (format == Format::Json)
+		{
+			appendJsonName(name);
+			appendJsonUnsigned(value);
+			return;
+		}
+
+		ksCborWriter cborWriter{buffer + length, capacity - length};
+		cborWriter.writeText(name);
+		cborWriter.writeUnsigned(value);
+		commitCbor(cborWriter);
+	}
+
+	void ksCompactStatWriter::addFloat(std::string_view name, double value, uint8_t decimals)
+	{
+		if (format == Format::Json)
+		{
+			appendJsonName(name);
+			/* JSON has no representation of NaN and infinity. */
+			if (std::isfinite(value))
+			{
+				char digits[KSF_TO_CHARS_BUFFER_SIZE];
+				append(digits, ksf::to_chars(digits, value, decimals) - digits);
+			}
+			else
+				append("null", 4);
+			return;
+		}
+
+		/* Use single precision if it holds the value exactly, it takes 4 bytes less. */
+		ksCborWriter cborWriter{buffer + length, capacity - length};
+		cborWriter.writeText(name);
+		if (auto singleValue{static_cast<float>(value)}; static_cast<double>(singleValue) == value || std::isnan(value))
+			cborWriter.writeFloat(singleValue);
+		else
+			cborWriter.writeDouble(value);
+		commitCbor(cborWriter);
+	}
+
+	void ksCompactStatWriter::addString(std::string_view name, std::string_view value)
+	{
+		if (format == Format::Json)
+		{
+			appendJsonName(name);
+			append("\"", 1);
+			appendJsonEscaped(value);
+			append("\"", 1);
+			return;
+		}
+
+		ksCborWriter cborWriter{buffer + length, capacity - length};
+		cborWriter.writeText(name);
+		cborWriter.writeText(value);
+		commitCbor(cborWriter);
+	}
+}
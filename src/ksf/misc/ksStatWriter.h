@@ -0,0 +1,189 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+namespace ksf::misc
+{
+	class ksCborWriter;
+
+	/*!
+		@brief Interface used to collect named statistic values.
+
+		Producers of the statistics (like ksDevStatMqttReporter) write values through this interface,
+		without knowing whether they end up in separate MQTT topics or in a single encoded document.
+		Values can be organized into named groups. Groups can be nested.
+	*/
+	class ksStatWriter
+	{
+		public:
+			/*!
+				@brief Destructs the stat writer.
+			*/
+			virtual ~ksStatWriter() = default;
+
+			/*!
+				@brief Starts a named group of values. Must be closed with endGroup.
+				@param name Name of the group.
+			*/
+			virtual void beginGroup(std::string_view name) = 0;
+
+			/*!
+				@brief Closes the innermost group.
+			*/
+			virtual void endGroup() = 0;
+
+			/*!
+				@brief Adds a signed integer value.
+				@param name Name of the value.
+				@param value Value to be added.
+			*/
+			virtual void addInt(std::string_view name, int64_t value) = 0;
+
+			/*!
+				@brief Adds an unsigned integer value.
+				@param name Name of the value.
+				@param value Value to be added.
+			*/
+			virtual void addUnsigned(std::string_view name, uint64_t value) = 0;
+
+			/*!
+				@brief Adds a floating point value.
+				@param name Name of the value.
+				@param value Value to be added.
+				@param decimals Number of decimal places used by text formats.
+			*/
+			virtual void addFloat(std::string_view name, double value, uint8_t decimals = 2) = 0;
+
+			/*!
+				@brief Adds a string value.
+				@param name Name of the value.
+				@param value Value to be added.
+			*/
+			virtual void addString(std::string_view name, std::string_view value) = 0;
+	};
+
+	/*!
+		@brief Stat writer that encodes all values into a single JSON or CBOR document.
+
+		The document is written into a buffer provided by the caller, so the same memory can be reused for every report.
+		The root of the document is an object (map), each group becomes a nested object. CBOR containers are written
+		as indefinite-length maps, so values can be added without counting them first.
+
+		JSON names and string values are escaped straight into the buffer. Names can point to flash (PROGMEM).
+
+		If the document doesn't fit into the buffer, the overflow flag is set and the document must be discarded.
+	*/
+	class ksCompactStatWriter : public ksStatWriter
+	{
+		public:
+			/*!
+				@brief Document encoding.
+			*/
+			enum class Format : uint8_t
+			{
+				Json,		//!< JSON text.
+				Cbor		//!< CBOR (RFC 8949) binary.
+			};
+
+		protected:
+			uint8_t* buffer{nullptr};						//!< Output buffer.
+			std::size_t capacity{0};						//!< Output buffer capacity.
+			std::size_t length{0};							//!< Number of bytes written.
+			Format format{Format::Json};					//!< Document encoding.
+			bool overflow{false};							//!< True if the document didn't fit into the buffer.
+			bool needsSeparator{false};						//!< True if the next JSON member must be preceded by a comma.
+
+			/*!
+				@brief Appends raw bytes to the document.
+				@param data Pointer to the data.
+				@param size Size of the data.
+			*/
+			void append(const void* data, std::size_t size);
+
+			/*!
+				@brief Appends a string to the document.
+				@param str String to be appended.
+			*/
+			void append(std::string_view str) { append(str.data(), str.size()); }
+
+			/*!
+				@brief Writes the separator (if required) and the quoted, escaped member name of a JSON object.
+				@param name Name of the member.
+			*/
+			void appendJsonName(std::string_view name);
+
+			/*!
+				@brief Escapes a string for JSON directly into the document (without quotes).
+				@param str String to be appended. It can point to flash (PROGMEM) or RAM.
+			*/
+			void appendJsonEscaped(std::string_view str);
+
+			/*!
+				@brief Appends decimal representation of an unsigned integer to the document.
+				@param value Value to be appended.
+			*/
+			void appendJsonUnsigned(uint64_t value);
+
+			/*!
+				@brief Accepts CBOR data encoded in place after the end of the document.
+				@param cborWriter CBOR encoder that was writing into the remaining space of the buffer.
+			*/
+			void commitCbor(const ksCborWriter& cborWriter);
+
+		public:
+			/*!
+				@brief Constructs the compact stat writer.
+				@param format Document encoding.
+				@param buffer Pointer to the output buffer.
+				@param capacity Capacity of the output buffer.
+			*/
+			ksCompactStatWriter(Format format, uint8_t* buffer, std::size_t capacity);
+
+			/*!
+				@brief Discards previous content and opens the root object.
+			*/
+			void begin();
+
+			/*!
+				@brief Closes the root object.
+				@return True if the whole document fits into the buffer, otherwise false.
+			*/
+			bool end();
+
+			void beginGroup(std::string_view name) override;
+			void endGroup() override;
+			void addInt(std::string_view name, int64_t value) override;
+			void addUnsigned(std::string_view name, uint64_t value) override;
+			void addFloat(std::string_view name, double value, uint8_t decimals = 2) override;
+			void addString(std::string_view name, std::string_view value) override;
+
+			/*!
+				@brief Retrieves the document encoding.
+				@return Document encoding.
+			*/
+			Format getFormat() const { return format; }
+
+			/*!
+				@brief Retrieves the encoded document.
+				@return View of the encoded document (binary in case of CBOR).
+			*/
+			std::string_view getDocument() const { return {reinterpret_cast<const char*>(buffer), length}; }
+
+			/*!
+				@brief Checks if the document didn't fit into the buffer.
+				@return True if the buffer was too small, otherwise false.
+			*/
+			bool hasOverflow() const { return overflow; }
+	};
+}
@@ -7,6 +7,12 @@
  *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
  */
 
+#include <algorithm>
+#if defined(ESP32)
+	#include <lwip/sockets.h>
+#endif
+
+#include "../ksConstants.h"
 #include "ksWSServer.h"
 
 namespace ksf::misc
@@ -14,6 +20,9 @@ namespace ksf::misc
 	/* Error code returned to the frontend on validation fail. Frontend should reload the page in this case. */
 	constexpr auto WEBSOCKET_VALIDATION_FAIL{1008};
 
+	/* Smallest TCP segment. Written at a time when the socket doesn't report its free space. */
+	constexpr std::size_t MIN_WRITE_SPACE{536};
+
 	ksWSServer::ksWSServer(uint16_t port)
 		: wsListener(std::make_unique<WiFiServer>(port))
 	{}
@@ -43,12 +52,15 @@ namespace ksf::misc
 			return true;
 		}, headerkeys, sizeof(headerkeys)/sizeof(char*));
 
-		/* Setup WStype_TEXT message handler. */
+		/* Setup WStype_TEXT message handler. Queue is cleared, so the client number reused by a new client starts clean. */
 		onEvent([this](uint8_t num, WStype_t type, uint8_t * payload, size_t length) {
 			if (type == WStype_TEXT && onWebsocketTextMessage) {
 				auto sv{std::string_view(reinterpret_cast<char*>(payload), length)};
 				onWebsocketTextMessage(num, std::move(sv));
 			}
+			else if (type == WStype_CONNECTED || type == WStype_DISCONNECTED) {
+				clearSendQueue(num);
+			}
 		});
 
 		/* Start WS server that listens for incoming clients. */
@@ -71,6 +83,154 @@ namespace ksf::misc
 
 		/* Execute core logic. */
 		WebSocketsServerCore::loop();
+
+		/* Send queued messages, as much as the sockets can take without blocking. */
+		flushSendQueues();
+	}
+
+	std::size_t ksWSServer::getWriteSpace(WSclient_t* client)
+	{
+#if defined(ESP8266)
+		return static_cast<std::size_t>(client->tcp->availableForWrite());
+#elif defined(ESP32)
+		/* 
+			WiFiClient on ESP32 doesn't report free space, so the socket is polled with zero timeout. Writable socket
+			has more than the low-water mark free (at least two segments in lwIP), so one smallest segment always fits.
+		*/
+		auto fd{client->tcp->fd()};
+		if (fd < 0)
+			return 0;
+
+		fd_set writeSet;
+		FD_ZERO(&writeSet);
+		FD_SET(fd, &writeSet);
+		timeval timeout{0, 0};
+		return select(fd + 1, nullptr, &writeSet, nullptr, &timeout) > 0 ? MIN_WRITE_SPACE : 0;
+#else
+		#error Platform not implemented.
+#endif
+	}
+
+	void ksWSServer::flushSendQueues()
+	{
+		auto now{millis()};
+
+		for (uint8_t num{0}; num < WEBSOCKETS_SERVER_CLIENT_MAX; ++num)
+		{
+			auto& queue{sendQueues[num]};
+			if (queue.messages.empty())
+				continue;
+
+			auto client{&_clients[num]};
+			if (!clientIsConnected(client))
+			{
+				clearSendQueue(num);
+				continue;
+			}
+
+			/* Each frame is cut to the free space, so the write never waits for the client. */
+			while (!queue.messages.empty())
+			{
+				auto space{getWriteSpace(client)};
+				if (space <= WEBSOCKETS_MAX_HEADER_SIZE)
+					break;
+
+				auto& [message, isBinary]{queue.messages.front()};
+				auto remaining{message.size() - queue.sentBytes};
+				auto length{std::min(remaining, space - WEBSOCKETS_MAX_HEADER_SIZE)};
+				auto isFinal{length == remaining};
+				auto opcode{queue.sentBytes != 0 ? WSop_continuation : isBinary ? WSop_binary : WSop_text};
+
+				if (!sendFrame(client, opcode, reinterpret_cast<uint8_t*>(message.data()) + queue.sentBytes, length, isFinal))
+					break;
+
+				queue.lastProgressTime = now;
+				if (!isFinal)
+				{
+					queue.sentBytes += length;
+					continue;
+				}
+
+				queue.queuedBytes -= message.size();
+				queue.messages.pop_front();
+				queue.sentBytes = 0;
+			}
+
+			/* Client that doesn't read anything would keep its queue full forever. Close frame would block, so it's not sent. */
+			if (!queue.messages.empty() && now - queue.lastProgressTime > KSF_WS_SEND_STALL_TIMEOUT_MS)
+			{
+				clientDisconnect(client);
+				clearSendQueue(num);
+			}
+		}
+	}
+
+	bool ksWSServer::finishPartialMessage(uint8_t num)
+	{
+		auto& queue{sendQueues[num]};
+		if (queue.sentBytes == 0)
+			return true;
+
+		auto& message{queue.messages.front().data};
+		if (!sendFrame(&_clients[num], WSop_continuation, reinterpret_cast<uint8_t*>(message.data()) + queue.sentBytes, message.size() - queue.sentBytes))
+			return false;
+
+		queue.queuedBytes -= message.size();
+		queue.messages.pop_front();
+		queue.sentBytes = 0;
+		queue.lastProgressTime = millis();
+		return true;
+	}
+
+	void ksWSServer::clearSendQueue(uint8_t num)
+	{
+		if (num < WEBSOCKETS_SERVER_CLIENT_MAX)
+			sendQueues[num] = {};
+	}
+
+	bool ksWSServer::queueMessage(uint8_t num, std::string message, bool isBinary)
+	{
+		if (num >= WEBSOCKETS_SERVER_CLIENT_MAX || !clientIsConnected(&_clients[num]))
+			return false;
+
+		auto& queue{sendQueues[num]};
+		if (queue.messages.empty())
+			queue.lastProgressTime = millis();
+
+		/* 
+			Oldest messages make room for the new one. Message bigger than the whole queue is queued alone.
+			Partially sent message stays, the client already got its beginning.
+		*/
+		auto firstToDrop{queue.messages.begin()};
+		if (queue.sentBytes != 0)
+			++firstToDrop;
+
+		while (firstToDrop != queue.messages.end() && queue.queuedBytes + message.size() > KSF_WS_SEND_QUEUE_SIZE)
+		{
+			queue.queuedBytes -= firstToDrop->data.size();
+			firstToDrop = queue.messages.erase(firstToDrop);
+			++queue.droppedMessages;
+		}
+
+		queue.queuedBytes += message.size();
+		queue.messages.push_back({std::move(message), isBinary});
+		return true;
+	}
+
+	void ksWSServer::queueBroadcastTXT(const std::string& message)
+	{
+		for (uint8_t num{0}; num < WEBSOCKETS_SERVER_CLIENT_MAX; ++num)
+			queueTXT(num, message);
+	}
+
+	std::size_t ksWSServer::getSendQueueDepth(uint8_t num) const
+	{
+		return num < WEBSOCKETS_SERVER_CLIENT_MAX ? sendQueues[num].messages.size() : 0;
+	}
+
+	uint32_t ksWSServer::getDroppedMessages(uint8_t num) const
+	{
+		return num < WEBSOCKETS_SERVER_CLIENT_MAX ? sendQueues[num].droppedMessages : 0;
 	}
 
 	void ksWSServer::setMessageHandler(ksWsServerMessageFunc_t func)
@@ -78,6 +238,22 @@ namespace ksf::misc
 		onWebsocketTextMessage = std::move(func);
 	}
 
+	bool ksWSServer::sendTXTFragment(uint8_t num, uint8_t* payload, size_t length, bool isFirst, bool isFinal, bool headerToPayload)
+	{
+		if (num >= WEBSOCKETS_SERVER_CLIENT_MAX)
+			return false;
+
+		auto client{&_clients[num]};
+		if (!clientIsConnected(client))
+			return false;
+
+		/* Data frames of two messages can't be interleaved. */
+		if (isFirst && !finishPartialMessage(num))
+			return false;
+
+		return sendFrame(client, isFirst ? WSop_text : WSop_continuation, payload, length, isFinal, headerToPayload);
+	}
+
 	uint64_t ksWSServer::getRequiredAuthToken() const 
 	{ 
 		return requiredAuthToken; 
@@ -9,7 +9,10 @@
 
 #pragma once
 
+#include <list>
+#include <array>
 #include <memory>
+#include <string>
 #include <cstdint>
 #include <functional>
 #include <string_view>
@@ -26,13 +29,43 @@ namespace ksf::misc
 
 	/*!
 		@brief A wrapper around WebSocketsServerCore that adds WebSocket authentication and enhanced message handling.
+
+		Besides direct (blocking) sends of the core, messages can be queued. Each client has its own queue of
+		KSF_WS_SEND_QUEUE_SIZE bytes, drained from the loop. A queued message is written in frames no bigger than
+		the free space of the socket (a message that doesn't fit is fragmented), so a slow client doesn't block
+		the application. ESP8266 reports the free space directly. On ESP32 the socket is only polled for writability,
+		which lwIP reports above its low-water mark (more than two segments free), so a single smallest segment
+		(536 bytes) is written at a time. When the queue is full, the oldest messages are dropped (never the one
+		being sent). A client that doesn't take anything from its queue for KSF_WS_SEND_STALL_TIMEOUT_MS is disconnected.
 	*/
 	class ksWSServer : public WebSocketsServerCore 
 	{
 		protected:
+			/*!
+				@brief Queued outgoing message.
+			*/
+			struct QueuedMessage
+			{
+				std::string data;												//!< Message payload.
+				bool isBinary{false};												//!< True if the message is sent as a binary frame.
+			};
+
+			/*!
+				@brief Outgoing message queue of a client.
+			*/
+			struct SendQueue
+			{
+				std::list<QueuedMessage> messages;								//!< Queued messages, the oldest first.
+				std::size_t queuedBytes{0};										//!< Total size of queued messages.
+				std::size_t sentBytes{0};										//!< Bytes of the first message already sent as fragments.
+				uint32_t droppedMessages{0};									//!< Number of messages dropped due to full queue.
+				uint32_t lastProgressTime{0};									//!< Time of last send or first queued message (millis).
+			};
+
 			std::unique_ptr<WEBSOCKETS_NETWORK_SERVER_CLASS> wsListener;		//!< WS server (listener).
 			uint64_t requiredAuthToken{0};										//!< WS auth token.
 			ksWsServerMessageFunc_t onWebsocketTextMessage;						//!< Callback function to receive messages.
+			std::array<SendQueue, WEBSOCKETS_SERVER_CLIENT_MAX> sendQueues;		//!< Send queues of the clients.
 
 			/*!
 				@brief Handler for non-WebSocket connections on websocket port.
@@ -40,6 +73,40 @@ namespace ksf::misc
 			*/
 			void handleNonWebsocketConnection(WSclient_t* client) override;
 
+			/*!
+				@brief Retrieves the number of bytes the client socket takes without blocking.
+				@param client Pointer to the WSclient_t object.
+				@return Number of bytes that can be written now (frame header included).
+			*/
+			static std::size_t getWriteSpace(WSclient_t* client);
+
+			/*!
+				@brief Sends the rest of a partially sent queued message, so another message can be started.
+				@param num Websocket client number.
+				@return True on success (or if there was nothing to finish), otherwise false.
+			*/
+			bool finishPartialMessage(uint8_t num);
+
+			/*!
+				@brief Sends queued messages that fit into the socket buffers and disconnects stalled clients.
+			*/
+			void flushSendQueues();
+
+			/*!
+				@brief Removes all queued messages of the client.
+				@param num Websocket client number.
+			*/
+			void clearSendQueue(uint8_t num);
+
+			/*!
+				@brief Queues a message for the client, dropping the oldest messages if the queue is full.
+				@param num Websocket client number.
+				@param message Message to be sent.
+				@param isBinary True to send the message as a binary frame, false for text frame.
+				@return True if the message has been queued, false if the client is not connected.
+			*/
+			bool queueMessage(uint8_t num, std::string message, bool isBinary);
+
 		public:
 			/*!
 				@brief Prepares ksWebServer on specified port without actually starting it.
@@ -85,6 +152,62 @@ namespace ksf::misc
 			*/
 			void loop();
 
+			/*!
+				@brief Sends a part of a fragmented text message.
+
+				The first fragment is sent as a text frame, the following ones as continuation frames. The message
+				is complete when a fragment with isFinal set is sent. Fragments of different messages must not be
+				interleaved for the same client. If a queued message is partially sent, its rest is sent before the
+				first fragment. The fragment is written directly, so the call blocks until the socket takes it
+				(bounded by the client timeout).
+
+				@param num Websocket client number.
+				@param payload Fragment data. If headerToPayload is set, the data starts WEBSOCKETS_MAX_HEADER_SIZE bytes
+					after this pointer and the space in front is used to build the frame header, avoiding a copy.
+				@param length Length of the fragment data.
+				@param isFirst True if this is the first fragment of the message.
+				@param isFinal True if this is the last fragment of the message.
+				@param headerToPayload True if the payload has space reserved for the frame header.
+				@return True on success, false if the client is not connected or the write failed.
+			*/
+			bool sendTXTFragment(uint8_t num, uint8_t* payload, size_t length, bool isFirst, bool isFinal, bool headerToPayload = false);
+
+			/*!
+				@brief Queues a text message for the client. Never blocks, the message is sent from the loop.
+				@param num Websocket client number.
+				@param message Message to be sent.
+				@return True if the message has been queued, false if the client is not connected.
+			*/
+			bool queueTXT(uint8_t num, std::string message) { return queueMessage(num, std::move(message), false); }
+
+			/*!
+				@brief Queues a binary message for the client. Never blocks, the message is sent from the loop.
+				@param num Websocket client number.
+				@param message Message to be sent.
+				@return True if the message has been queued, false if the client is not connected.
+			*/
+			bool queueBIN(uint8_t num, std::string message) { return queueMessage(num, std::move(message), true); }
+
+			/*!
+				@brief Queues a text message for all connected clients.
+				@param message Message to be sent.
+			*/
+			void queueBroadcastTXT(const std::string& message);
+
+			/*!
+				@brief Retrieves the number of messages waiting in the client queue.
+				@param num Websocket client number.
+				@return Number of queued messages.
+			*/
+			std::size_t getSendQueueDepth(uint8_t num) const;
+
+			/*!
+				@brief Retrieves the number of messages dropped from the client queue, because it was full.
+				@param num Websocket client number.
+				@return Number of dropped messages since the client connected.
+			*/
+			uint32_t getDroppedMessages(uint8_t num) const;
+
 			/*!
 				@brief Installs a message handler to receive WebSocket text messages.
 				@param func The message handler function.
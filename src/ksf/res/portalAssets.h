@@ -0,0 +1,56 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <pgmspace.h>
+
+#include "otaWebpage.h"
+
+namespace ksf::res
+{
+	/*!
+		@brief Describes a single static asset of the Device Portal frontend.
+
+		All the data is stored in flash and the content is gzip-compressed. The entry point (shell) is served
+		under a fixed path and references other assets, which are loaded on demand. Paths of other assets
+		contain their content hash, so they never change and can be cached by the browser forever.
+	*/
+	struct ksPortalAsset
+	{
+		const char* path;				//!< URL path (PROGMEM string).
+		const char* contentType;		//!< MIME type (PROGMEM string).
+		const uint8_t* data;			//!< Gzip-compressed content (PROGMEM).
+		uint32_t size;					//!< Size of the compressed content.
+		const char* hash;				//!< Content hash used as ETag (PROGMEM string).
+		bool isEntryPoint;				//!< True for the shell page, which has a fixed path and sets the WebSocket cookie.
+	};
+
+	static constexpr char PORTAL_ASSET_INDEX_PATH[] PROGMEM {"/"};
+	static constexpr char PORTAL_ASSET_TEXT_HTML[] PROGMEM {"text/html"};
+
+	/*!
+		@brief Table of Device Portal frontend assets.
+
+		The frontend generator outputs each asset into the resources as a PROGMEM array with its size and hash,
+		then lists it here. Currently the frontend is a single page bundle, so the table contains only the shell.
+	*/
+	static constexpr ksPortalAsset PORTAL_ASSETS[]
+	{
+		{PORTAL_ASSET_INDEX_PATH, PORTAL_ASSET_TEXT_HTML, DEVICE_FRONTEND_HTML, DEVICE_FRONTEND_HTML_SIZE, DEVICE_FRONTEND_HTML_MD5, true}
+	};
+
+	/*!
+		Hash of the whole frontend (all assets). Changes whenever any asset changes, so it's used as ETag
+		of the shell page and to invalidate WebSocket auth tokens of previous frontend versions.
+		With a single asset it's equal to the hash of that asset.
+	*/
+	static constexpr const char* PORTAL_MANIFEST_HASH{DEVICE_FRONTEND_HTML_MD5};
+}
@@ -0,0 +1,157 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+// Sources: misc/ksCborWriter.cpp misc/ksCborReader.cpp misc/ksStatWriter.cpp ksConstants.cpp
+
+#include <Arduino.h>
+#include <cstdlib>
+#include <string>
+#include "ksTest.h"
+#include "misc/ksCborReader.h"
+#include "misc/ksCborWriter.h"
+#include "misc/ksStatWriter.h"
+
+using ksf::misc::ksCborReader;
+using ksf::misc::ksCborWriter;
+using ksf::misc::ksCompactStatWriter;
+
+/*
+	CBOR payloads against the text path for a typical device status report and an incoming command.
+	"Text, per value" is how telemetry used to be built: a string per value from std::to_string / dtostrf.
+	On the host dtostrf is backed by snprintf, the device implementation is slower.
+*/
+
+struct ksTelemetrySample
+{
+	int64_t rssi;
+	uint64_t uptimeSec;
+	uint64_t freeHeap;
+	double temperature;
+	uint64_t bytesIn;
+	uint64_t bytesOut;
+	uint64_t reconnects;
+};
+
+static ksTelemetrySample makeSample(uint32_t i)
+{
+	return {-40 - static_cast<int64_t>(i % 50), 86400 + i, 180000 - i % 4096, 21.0 + (i % 1000) * 0.01, 1000000 + i * 37, 250000 + i * 11, i % 7};
+}
+
+static std::string legacyToString(double value, int decimals)
+{
+	char buffer[33];
+	return dtostrf(value, decimals + 2, decimals, buffer);
+}
+
+static std::size_t buildLegacyText(const ksTelemetrySample& sample, std::string& out)
+{
+	out.clear();
+	out += "{\"rssi\":" + std::to_string(sample.rssi);
+	out += ",\"uptime\":" + std::to_string(sample.uptimeSec);
+	out += ",\"heap\":" + std::to_string(sample.freeHeap);
+	out += ",\"temp\":" + legacyToString(sample.temperature, 2);
+	out += ",\"mqtt\":{\"bytesIn\":" + std::to_string(sample.bytesIn);
+	out += ",\"bytesOut\":" + std::to_string(sample.bytesOut);
+	out += ",\"reconnects\":" + std::to_string(sample.reconnects);
+	out += "},\"fw\":\"1.0.54\"}";
+	return out.size();
+}
+
+static std::size_t buildCompact(ksCompactStatWriter& writer, const ksTelemetrySample& sample)
+{
+	writer.begin();
+	writer.addInt("rssi", sample.rssi);
+	writer.addUnsigned("uptime", sample.uptimeSec);
+	writer.addUnsigned("heap", sample.freeHeap);
+	writer.addFloat("temp", sample.temperature, 2);
+	writer.beginGroup("mqtt");
+	writer.addUnsigned("bytesIn", sample.bytesIn);
+	writer.addUnsigned("bytesOut", sample.bytesOut);
+	writer.addUnsigned("reconnects", sample.reconnects);
+	writer.endGroup();
+	writer.addString("fw", "1.0.54");
+	writer.end();
+	return writer.getDocument().size();
+}
+
+KSF_TEST(encodeStatusReport)
+{
+	constexpr uint32_t ITERATIONS{500000};
+	uint8_t buffer[256];
+	std::string text;
+	std::size_t legacySize{0}, jsonSize{0}, cborSize{0};
+
+	ksf::test::measure("encode report: text, per value (legacy)", ITERATIONS, [&](uint32_t i) {
+		legacySize = buildLegacyText(makeSample(i), text);
+		ksf::test::keep(text);
+	});
+
+	ksCompactStatWriter jsonWriter{ksCompactStatWriter::Format::Json, buffer, sizeof(buffer)};
+	ksf::test::measure("encode report: JSON, compact writer", ITERATIONS, [&](uint32_t i) {
+		jsonSize = buildCompact(jsonWriter, makeSample(i));
+		ksf::test::keep(buffer);
+	});
+
+	ksCompactStatWriter cborWriter{ksCompactStatWriter::Format::Cbor, buffer, sizeof(buffer)};
+	ksf::test::measure("encode report: CBOR, compact writer", ITERATIONS, [&](uint32_t i) {
+		cborSize = buildCompact(cborWriter, makeSample(i));
+		ksf::test::keep(buffer);
+	});
+
+	std::printf("  report size: legacy text %zu B, JSON %zu B, CBOR %zu B\n", legacySize, jsonSize, cborSize);
+	KSF_CHECK(cborSize < jsonSize);
+}
+
+KSF_TEST(decodeCommand)
+{
+	constexpr uint32_t ITERATIONS{1000000};
+	const std::string_view textCommand{R"({"led":1,"brightness":0.75,"mode":"blink"})"};
+
+	uint8_t cborCommand[64];
+	ksCborWriter writer{cborCommand, sizeof(cborCommand)};
+	writer.beginMap(3);
+	writer.writeText("led");
+	writer.writeUnsigned(1);
+	writer.writeText("brightness");
+	writer.writeFloat(0.75f);
+	writer.writeText("mode");
+	writer.writeText("blink");
+	KSF_REQUIRE(!writer.hasOverflow());
+
+	double brightnessSum{0};
+
+	/* Text command, the way handlers parse it without a JSON library: find the key, then strtod. */
+	ksf::test::measure("decode command: text (find + strtod)", ITERATIONS, [&](uint32_t) {
+		std::string payload{textCommand};
+		auto position{payload.find("\"brightness\":")};
+		brightnessSum += std::strtod(payload.c_str() + position + 13, nullptr);
+	});
+
+	ksf::test::measure("decode command: CBOR reader", ITERATIONS, [&](uint32_t) {
+		ksCborReader reader{cborCommand, writer.getLength()};
+		uint64_t count{0};
+		reader.readMap(count);
+		for (uint64_t i{0}; i < count; ++i)
+		{
+			std::string_view key;
+			reader.readText(key);
+			if (key == "brightness")
+			{
+				double value{0};
+				reader.readFloat(value);
+				brightnessSum += value;
+			}
+			else
+				reader.skip();
+		}
+	});
+
+	std::printf("  command size: text %zu B, CBOR %zu B\n", textCommand.size(), writer.getLength());
+	KSF_CHECK(brightnessSum == 0.75 * 2 * ITERATIONS);
+}
@@ -0,0 +1,68 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+// Sources: misc/ksFlashContent.cpp
+
+#include <vector>
+#include "ksTest.h"
+#include "misc/ksFlashContent.h"
+
+/*
+	Throughput of flash content streaming (portal assets). The socket stand-in copies accepted bytes into a buffer
+	of its own, like the TCP stack does, and accepts at most the configured number of bytes per write, so short
+	writes of a congested socket are part of the measurement. On the host this shows the cost of the write loop
+	(chunking, retries after short writes) - on the device the radio is the limit, not the loop.
+*/
+
+struct ksSocketStandIn
+{
+	std::vector<uint8_t> sendBuffer;	//!< Bytes copied by the last write.
+	size_t acceptLimit{SIZE_MAX};		//!< Maximum number of bytes accepted by a single write.
+	size_t totalWritten{0};				//!< Number of bytes accepted so far.
+	uint32_t writeCalls{0};				//!< Number of write calls.
+
+	uint8_t connected() { return 1; }
+
+	size_t write(const uint8_t* data, size_t length)
+	{
+		auto accepted{std::min(length, acceptLimit)};
+		sendBuffer.assign(data, data + accepted);
+		totalWritten += accepted;
+		++writeCalls;
+		return accepted;
+	}
+};
+
+KSF_TEST(flashContentThroughput)
+{
+	constexpr uint32_t STREAMS{200};
+	std::vector<uint8_t> asset(64 * 1024);
+	for (size_t i{0}; i < asset.size(); ++i)
+		asset[i] = static_cast<uint8_t>(i * 31);
+
+	for (size_t acceptLimit : {SIZE_MAX, size_t{1460}, size_t{536}, size_t{128}})
+	{
+		ksSocketStandIn socket;
+		socket.acceptLimit = acceptLimit;
+
+		char label[64];
+		if (acceptLimit == SIZE_MAX)
+			snprintf(label, sizeof(label), "64 KB asset, whole chunks accepted");
+		else
+			snprintf(label, sizeof(label), "64 KB asset, up to %u B accepted per write", static_cast<unsigned>(acceptLimit));
+
+		auto nsPerStream{ksf::test::measure(label, STREAMS, [&](uint32_t) {
+			ksf::test::keep(ksf::misc::writeFlashContent(socket, asset.data(), asset.size()));
+		})};
+
+		std::printf("  %-52s %10.1f MB/s %9u writes/stream\n", "", asset.size() * 1e3 / nsPerStream,
+			socket.writeCalls / STREAMS);
+		KSF_CHECK(socket.totalWritten == asset.size() * STREAMS);
+	}
+}
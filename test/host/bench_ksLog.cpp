@@ -0,0 +1,97 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+// Sources: ksLog.cpp misc/ksLogRing.cpp
+
+#include <functional>
+#include "ksTest.h"
+#include "ksApplication.h"
+#include "misc/ksLogRing.h"
+
+/*
+	Cost of a log call at the publish site of ksMqttConnector. Per-message lines are logged at trace level, which is above
+	the default KSF_LOG_LEVEL, so by default they are compiled out. The same line at debug level shows the cost when it's
+	compiled in: written into the log ring (nobody reads it), then skipped with setLogLevel(KSF_LOG_LEVEL_NONE), which is
+	the state with no sink attached. The std::function variant is the logging it replaced - it built the line even with
+	nobody listening. On the host vsnprintf costs more than heap appends, on the device the allocations dominate.
+*/
+
+namespace ksf
+{
+	/* Link seam, the application (and the rest of the framework it pulls in) is not needed to log. */
+	misc::ksLogRing& ksApplication::getLogRing()
+	{
+		static misc::ksLogRing logRing(KSF_LOG_RING_SIZE);
+		return logRing;
+	}
+}
+
+namespace legacy
+{
+	static void log(const std::function<void(std::string&)>& logFunction)
+	{
+		std::string line;
+		logFunction(line);
+		ksf::ksApplication::getLogRing().write(line);
+	}
+}
+
+static uint32_t evaluatedArguments{0};
+
+static const char* countedArgument(const char* value)
+{
+	++evaluatedArguments;
+	return value;
+}
+
+KSF_TEST(logOverhead)
+{
+	constexpr uint32_t ITERATIONS{1000000};
+	std::string prefix{"device/"}, topic{"sensors/temperature"}, payload{"21.5"};
+	bool retain{false};
+	auto& logRing{ksf::ksApplication::getLogRing()};
+
+	ksf::test::measure("std::function + std::string into ring (legacy)", ITERATIONS, [&](uint32_t) {
+		legacy::log([&](std::string& out) {
+			out += "[ MqttConnector ] ";
+			if (retain)
+				out += "(Retained) ";
+			out += "Publish to: ";
+			out += prefix;
+			out += topic;
+			out += ", value: ";
+			out += payload;
+		});
+	});
+
+	ksf::setLogLevel(KSF_LOG_LEVEL_DEBUG);
+	auto sequenceBefore{logRing.end().sequence};
+	ksf::test::measure("KSF_LOG_DEBUG formatted into ring", ITERATIONS, [&](uint32_t) {
+		KSF_LOG_DEBUG("[ MqttConnector ] %sPublish to: %s%s, value: %s", retain ? "(Retained) " : "",
+			prefix.c_str(), topic.c_str(), payload.c_str());
+	});
+	KSF_CHECK(logRing.end().sequence - sequenceBefore == ITERATIONS);
+
+	ksf::setLogLevel(KSF_LOG_LEVEL_NONE);
+	sequenceBefore = logRing.end().sequence;
+	ksf::test::measure("KSF_LOG_DEBUG, no sink attached (level NONE)", ITERATIONS, [&](uint32_t) {
+		KSF_LOG_DEBUG("[ MqttConnector ] %sPublish to: %s%s, value: %s", retain ? "(Retained) " : "",
+			countedArgument(prefix.c_str()), topic.c_str(), payload.c_str());
+	});
+	KSF_CHECK(logRing.end().sequence == sequenceBefore);
+	KSF_CHECK(evaluatedArguments == 0);
+
+	ksf::setLogLevel(KSF_LOG_LEVEL_DEBUG);
+	ksf::test::measure("KSF_LOG_TRACE, compiled out (default)", ITERATIONS, [&](uint32_t) {
+		KSF_LOG_TRACE("[ MqttConnector ] %sPublish to: %s%s, value: %s", retain ? "(Retained) " : "",
+			countedArgument(prefix.c_str()), topic.c_str(), payload.c_str());
+	});
+	KSF_CHECK(logRing.end().sequence == sequenceBefore);
+	KSF_CHECK(evaluatedArguments == 0);
+}
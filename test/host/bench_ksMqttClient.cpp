@@ -0,0 +1,75 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+// Sources: misc/ksMqttClient.cpp
+
+#include "ksTest.h"
+#include "ksStandInBroker.h"
+#include "misc/ksMqttClient.h"
+
+using ksf::misc::ksMqttClient;
+using ksf::test::ksStandInBroker;
+
+/*
+	Message rate of the client against the stand-in broker. The broker answers in the same call, so the numbers
+	show the cost of the client (framing, parsing, in-flight tracking) without any network latency.
+*/
+
+KSF_TEST(publishRate)
+{
+	constexpr uint32_t MESSAGES{200000};
+	std::string payload(64, 'p');
+
+	for (uint8_t qos{0}; qos <= 2; ++qos)
+	{
+		ksStandInBroker broker;
+		broker.recordPublishes = false;
+		ksMqttClient client{broker, 512, 128, 8};
+		broker.connect("broker", 1883);
+		KSF_REQUIRE(client.connect("bench", {}, {}, {}, 0, false, {}, true, 1000));
+
+		char label[64];
+		snprintf(label, sizeof(label), "publish 64 B, QoS %u", qos);
+		ksf::test::measure(label, MESSAGES, [&](uint32_t) {
+			client.publish("device/bench/", "value", payload, false, qos);
+			if (qos > 0)
+			{
+				client.loop();
+				client.loop();
+			}
+		});
+		KSF_CHECK(broker.publishesReceived == MESSAGES);
+	}
+}
+
+KSF_TEST(receiveRate)
+{
+	constexpr uint32_t MESSAGES{200000}, BATCH{100};
+
+	for (std::size_t chunkSize : {SIZE_MAX, std::size_t{64}})
+	{
+		ksStandInBroker broker;
+		broker.readChunkSize = chunkSize;
+		ksMqttClient client{broker, 512, 128, 8};
+		uint32_t received{0};
+		client.setCallback([&received](std::string_view, std::string_view payload) { received += payload.size() > 0; });
+		broker.connect("broker", 1883);
+		KSF_REQUIRE(client.connect("bench", {}, {}, {}, 0, false, {}, true, 1000));
+
+		std::string payload(64, 'r');
+		auto label{chunkSize == SIZE_MAX ? "receive 64 B, whole packets" : "receive 64 B, 64 B socket reads"};
+		ksf::test::measure(label, MESSAGES / BATCH, [&](uint32_t) {
+			for (uint32_t i{0}; i < BATCH; ++i)
+				broker.publishToClient("device/bench/cmd", payload);
+			while (broker.pendingToClient() > 0)
+				client.loop();
+		}, BATCH);
+		KSF_CHECK(received == MESSAGES);
+	}
+}
@@ -0,0 +1,49 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+// Sources: comp/ksMqttOtaUpdater.cpp misc/ksMqttClient.cpp misc/ksOtaWriter.cpp misc/ksHeatshrinkDecoder.cpp misc/ksDeltaPatcher.cpp misc/ksSha256.cpp misc/ksReconnectPolicy.cpp misc/ksSimpleTimer.cpp ksComponent.cpp ksConstants.cpp evt/ksEventHandle.cpp
+
+#include <Update.h>
+#include "ksTest.h"
+#include "ksOtaServerStandIn.h"
+
+using ksf::test::connectorBroker;
+using ksf::test::ksOtaSetup;
+
+/*
+	Throughput of a whole MQTT update: MQTT framing on both sides, chunk CRC, windowed requests and block writes
+	to the Update stand-in. The broker stand-in answers in the same call, so there is no network latency - on the
+	device the link and the flash set the limit, this shows how much the protocol handling costs on top of them.
+*/
+
+KSF_TEST(updateThroughput)
+{
+	constexpr std::size_t IMAGE_SIZE{1024 * 1024};
+	constexpr uint32_t UPDATES{5};
+
+	for (std::size_t readChunkSize : {SIZE_MAX, std::size_t{536}})
+	{
+		uint64_t bytesSent{0};
+		bool allPassed{true};
+
+		auto label{readChunkSize == SIZE_MAX ? "1 MB update, whole packets" : "1 MB update, 536 B socket reads"};
+		auto nsPerUpdate{ksf::test::measure(label, UPDATES, [&](uint32_t) {
+			ksOtaSetup setup{"top secret", IMAGE_SIZE};
+			connectorBroker.readChunkSize = readChunkSize;
+			setup.server.control("nonce");
+			setup.run(10000000);
+			allPassed &= setup.server.result == "ok" && Update.image.size() == IMAGE_SIZE;
+			bytesSent += setup.server.bytesSent;
+		})};
+
+		std::printf("  %-52s %10.0f KB/s %9.0f KB sent/update\n", "", IMAGE_SIZE / 1024.0 / (nsPerUpdate / 1e9),
+			bytesSent / 1024.0 / UPDATES);
+		KSF_CHECK(allPassed);
+	}
+}
@@ -0,0 +1,134 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+// Sources: ksConstants.cpp
+
+#include <cmath>
+#include "ksTest.h"
+#include "ksConstants.h"
+
+/*
+	Number formatting and JSON escaping against the functions they replaced.
+	On the host dtostrf is backed by snprintf, the device implementation is slower.
+*/
+
+namespace legacy
+{
+	static std::string to_string(double value, int base)
+	{
+		char buffer[33];
+		return dtostrf(value, base + 2, base, buffer);
+	}
+
+	static std::string json_escape(const std::string& input)
+	{
+		std::string output;
+		output.reserve(input.size() * 6 / 5);
+		for (auto ch : input)
+		{
+			switch (ch)
+			{
+				case '"': output.append("\\\"", 2); break;
+				case '\\': output.append("\\\\", 2); break;
+				case '\b': output.append("\\b", 2); break;
+				case '\f': output.append("\\f", 2); break;
+				case '\n': output.append("\\n", 2); break;
+				case '\r': output.append("\\r", 2); break;
+				case '\t': output.append("\\t", 2); break;
+				default:
+					if (static_cast<unsigned char>(ch) < 0x20)
+					{
+						unsigned int val{static_cast<unsigned char>(ch)};
+						const char hex[]{"0123456789abcdef"};
+						output += '\\';
+						output += 'u';
+						output += hex[(val >> 12) & 0xF];
+						output += hex[(val >> 8) & 0xF];
+						output += hex[(val >> 4) & 0xF];
+						output += hex[val & 0xF];
+					}
+					else output += ch;
+				break;
+			}
+		}
+		return output;
+	}
+}
+
+static double sampleDouble(uint32_t i)
+{
+	return (static_cast<int32_t>(i * 2654435761u) >> 8) / 1000.0;
+}
+
+KSF_TEST(sameOutputAsLegacy)
+{
+	for (uint32_t i{0}; i < 100000; ++i)
+	{
+		/* Ties are rounded away from zero, printf rounds them to even, so the last digit may differ by one. */
+		auto value{sampleDouble(i)};
+		auto difference{std::strtod(ksf::to_string(value, 2).c_str(), nullptr) - std::strtod(legacy::to_string(value, 2).c_str(), nullptr)};
+		KSF_REQUIRE(std::fabs(difference) < 0.0101);
+		KSF_REQUIRE(ksf::to_string(static_cast<int32_t>(i * 2654435761u)) == std::to_string(static_cast<int32_t>(i * 2654435761u)));
+	}
+	KSF_CHECK(ksf::to_string(UINT64_MAX) == std::to_string(UINT64_MAX));
+	KSF_CHECK(ksf::to_string(INT64_MIN) == std::to_string(INT64_MIN));
+
+	std::string text{"plain text \"quoted\" \\ \n\t\x01 end"};
+	KSF_CHECK(ksf::json_escape(text) == legacy::json_escape(text));
+}
+
+KSF_TEST(formatDouble)
+{
+	constexpr uint32_t ITERATIONS{2000000};
+	ksf::test::measure("double, 2 decimals: dtostrf + std::string (legacy)", ITERATIONS, [](uint32_t i) {
+		ksf::test::keep(legacy::to_string(sampleDouble(i), 2));
+	});
+	ksf::test::measure("double, 2 decimals: ksf::to_string", ITERATIONS, [](uint32_t i) {
+		ksf::test::keep(ksf::to_string(sampleDouble(i), 2));
+	});
+
+	std::string out;
+	ksf::test::measure("double, 2 decimals: ksf::append_to_string", ITERATIONS, [&out](uint32_t i) {
+		out.clear();
+		ksf::append_to_string(out, sampleDouble(i), 2);
+		ksf::test::keep(out);
+	});
+}
+
+KSF_TEST(formatInteger)
+{
+	constexpr uint32_t ITERATIONS{5000000};
+	ksf::test::measure("int32: std::to_string (legacy)", ITERATIONS, [](uint32_t i) {
+		ksf::test::keep(std::to_string(static_cast<int32_t>(i * 2654435761u)));
+	});
+	ksf::test::measure("int32: ksf::to_string", ITERATIONS, [](uint32_t i) {
+		ksf::test::keep(ksf::to_string(static_cast<int32_t>(i * 2654435761u)));
+	});
+
+	char buffer[KSF_TO_CHARS_BUFFER_SIZE];
+	ksf::test::measure("uint64: std::to_string (legacy)", ITERATIONS, [](uint32_t i) {
+		ksf::test::keep(std::to_string(i * 0x9E3779B97F4A7C15ull));
+	});
+	ksf::test::measure("uint64: ksf::to_chars into caller buffer", ITERATIONS, [&buffer](uint32_t i) {
+		ksf::test::keep(ksf::to_chars(buffer, i * 0x9E3779B97F4A7C15ull));
+	});
+}
+
+KSF_TEST(escapeJson)
+{
+	constexpr uint32_t ITERATIONS{500000};
+	const std::string text{"Living room sensor \"north\" - C:\\data\\log.txt, status: ok, rssi -61 dBm\n"};
+
+	ksf::test::measure("JSON escape 72 B: switch per char (legacy)", ITERATIONS, [&text](uint32_t) {
+		ksf::test::keep(legacy::json_escape(text));
+	});
+	ksf::test::measure("JSON escape 72 B: ksf::json_escape", ITERATIONS, [&text](uint32_t) {
+		ksf::test::keep(ksf::json_escape(text));
+	});
+}
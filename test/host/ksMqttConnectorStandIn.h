@@ -0,0 +1,94 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include <WiFi.h>
+#include "ksStandInBroker.h"
+#include "comp/ksMqttConnector.h"
+#include "misc/ksCertUtils.h"
+#include "misc/ksMqttClient.h"
+
+/*
+	Link seam for components that talk through ksMqttConnector. A test includes this header instead of linking
+	comp/ksMqttConnector.cpp: the connector keeps its real interface and events, but the MQTT client is connected
+	to the stand-in broker (ksf::test::connectorBroker) instead of WiFi, and loop only pumps the client.
+	Include it in a single translation unit of the test.
+*/
+
+namespace ksf::test
+{
+	inline ksStandInBroker connectorBroker;			//!< Broker used by the connector stand-in.
+	inline const char* connectorPrefix{"device/"};	//!< Device prefix used by the connector stand-in.
+}
+
+namespace ksf::misc
+{
+	ksDomainQuery::ksDomainQuery() = default;
+	ksDomainQuery::~ksDomainQuery() = default;
+	ksCertFingerprint::~ksCertFingerprint() = default;
+}
+
+namespace ksf::comps
+{
+	ksMqttConnector::ksMqttConnector(bool sendConnectionStatus, bool usePersistentSession)
+		: reconnectPolicy(0, 0, 0, 0)
+	{
+		bitflags.sendConnectionStatus = sendConnectionStatus;
+		bitflags.usePersistentSession = usePersistentSession;
+		prefix = test::connectorPrefix;
+
+		/* Buffer sizes of a typical device configuration. */
+		mqttClientUq = std::make_unique<misc::ksMqttClient>(test::connectorBroker, 1024, 256, 16);
+		mqttClientUq->setCallback(std::bind(&ksMqttConnector::mqttMessageInternal, this, std::placeholders::_1, std::placeholders::_2));
+	}
+
+	ksMqttConnector::~ksMqttConnector() = default;
+
+	bool ksMqttConnector::init(ksApplication*) { return true; }
+
+	bool ksMqttConnector::postInit(ksApplication*) { return true; }
+
+	bool ksMqttConnector::loop(ksApplication*)
+	{
+		if (mqttClientUq->connected())
+			return mqttClientUq->loop();
+
+		test::connectorBroker.connect("broker", 1883);
+		if (mqttClientUq->connect("device", {}, {}, {}, 0, false, {}, true, 1000))
+			mqttConnectedInternal();
+		return true;
+	}
+
+	void ksMqttConnector::mqttConnectedInternal()
+	{
+		onConnected->broadcast();
+	}
+
+	void ksMqttConnector::mqttMessageInternal(std::string_view topic, std::string_view payload)
+	{
+		if (topic.substr(0, prefix.size()) == prefix)
+			onDeviceMessage->broadcast(topic.substr(prefix.size()), payload);
+	}
+
+	bool ksMqttConnector::isConnected() const
+	{
+		return mqttClientUq->connected();
+	}
+
+	void ksMqttConnector::subscribe(const std::string& topic, bool skipDevicePrefix, ksMqttConnector::QosLevel qos)
+	{
+		mqttClientUq->subscribe(skipDevicePrefix ? std::string_view{} : prefix, topic, static_cast<uint8_t>(qos));
+	}
+
+	bool ksMqttConnector::publish(const std::string& topic, const std::string& payload, bool retain, bool skipDevicePrefix, ksMqttConnector::QosLevel qos)
+	{
+		return mqttClientUq->publish(skipDevicePrefix ? std::string_view{} : prefix, topic, payload, retain, static_cast<uint8_t>(qos));
+	}
+}
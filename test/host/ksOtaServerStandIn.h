@@ -0,0 +1,187 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "ksConstants.h"
+#include "ksMqttConnectorStandIn.h"
+#include "comp/ksMqttOtaUpdater.h"
+#include "misc/ksSha256.h"
+
+namespace ksf::test
+{
+	/*!
+		@brief Update server counterpart of ksMqttOtaUpdater, same protocol as scripts/mqtt_ota.py.
+
+		Reads messages published by the device from the connector stand-in broker and answers through the broker:
+		signs begin command with the nonce, sends requested chunks and collects progress and the result.
+	*/
+	class ksOtaServerStandIn
+	{
+		protected:
+			std::size_t seenMessages{0};			//!< Number of broker messages already handled.
+
+			static std::string toHex(const uint8_t* data, std::size_t length)
+			{
+				static constexpr char HEX_DIGITS[]{"0123456789abcdef"};
+				std::string hex;
+				for (std::size_t i{0}; i < length; ++i)
+				{
+					hex += HEX_DIGITS[data[i] >> 4];
+					hex += HEX_DIGITS[data[i] & 0x0F];
+				}
+				return hex;
+			}
+
+			void sendChunks(uint32_t offset, uint32_t length, uint32_t chunkSize)
+			{
+				auto end{std::min<std::size_t>(offset + length, image.size())};
+				while (offset < end)
+				{
+					auto size{static_cast<uint32_t>(std::min<std::size_t>(chunkSize, end - offset))};
+					auto crc{ksf::crc32_update(reinterpret_cast<const uint8_t*>(image.data() + offset), size)};
+
+					std::string chunk;
+					for (auto value : {offset, crc})
+						for (uint8_t i{0}; i < 4; ++i)
+							chunk += static_cast<char>(value >> (i * 8));
+					chunk.append(image, offset, size);
+
+					connectorBroker.publishToClient(std::string(connectorPrefix) + "ota/chunk", chunk);
+					bytesSent += chunk.size();
+					offset += size;
+				}
+			}
+
+		public:
+			std::string image;						//!< File being sent.
+			std::string secret;						//!< Secret shared with the device.
+			std::string md5{std::string(32, '0')};	//!< MD5 sent in begin command.
+			std::string encoding{"raw"};			//!< Encoding sent in begin command.
+			std::string result;						//!< Last result reported by the device.
+			std::vector<std::string> progress;		//!< Progress reports.
+			std::string lastNonce;					//!< Last nonce published by the device.
+			uint64_t bytesSent{0};					//!< Number of chunk bytes sent.
+			bool autoBegin{true};					//!< True to answer nonce with signed begin command.
+
+			/*!
+				@brief Signs begin command arguments.
+				@param nonce Nonce published by the device.
+				@param args Arguments ("<size> <md5> <encoding>").
+				@return Hex HMAC.
+			*/
+			std::string sign(const std::string& nonce, const std::string& args) const
+			{
+				uint8_t digest[misc::ksSha256::DIGEST_SIZE];
+				misc::ksSha256::hmac(secret, nonce + ' ' + args, digest);
+				return toHex(digest, sizeof(digest));
+			}
+
+			/*!
+				@brief Publishes a control command to the device.
+				@param command Command text.
+			*/
+			void control(const std::string& command)
+			{
+				connectorBroker.publishToClient(std::string(connectorPrefix) + "ota/ctl", command);
+			}
+
+			/*!
+				@brief Handles messages published by the device since the last call.
+			*/
+			void serve()
+			{
+				std::string prefix{connectorPrefix};
+				for (; seenMessages < connectorBroker.published.size(); ++seenMessages)
+				{
+					const auto& message{connectorBroker.published[seenMessages]};
+					auto topic{message.topic.substr(prefix.size())};
+
+					if (topic == "ota/nonce")
+					{
+						lastNonce = message.payload;
+						if (autoBegin)
+						{
+							auto args{std::to_string(image.size()) + ' ' + md5 + ' ' + encoding};
+							control("begin " + args + ' ' + sign(lastNonce, args));
+						}
+					}
+					else if (topic == "ota/req")
+					{
+						char* cursor{const_cast<char*>(message.payload.c_str())};
+						auto offset{strtoul(cursor, &cursor, 10)};
+						auto length{strtoul(cursor, &cursor, 10)};
+						auto chunkSize{strtoul(cursor, &cursor, 10)};
+						sendChunks(offset, length, chunkSize);
+					}
+					else if (topic == "ota/progress")
+						progress.push_back(message.payload);
+					else if (topic == "ota/result")
+						result = message.payload;
+				}
+			}
+	};
+
+	/*!
+		@brief Updater bound to the connector stand-in without the application (does what postInit does).
+	*/
+	class ksTestOtaUpdater : public comps::ksMqttOtaUpdater
+	{
+		public:
+			using comps::ksMqttOtaUpdater::ksMqttOtaUpdater;
+
+			void attach(const std::shared_ptr<comps::ksMqttConnector>& connector)
+			{
+				mqttConnWp = connector;
+				connector->onConnected->registerEvent(connEventHandle, std::bind(&ksTestOtaUpdater::onConnected, this));
+				connector->onDeviceMessage->registerEvent(msgEventHandle, std::bind(&ksTestOtaUpdater::onDeviceMessage, this, std::placeholders::_1, std::placeholders::_2));
+			}
+	};
+
+	/*!
+		@brief Connected device with the updater and the update server.
+	*/
+	struct ksOtaSetup
+	{
+		std::shared_ptr<comps::ksMqttConnector> connector;
+		std::shared_ptr<ksTestOtaUpdater> updater;
+		ksOtaServerStandIn server;
+
+		explicit ksOtaSetup(const std::string& deviceSecret, std::size_t imageSize = 64 * 1024)
+		{
+			connectorBroker.clear();
+			connector = std::make_shared<comps::ksMqttConnector>();
+			updater = std::make_shared<ksTestOtaUpdater>(deviceSecret);
+			updater->attach(connector);
+			connector->loop(nullptr);
+
+			server.secret = "top secret";
+			server.image.resize(imageSize);
+			for (std::size_t i{0}; i < imageSize; ++i)
+				server.image[i] = static_cast<char>(i * 7 + i / 251);
+		}
+
+		/* Runs the device and the server until nothing is exchanged. */
+		void run(uint32_t maxRounds = 100000)
+		{
+			for (uint32_t round{0}; round < maxRounds; ++round)
+			{
+				auto publishedBefore{connectorBroker.published.size()};
+				connector->loop(nullptr);
+				updater->loop(nullptr);
+				server.serve();
+				if (connectorBroker.pendingToClient() == 0 && connectorBroker.published.size() == publishedBefore)
+					return;
+			}
+		}
+	};
+}
@@ -0,0 +1,298 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace ksf::test
+{
+	/*!
+		@brief Message published by the client and received by the stand-in broker.
+	*/
+	struct ksBrokerMessage
+	{
+		std::string topic;		//!< Topic of the message.
+		std::string payload;	//!< Payload of the message.
+		uint8_t qos{0};			//!< QoS level from the fixed header.
+		bool retain{false};		//!< Retain flag from the fixed header.
+	};
+
+	/*!
+		@brief In-memory MQTT 3.1.1 broker that acts as the network client of ksMqttClient.
+
+		Bytes written by the client are parsed as MQTT packets and answered immediately (CONNACK, SUBACK, PUBACK,
+		PUBREC, PUBCOMP, PINGRESP). Publishes are recorded and echoed back to the client when the topic matches
+		one of its subscriptions ('#' suffix is supported). Answers are queued and given back through read,
+		at most readChunkSize bytes at a time, so the client sees the data arriving in pieces.
+
+		Failures are injected with holdAcks (publishes are not acknowledged), answerPings (PINGRESP is not sent)
+		and writeBudget (socket stops accepting data after this many bytes).
+	*/
+	class ksStandInBroker : public Client
+	{
+		protected:
+			std::vector<uint8_t> fromClient;		//!< Bytes written by the client, not yet parsed.
+			std::vector<uint8_t> toClient;			//!< Bytes waiting to be read by the client.
+			std::size_t toClientPosition{0};		//!< Read position in toClient.
+			bool isOpen{false};						//!< True if the socket is open.
+			uint16_t lastPacketId{0};				//!< Last identifier used for QoS publishes sent to the client.
+
+			static void appendLength(std::vector<uint8_t>& packet, uint32_t length)
+			{
+				do
+				{
+					uint8_t encodedByte = length & 0x7F;
+					length >>= 7;
+					packet.push_back(length > 0 ? encodedByte | 0x80 : encodedByte);
+				}
+				while (length > 0);
+			}
+
+			static uint16_t readUint16(const uint8_t* data)
+			{
+				return static_cast<uint16_t>((data[0] << 8) | data[1]);
+			}
+
+			bool matches(const std::string& topic) const
+			{
+				for (auto& filter : subscriptions)
+				{
+					if (filter == topic)
+						return true;
+					if (!filter.empty() && filter.back() == '#' && topic.compare(0, filter.size() - 1, filter, 0, filter.size() - 1) == 0)
+						return true;
+				}
+				return false;
+			}
+
+			void handlePacket(uint8_t header, const uint8_t* body, uint32_t length)
+			{
+				switch (header & 0xF0)
+				{
+					case 0x10:
+						connectPacket.assign(body, body + length);
+						sendPacket(0x20, {0x00, connackCode});
+					break;
+
+					case 0x30:
+					{
+						ksBrokerMessage message;
+						auto topicLength{readUint16(body)};
+						message.topic.assign(reinterpret_cast<const char*>(body + 2), topicLength);
+						message.qos = (header >> 1) & 0x03;
+						message.retain = header & 0x01;
+						uint32_t payloadStart = 2 + topicLength;
+						uint16_t packetId{0};
+						if (message.qos > 0)
+						{
+							packetId = readUint16(body + payloadStart);
+							payloadStart += 2;
+						}
+						message.payload.assign(reinterpret_cast<const char*>(body + payloadStart), length - payloadStart);
+
+						if (message.qos == 1 && !holdAcks)
+							sendPacket(0x40, {static_cast<uint8_t>(packetId >> 8), static_cast<uint8_t>(packetId)});
+						else if (message.qos == 2 && !holdAcks)
+							sendPacket(0x50, {static_cast<uint8_t>(packetId >> 8), static_cast<uint8_t>(packetId)});
+
+						if (matches(message.topic))
+							publishToClient(message.topic, message.payload);
+
+						++publishesReceived;
+						if (recordPublishes)
+							published.push_back(std::move(message));
+					}
+					break;
+
+					case 0x40: ++pubacksReceived; break;
+					case 0x50: sendPacket(0x62, {body[0], body[1]}); break;
+					case 0x60: ++pubrelsReceived; sendPacket(0x70, {body[0], body[1]}); break;
+					case 0x70: ++pubcompsReceived; break;
+
+					case 0x80:
+					{
+						auto topicLength{readUint16(body + 2)};
+						subscriptions.emplace_back(reinterpret_cast<const char*>(body + 4), topicLength);
+						sendPacket(0x90, {body[0], body[1], body[4 + topicLength]});
+					}
+					break;
+
+					case 0xA0:
+					{
+						std::string filter(reinterpret_cast<const char*>(body + 4), readUint16(body + 2));
+						subscriptions.erase(std::remove(subscriptions.begin(), subscriptions.end(), filter), subscriptions.end());
+						sendPacket(0xB0, {body[0], body[1]});
+					}
+					break;
+
+					case 0xC0:
+						++pingsReceived;
+						if (answerPings)
+							sendPacket(0xD0, {});
+					break;
+
+					case 0xE0: isOpen = false; break;
+				}
+			}
+
+			void parse()
+			{
+				std::size_t position{0};
+				while (position < fromClient.size())
+				{
+					uint32_t length{0};
+					uint8_t shift{0};
+					bool lengthComplete{false};
+					auto cursor{position + 1};
+					for (; !lengthComplete && cursor < fromClient.size(); shift += 7)
+					{
+						auto byte{fromClient[cursor++]};
+						length |= static_cast<uint32_t>(byte & 0x7F) << shift;
+						lengthComplete = !(byte & 0x80);
+					}
+					if (!lengthComplete || fromClient.size() - cursor < length)
+						break;
+
+					++packetsReceived;
+					handlePacket(fromClient[position], fromClient.data() + cursor, length);
+					position = cursor + length;
+				}
+				fromClient.erase(fromClient.begin(), fromClient.begin() + position);
+			}
+
+		public:
+			std::vector<ksBrokerMessage> published;		//!< Publishes received from the client.
+			std::vector<std::string> subscriptions;		//!< Topic filters subscribed by the client.
+			std::vector<uint8_t> connectPacket;			//!< Body of the last CONNECT packet.
+			uint32_t packetsReceived{0};				//!< Number of packets received from the client.
+			uint32_t publishesReceived{0};				//!< Number of PUBLISH packets received from the client.
+			uint32_t pubacksReceived{0};				//!< Number of PUBACK packets received from the client.
+			uint32_t pubrelsReceived{0};				//!< Number of PUBREL packets received from the client.
+			uint32_t pubcompsReceived{0};				//!< Number of PUBCOMP packets received from the client.
+			uint32_t pingsReceived{0};					//!< Number of PINGREQ packets received from the client.
+			uint64_t bytesReceived{0};					//!< Number of bytes written by the client.
+			uint8_t connackCode{0};						//!< Return code sent in CONNACK.
+			std::size_t readChunkSize{SIZE_MAX};		//!< Maximum number of bytes returned by available and read.
+			std::size_t writeBudget{SIZE_MAX};			//!< Number of bytes the socket accepts before writes start to fail.
+			bool holdAcks{false};						//!< True to leave QoS publishes unacknowledged.
+			bool answerPings{true};						//!< True to answer PINGREQ.
+			bool recordPublishes{true};					//!< False to count publishes without storing them.
+
+			/*!
+				@brief Queues a packet to be read by the client.
+				@param header Fixed header byte.
+				@param body Packet body.
+			*/
+			void sendPacket(uint8_t header, const std::vector<uint8_t>& body)
+			{
+				toClient.push_back(header);
+				appendLength(toClient, body.size());
+				toClient.insert(toClient.end(), body.begin(), body.end());
+			}
+
+			/*!
+				@brief Queues a PUBLISH packet to be read by the client.
+				@param topic Topic of the message.
+				@param payload Payload of the message.
+				@param qos QoS level.
+				@return Packet identifier (0 for QoS 0).
+			*/
+			uint16_t publishToClient(const std::string& topic, const std::string& payload, uint8_t qos = 0)
+			{
+				std::vector<uint8_t> body{static_cast<uint8_t>(topic.size() >> 8), static_cast<uint8_t>(topic.size())};
+				body.insert(body.end(), topic.begin(), topic.end());
+				uint16_t packetId{0};
+				if (qos > 0)
+				{
+					packetId = ++lastPacketId;
+					body.push_back(packetId >> 8);
+					body.push_back(packetId & 0xFF);
+				}
+				body.insert(body.end(), payload.begin(), payload.end());
+				sendPacket(0x30 | (qos << 1), body);
+				return packetId;
+			}
+
+			/*!
+				@brief Retrieves the number of bytes not yet read by the client.
+				@return Number of pending bytes.
+			*/
+			std::size_t pendingToClient() const { return toClient.size() - toClientPosition; }
+
+			/*!
+				@brief Drops everything that has been received and queued so far (keeps the connection).
+			*/
+			void clear()
+			{
+				published.clear();
+				toClient.clear();
+				toClientPosition = 0;
+				packetsReceived = publishesReceived = pubacksReceived = pubrelsReceived = pubcompsReceived = pingsReceived = 0;
+			}
+
+			/*!
+				@brief Closes the connection from the broker side.
+			*/
+			void closeFromBroker() { isOpen = false; }
+
+			int connect(IPAddress, uint16_t) override { isOpen = true; return 1; }
+			int connect(const char*, uint16_t) override { isOpen = true; return 1; }
+
+			size_t write(uint8_t value) override { return write(&value, 1); }
+			size_t write(const uint8_t* buffer, size_t size) override
+			{
+				if (!isOpen)
+					return 0;
+
+				auto accepted{std::min(size, writeBudget)};
+				if (writeBudget != SIZE_MAX)
+					writeBudget -= accepted;
+
+				bytesReceived += accepted;
+				fromClient.insert(fromClient.end(), buffer, buffer + accepted);
+				parse();
+				return accepted;
+			}
+
+			int available() override
+			{
+				return isOpen ? static_cast<int>(std::min(pendingToClient(), readChunkSize)) : 0;
+			}
+
+			int read() override
+			{
+				if (available() == 0)
+					return -1;
+				return toClient[toClientPosition++];
+			}
+
+			int read(uint8_t* buffer, size_t size) override
+			{
+				auto count{std::min<std::size_t>(size, available())};
+				std::copy_n(toClient.begin() + toClientPosition, count, buffer);
+				toClientPosition += count;
+				if (toClientPosition == toClient.size())
+				{
+					toClient.clear();
+					toClientPosition = 0;
+				}
+				return static_cast<int>(count);
+			}
+
+			int peek() override { return available() ? toClient[toClientPosition] : -1; }
+			void flush() override {}
+			void stop() override { isOpen = false; }
+			uint8_t connected() override { return isOpen; }
+			operator bool() override { return isOpen; }
+	};
+}
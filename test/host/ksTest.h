@@ -0,0 +1,112 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace ksf::test
+{
+	/*!
+		@brief Registered test case.
+	*/
+	struct ksTestCase
+	{
+		const char* name;		//!< Name of the test case.
+		void (*function)();		//!< Test case body.
+	};
+
+	/*!
+		@brief Retrieves the list of registered test cases.
+		@return Reference to the list of test cases.
+	*/
+	inline std::vector<ksTestCase>& getTestCases()
+	{
+		static std::vector<ksTestCase> testCases;
+		return testCases;
+	}
+
+	inline unsigned failedChecks{0};	//!< Number of failed checks (of all test cases).
+
+	/*!
+		@brief Registers a test case from static initialization.
+	*/
+	struct ksTestRegistrar
+	{
+		ksTestRegistrar(const char* name, void (*function)())
+		{
+			getTestCases().push_back({name, function});
+		}
+	};
+
+	/*!
+		@brief Records the result of a check.
+		@param passed True if the check passed.
+		@param expression Text of the checked expression.
+		@param file Source file of the check.
+		@param line Source line of the check.
+		@return Value of passed.
+	*/
+	inline bool check(bool passed, const char* expression, const char* file, int line)
+	{
+		if (!passed)
+		{
+			++failedChecks;
+			std::printf("  %s:%d: check failed: %s\n", file, line, expression);
+		}
+		return passed;
+	}
+
+	/*!
+		@brief Measures the time of repeated calls and prints the result.
+
+		@param label Label printed with the result.
+		@param iterations Number of calls.
+		@param function Function to be measured (receives the iteration index).
+		@param opsPerCall Number of operations done by a single call.
+		@return Average time of a single operation (nanoseconds).
+	*/
+	template <typename TFunction>
+	double measure(const char* label, uint32_t iterations, TFunction&& function, uint32_t opsPerCall = 1)
+	{
+		auto startTime{std::chrono::steady_clock::now()};
+		for (uint32_t i{0}; i < iterations; ++i)
+			function(i);
+		std::chrono::duration<double, std::nano> elapsed{std::chrono::steady_clock::now() - startTime};
+
+		auto nsPerOp{elapsed.count() / iterations / opsPerCall};
+		std::printf("  %-52s %10.1f ns/op %12.0f op/s\n", label, nsPerOp, 1e9 / nsPerOp);
+		return nsPerOp;
+	}
+
+	/*!
+		@brief Prevents the compiler from optimizing out a computed value.
+		@param value Value to be kept.
+	*/
+	template <typename TValue>
+	inline void keep(const TValue& value)
+	{
+		asm volatile("" : : "g"(&value) : "memory");
+	}
+}
+
+/*! @brief Defines and registers a test case. */
+#define KSF_TEST(name) \
+	static void name(); \
+	static ksf::test::ksTestRegistrar name##Registrar{#name, name}; \
+	static void name()
+
+/*! @brief Checks the condition, continues the test case on failure. */
+#define KSF_CHECK(expression) ksf::test::check(static_cast<bool>(expression), #expression, __FILE__, __LINE__)
+
+/*! @brief Checks the condition, leaves the test case on failure. */
+#define KSF_REQUIRE(expression) if (!KSF_CHECK(expression)) return
@@ -0,0 +1,23 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#include "ksTest.h"
+
+int main()
+{
+	for (auto& testCase : ksf::test::getTestCases())
+	{
+		auto failedBefore{ksf::test::failedChecks};
+		std::printf("[ RUN  ] %s\n", testCase.name);
+		testCase.function();
+		std::printf("[ %s ] %s\n", ksf::test::failedChecks == failedBefore ? " OK " : "FAIL", testCase.name);
+	}
+
+	return ksf::test::failedChecks == 0 ? 0 : 1;
+}
@@ -0,0 +1,71 @@
+# flake8: noqa
+# Copyright (c) 2020-2026, Krzysztof Strehlau
+# This file is part of the ksIotFrameworkLib IoT library.
+# All licensing information can be found inside LICENSE.md file
+# https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+"""
+Builds and runs host tests (test_*.cpp) and benchmarks (bench_*.cpp, with --bench).
+
+Each test file is a separate program linked with the library sources listed in its header comment:
+    // Sources: misc/ksReconnectPolicy.cpp misc/ksMqttClient.cpp
+    // Defines: KSF_LOG_LEVEL=2
+Paths are relative to src/ksf. Arduino and ESP headers are replaced by stand-ins from the stubs directory.
+
+Usage: python test/host/run_tests.py [--bench] [--cxx g++] [filter]
+"""
+import argparse
+import pathlib
+import subprocess
+import sys
+
+HOST_DIR = pathlib.Path(__file__).resolve().parent
+SOURCE_DIR = HOST_DIR.parents[1] / 'src' / 'ksf'
+BUILD_DIR = HOST_DIR / '_build'
+CXX_FLAGS = ['-std=gnu++2a', '-O2', '-g', '-Wall', '-Wextra', '-DESP32', '-DAPP_LOG_ENABLED=1']
+# Unused functions are dropped, so a test can link a source file without the dependencies of the parts it doesn't call.
+LINK_FLAGS = ['-ffunction-sections', '-fdata-sections', '-Wl,--gc-sections']
+
+
+def read_header_list(path, tag):
+    for line in path.read_text().splitlines():
+        if line.startswith('// ' + tag + ':'):
+            return line.split(':', 1)[1].split()
+    return []
+
+
+def build(cxx, path):
+    output = BUILD_DIR / path.stem
+    command = [cxx, *CXX_FLAGS, *LINK_FLAGS, '-I' + str(HOST_DIR / 'stubs'), '-I' + str(HOST_DIR), '-I' + str(SOURCE_DIR)]
+    command += ['-D' + define for define in read_header_list(path, 'Defines')]
+    command += [str(path), str(HOST_DIR / 'ksTestMain.cpp')]
+    command += [str(SOURCE_DIR / source) for source in read_header_list(path, 'Sources')]
+    command += ['-o', str(output)]
+    return output if subprocess.run(command).returncode == 0 else None
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Build and run host tests.')
+    parser.add_argument('filter', nargs='?', default='', help='run only files containing this text')
+    parser.add_argument('--bench', action='store_true', help='run benchmarks instead of tests')
+    parser.add_argument('--cxx', default='g++', help='C++ compiler')
+    args = parser.parse_args()
+
+    BUILD_DIR.mkdir(exist_ok=True)
+    pattern = 'bench_*.cpp' if args.bench else 'test_*.cpp'
+    failed = []
+    for path in sorted(HOST_DIR.glob(pattern)):
+        if args.filter not in path.name:
+            continue
+        print('=== ' + path.stem)
+        program = build(args.cxx, path)
+        if program is None or subprocess.run([str(program)]).returncode != 0:
+            failed.append(path.stem)
+
+    if failed:
+        print('FAILED: ' + ', '.join(failed))
+        sys.exit(1)
+    print('All passed.')
+
+
+if __name__ == '__main__':
+    main()
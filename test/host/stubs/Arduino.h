@@ -0,0 +1,145 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+/*
+	Minimal Arduino core stand-in for host tests. Flash access macros map to plain memory access
+	(as on ESP32) and the time is simulated - it moves only when a test changes it or calls delay.
+*/
+
+#pragma once
+
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#define PROGMEM
+#define PGM_P const char*
+#define PSTR(s) (s)
+#define FPSTR(s) (s)
+#define IRAM_ATTR
+
+inline uint8_t pgm_read_byte(const void* address) { return *static_cast<const uint8_t*>(address); }
+inline uint16_t pgm_read_word(const void* address) { uint16_t value; memcpy(&value, address, sizeof(value)); return value; }
+inline uint32_t pgm_read_dword(const void* address) { uint32_t value; memcpy(&value, address, sizeof(value)); return value; }
+inline void* memcpy_P(void* destination, const void* source, size_t length) { return memcpy(destination, source, length); }
+inline size_t strlen_P(const char* str) { return strlen(str); }
+inline size_t strnlen_P(const char* str, size_t maxLength) { return strnlen(str, maxLength); }
+inline char* strncpy_P(char* destination, const char* source, size_t length) { return strncpy(destination, source, length); }
+inline int strcmp_P(const char* lhs, const char* rhs) { return strcmp(lhs, rhs); }
+inline int vsnprintf_P(char* buffer, size_t size, const char* format, va_list args) { return vsnprintf(buffer, size, format, args); }
+inline int snprintf_P(char* buffer, size_t size, const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	auto result{vsnprintf(buffer, size, format, args)};
+	va_end(args);
+	return result;
+}
+
+namespace ksf::test
+{
+	inline uint32_t fakeMillis{0};	//!< Simulated time (milliseconds).
+}
+
+inline uint32_t millis() { return ksf::test::fakeMillis; }
+inline uint32_t micros() { return ksf::test::fakeMillis * 1000; }
+inline void delay(uint32_t ms) { ksf::test::fakeMillis += ms; }
+inline void yield() {}
+inline long random(long maxValue) { return rand() % maxValue; }
+
+inline char* dtostrf(double value, signed char width, unsigned char precision, char* buffer)
+{
+	sprintf(buffer, "%*.*f", width, precision, value);
+	return buffer;
+}
+
+#define ESP_OK 0
+
+enum esp_reset_reason_t
+{
+	ESP_RST_UNKNOWN, ESP_RST_POWERON, ESP_RST_EXT, ESP_RST_SW, ESP_RST_PANIC, ESP_RST_INT_WDT, ESP_RST_TASK_WDT,
+	ESP_RST_WDT, ESP_RST_DEEPSLEEP, ESP_RST_BROWNOUT, ESP_RST_SDIO
+};
+
+/*! @brief Arduino String stand-in (only the parts used by the library). */
+class String : public std::string
+{
+	public:
+		using std::string::string;
+		String(const std::string& str) : std::string(str) {}
+};
+
+inline esp_reset_reason_t esp_reset_reason() { return ESP_RST_POWERON; }
+inline uint32_t esp_random() { return static_cast<uint32_t>(rand()) ^ (static_cast<uint32_t>(rand()) << 16); }
+
+class EspClass
+{
+	public:
+		uint64_t getEfuseMac() { return 0x0000A1B2C3D4E5F6ULL; }
+		uint32_t getFreeHeap() { return 100000; }
+		void restart() {}
+		uint32_t getSketchSize() { return 1024 * 1024; }
+		String getSketchMD5() { return "00000000000000000000000000000000"; }
+		uint32_t getFreeSketchSpace() { return 1536 * 1024; }
+};
+
+inline EspClass ESP;
+
+class Print
+{
+	public:
+		virtual ~Print() = default;
+		virtual size_t write(uint8_t value) = 0;
+		virtual size_t write(const uint8_t* buffer, size_t size)
+		{
+			size_t written{0};
+			while (written < size && write(buffer[written]))
+				++written;
+			return written;
+		}
+		size_t write(const char* buffer, size_t size) { return write(reinterpret_cast<const uint8_t*>(buffer), size); }
+		virtual int availableForWrite() { return 0; }
+};
+
+class Stream : public Print
+{
+	public:
+		virtual int available() = 0;
+		virtual int read() = 0;
+		virtual int peek() = 0;
+		virtual void setTimeout(unsigned long) {}
+};
+
+class IPAddress
+{
+	protected:
+		uint32_t address{0};
+
+	public:
+		IPAddress() = default;
+		IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : address(a | (b << 8) | (c << 16) | (static_cast<uint32_t>(d) << 24)) {}
+		operator uint32_t() const { return address; }
+};
+
+class Client : public Stream
+{
+	public:
+		using Print::write;
+		virtual int connect(IPAddress ip, uint16_t port) = 0;
+		virtual int connect(const char* host, uint16_t port) = 0;
+		virtual int read() = 0;
+		virtual int read(uint8_t* buffer, size_t size) = 0;
+		virtual void flush() = 0;
+		virtual void stop() = 0;
+		virtual uint8_t connected() = 0;
+		virtual operator bool() = 0;
+};
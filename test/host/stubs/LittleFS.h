@@ -0,0 +1,50 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include "Arduino.h"
+
+/*
+	File system stand-in. Nothing is stored - files can't be opened, so the code paths that use
+	configuration files behave as on a freshly formatted device.
+*/
+
+class File : public Stream
+{
+	public:
+		size_t write(uint8_t) override { return 0; }
+		using Print::write;
+		int available() override { return 0; }
+		int read() override { return -1; }
+		size_t read(uint8_t*, size_t) { return 0; }
+		int peek() override { return -1; }
+		size_t size() const { return 0; }
+		bool seek(uint32_t) { return false; }
+		void close() {}
+		bool isDirectory() const { return false; }
+		File openNextFile() { return {}; }
+		const char* path() const { return ""; }
+		const char* name() const { return ""; }
+		explicit operator bool() const { return false; }
+};
+
+class LittleFSClass
+{
+	public:
+		bool begin(bool = false) { return true; }
+		bool exists(const char*) { return false; }
+		bool mkdir(const char*) { return true; }
+		bool rmdir(const char*) { return true; }
+		bool remove(const char*) { return true; }
+		bool rename(const char*, const char*) { return true; }
+		File open(const char*, const char*) { return {}; }
+};
+
+inline LittleFSClass LittleFS;
@@ -0,0 +1,68 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include <vector>
+#include "Arduino.h"
+
+#define U_FLASH 0
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+
+/*
+	Firmware update stand-in. The image is collected in memory, so tests can compare it with what has been sent.
+	MD5 is not computed - the expected value is only stored.
+*/
+class UpdateClass
+{
+	public:
+		std::vector<uint8_t> image;		//!< Data written in the current session.
+		std::string expectedMD5;		//!< MD5 set for the current session.
+		bool running{false};			//!< True if the session is active.
+		bool finished{false};			//!< True if the last session has been ended successfully.
+		bool failWrites{false};			//!< Injected flash write error.
+
+		bool begin(size_t, int = U_FLASH)
+		{
+			image.clear();
+			expectedMD5.clear();
+			running = true;
+			finished = false;
+			return true;
+		}
+
+		bool setMD5(const char* md5)
+		{
+			expectedMD5 = md5;
+			return true;
+		}
+
+		size_t write(uint8_t* data, size_t length)
+		{
+			if (!running || failWrites)
+				return 0;
+
+			image.insert(image.end(), data, data + length);
+			return length;
+		}
+
+		bool hasError() { return failWrites; }
+
+		bool end(bool = false)
+		{
+			finished = running && !failWrites;
+			running = false;
+			return finished;
+		}
+
+		void abort() { running = false; }
+		String md5String() { return expectedMD5; }
+};
+
+inline UpdateClass Update;
@@ -0,0 +1,34 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include "Arduino.h"
+
+#define WIFI_OFF 0
+#define WIFI_STA 1
+
+class WiFiClass
+{
+	public:
+		void persistent(bool) {}
+		bool mode(int) { return true; }
+		bool setAutoReconnect(bool) { return true; }
+		bool isConnected() { return true; }
+		int8_t RSSI() { return -60; }
+		IPAddress localIP() { return {192, 168, 1, 2}; }
+		const char* getHostname() { return "host"; }
+};
+
+inline WiFiClass WiFi;
+
+/* Network client types are only declared by the library headers - complete, but unusable stand-ins. */
+class WiFiClient {};
+class WiFiClientSecure {};
+class WiFiUDP {};
@@ -0,0 +1,18 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+#pragma once
+
+#include "Arduino.h"
+
+/* There is no running image on the host, so delta patches can't be applied. */
+struct esp_partition_t {};
+
+inline const esp_partition_t* esp_ota_get_running_partition() { return nullptr; }
+inline int esp_partition_read(const esp_partition_t*, size_t, void*, size_t) { return -1; }
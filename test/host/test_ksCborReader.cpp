@@ -0,0 +1,315 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+// Sources: misc/ksCborReader.cpp
+
+#include <cmath>
+#include <vector>
+#include "ksTest.h"
+#include "misc/ksCborReader.h"
+
+using ksf::misc::ksCborReader;
+using ksBytes = std::vector<uint8_t>;
+using Type = ksCborReader::Type;
+
+/* Values below are taken from RFC 8949, Appendix A where possible. */
+
+KSF_TEST(integers)
+{
+	ksBytes input{0x00, 0x17, 0x18, 0x18, 0x19, 0x03, 0xe8, 0x1b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x20, 0x38, 0x63};
+	ksCborReader reader{input.data(), input.size()};
+
+	uint64_t value;
+	int64_t signedValue;
+	KSF_CHECK(reader.readUnsigned(value) && value == 0);
+	KSF_CHECK(reader.readUnsigned(value) && value == 23);
+	KSF_CHECK(reader.readUnsigned(value) && value == 24);
+	KSF_CHECK(reader.readInt(signedValue) && signedValue == 1000);
+
+	/* UINT64_MAX doesn't fit into int64_t - not consumed, still readable as unsigned. */
+	KSF_CHECK(!reader.readInt(signedValue));
+	KSF_CHECK(reader.readUnsigned(value) && value == UINT64_MAX);
+
+	KSF_CHECK(!reader.readUnsigned(value));
+	KSF_CHECK(reader.peekType() == Type::Negative);
+	KSF_CHECK(reader.readInt(signedValue) && signedValue == -1);
+	KSF_CHECK(reader.readInt(signedValue) && signedValue == -100);
+	KSF_CHECK(reader.isAtEnd() && !reader.hasError());
+}
+
+KSF_TEST(negativeIntegersNearLimit)
+{
+	/* -2^63 is the lowest int64_t, -2^63 - 1 and -2^64 are not representable. */
+	ksBytes input{
+		0x3b, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x3b, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe,
+		0x3b, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x3b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+	};
+	ksCborReader reader{input.data(), input.size()};
+
+	int64_t value;
+	KSF_CHECK(reader.readInt(value) && value == INT64_MIN);
+	KSF_CHECK(reader.readInt(value) && value == INT64_MIN + 1);
+
+	for (uint8_t i{0}; i < 2; ++i)
+	{
+		auto position{reader.getPosition()};
+		KSF_CHECK(!reader.readInt(value));
+		KSF_CHECK(reader.getPosition() == position);
+		KSF_CHECK(reader.skip());
+	}
+
+	KSF_CHECK(reader.isAtEnd() && !reader.hasError());
+}
+
+KSF_TEST(floats)
+{
+	ksBytes input{
+		0xf9, 0x3c, 0x00,
+		0xf9, 0x80, 0x00,
+		0xf9, 0x7b, 0xff,
+		0xf9, 0x00, 0x01,
+		0xf9, 0xc4, 0x00,
+		0xf9, 0x7c, 0x00,
+		0xf9, 0xfc, 0x00,
+		0xf9, 0x7e, 0x00,
+		0xfa, 0x47, 0xc3, 0x50, 0x00,
+		0xfa, 0x7f, 0x7f, 0xff, 0xff,
+		0xfb, 0x3f, 0xf1, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9a,
+		0xfb, 0xc0, 0x10, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+		0x38, 0x63
+	};
+	ksCborReader reader{input.data(), input.size()};
+
+	double value;
+	KSF_CHECK(reader.peekType() == Type::Float);
+	KSF_CHECK(reader.readFloat(value) && value == 1.0);
+	KSF_CHECK(reader.readFloat(value) && value == 0.0 && std::signbit(value));
+	KSF_CHECK(reader.readFloat(value) && value == 65504.0);
+	KSF_CHECK(reader.readFloat(value) && value == 5.960464477539063e-8);
+	KSF_CHECK(reader.readFloat(value) && value == -4.0);
+	KSF_CHECK(reader.readFloat(value) && std::isinf(value) && value > 0);
+	KSF_CHECK(reader.readFloat(value) && std::isinf(value) && value < 0);
+	KSF_CHECK(reader.readFloat(value) && std::isnan(value));
+	KSF_CHECK(reader.readFloat(value) && value == 100000.0);
+	KSF_CHECK(reader.readFloat(value) && value == 3.4028234663852886e+38);
+	KSF_CHECK(reader.readFloat(value) && value == 1.1);
+	KSF_CHECK(reader.readFloat(value) && value == -4.1);
+
+	/* Integers are accepted as floats. */
+	KSF_CHECK(reader.readFloat(value) && value == -100.0);
+	KSF_CHECK(reader.isAtEnd() && !reader.hasError());
+}
+
+KSF_TEST(simpleValuesAndTags)
+{
+	ksBytes input{0xf4, 0xf5, 0xf6, 0xf7, 0xc1, 0x1a, 0x51, 0x4b, 0x67, 0xb0};
+	ksCborReader reader{input.data(), input.size()};
+
+	bool flag;
+	uint64_t value;
+	KSF_CHECK(reader.peekType() == Type::Bool);
+	KSF_CHECK(!reader.readNull());
+	KSF_CHECK(reader.readBool(flag) && !flag);
+	KSF_CHECK(reader.readBool(flag) && flag);
+	KSF_CHECK(reader.peekType() == Type::Null && reader.readNull());
+	KSF_CHECK(reader.readNull());
+	KSF_CHECK(reader.peekType() == Type::Tag);
+	KSF_CHECK(reader.readTag(value) && value == 1);
+	KSF_CHECK(reader.readUnsigned(value) && value == 1363896240);
+	KSF_CHECK(reader.peekType() == Type::End);
+	KSF_CHECK(!reader.readBool(flag) && !reader.hasError());
+}
+
+KSF_TEST(strings)
+{
+	ksBytes input{0x40, 0x44, 0x01, 0x02, 0x03, 0x04, 0x60, 0x64, 0x49, 0x45, 0x54, 0x46, 0x62, 0xc3, 0xbc};
+	ksCborReader reader{input.data(), input.size()};
+
+	std::string_view text;
+	KSF_CHECK(!reader.readText(text));
+	KSF_CHECK(reader.readBytes(text) && text.empty());
+	KSF_CHECK(reader.readBytes(text) && text == std::string_view("\x01\x02\x03\x04", 4));
+	KSF_CHECK(reader.readText(text) && text.empty());
+	KSF_CHECK(reader.readText(text) && text == "IETF");
+
+	/* Views point into the input, nothing is copied. */
+	KSF_CHECK(reader.readText(text) && text == "\xc3\xbc" && reinterpret_cast<const uint8_t*>(text.data()) == &input[13]);
+	KSF_CHECK(reader.isAtEnd() && !reader.hasError());
+}
+
+KSF_TEST(truncatedHeads)
+{
+	/* Argument bytes missing for each argument size and major type. */
+	for (const auto& input : {ksBytes{0x18}, ksBytes{0x19, 0x01}, ksBytes{0x1a, 0x01, 0x02, 0x03}, ksBytes{0x1b, 0, 0, 0, 0, 0, 0, 0},
+		ksBytes{0x38}, ksBytes{0x59, 0x00}, ksBytes{0x78}, ksBytes{0x99, 0x00}, ksBytes{0xb8}, ksBytes{0xd8}})
+	{
+		ksCborReader reader{input.data(), input.size()};
+		KSF_CHECK(reader.peekType() == Type::Invalid);
+		KSF_CHECK(!reader.skip());
+		KSF_CHECK(reader.hasError());
+	}
+
+	for (const auto& input : {ksBytes{0x19, 0x01}, ksBytes{0x38}})
+	{
+		ksCborReader reader{input.data(), input.size()};
+		int64_t value;
+		KSF_CHECK(!reader.readInt(value) && reader.hasError() && reader.getPosition() == 0);
+	}
+
+	for (const auto& input : {ksBytes{0xf9, 0x3c}, ksBytes{0xfa, 0x47, 0xc3, 0x50}, ksBytes{0xfb, 0x3f, 0xf1}})
+	{
+		ksCborReader reader{input.data(), input.size()};
+		double value;
+		KSF_CHECK(!reader.readFloat(value) && reader.hasError() && reader.getPosition() == 0);
+	}
+}
+
+KSF_TEST(truncatedStrings)
+{
+	for (const auto& input : {ksBytes{0x64, 0x49, 0x45, 0x54}, ksBytes{0x44, 0x01}, ksBytes{0x78, 0x20, 0x41},
+		ksBytes{0x7b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf0, 0x41}})
+	{
+		ksCborReader reader{input.data(), input.size()};
+		std::string_view text;
+		KSF_CHECK(!reader.readText(text) && !reader.readBytes(text));
+		KSF_CHECK(reader.hasError() && reader.getPosition() == 0);
+	}
+
+	/* Chunked strings are not supported. */
+	ksBytes chunked{0x7f, 0x61, 0x61, 0xff};
+	ksCborReader reader{chunked.data(), chunked.size()};
+	std::string_view text;
+	KSF_CHECK(reader.peekType() == Type::Text);
+	KSF_CHECK(!reader.readText(text) && reader.hasError());
+}
+
+KSF_TEST(reservedAdditionalInfo)
+{
+	for (uint8_t majorType{0}; majorType < 8; ++majorType)
+	{
+		for (uint8_t additionalInfo{28}; additionalInfo <= 30; ++additionalInfo)
+		{
+			ksBytes input{static_cast<uint8_t>(majorType << 5 | additionalInfo), 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+			ksCborReader reader{input.data(), input.size()};
+			uint64_t value;
+			KSF_CHECK(reader.peekType() == Type::Invalid);
+			KSF_CHECK(!reader.readUnsigned(value) && reader.hasError());
+
+			ksCborReader skipper{input.data(), input.size()};
+			KSF_CHECK(!skipper.skip() && skipper.hasError());
+		}
+	}
+
+	/* Indefinite length is invalid for integers and tags. */
+	for (const auto& input : {ksBytes{0x1f}, ksBytes{0x3f}, ksBytes{0xdf, 0x00}})
+	{
+		ksCborReader reader{input.data(), input.size()};
+		KSF_CHECK(reader.peekType() == Type::Invalid);
+		KSF_CHECK(!reader.skip() && reader.hasError());
+	}
+}
+
+KSF_TEST(indefiniteContainers)
+{
+	/* [_ 1, [2, 3], [_ 4, 5]] and {_ "a": 1, "b": [_ 2, 3]} */
+	ksBytes input{0x9f, 0x01, 0x82, 0x02, 0x03, 0x9f, 0x04, 0x05, 0xff, 0xff, 0xbf, 0x61, 0x61, 0x01, 0x61, 0x62, 0x9f, 0x02, 0x03, 0xff, 0xff};
+	ksCborReader reader{input.data(), input.size()};
+
+	uint64_t count, value, sum{0};
+	KSF_REQUIRE(reader.readArray(count) && count == ksCborReader::INDEFINITE_LENGTH);
+	KSF_CHECK(reader.readUnsigned(value) && value == 1);
+	KSF_CHECK(reader.readArray(count) && count == 2);
+	KSF_CHECK(reader.skip() && reader.skip());
+	KSF_CHECK(reader.readArray(count) && count == ksCborReader::INDEFINITE_LENGTH);
+	while (!reader.isBreak() && reader.readUnsigned(value))
+		sum += value;
+	KSF_CHECK(sum == 9);
+	KSF_CHECK(reader.peekType() == Type::Break);
+	KSF_CHECK(!reader.readUnsigned(value) && !reader.hasError());
+	KSF_CHECK(reader.readBreak() && reader.readBreak());
+
+	/* The whole map is skipped with its nested indefinite array. */
+	KSF_CHECK(reader.skip());
+	KSF_CHECK(reader.isAtEnd() && !reader.hasError());
+	KSF_CHECK(!reader.readBreak());
+
+	/* Missing break is truncated input. */
+	ksBytes unterminated{0x9f, 0x01, 0x02};
+	ksCborReader truncated{unterminated.data(), unterminated.size()};
+	KSF_CHECK(!truncated.skip() && truncated.hasError());
+}
+
+KSF_TEST(skipNestedMaps)
+{
+	/* {"a": {"b": [1, {"c": h'0102'}], "d": -1.5}, "e": "f"}, then 7. */
+	ksBytes input{
+		0xa2,
+			0x61, 0x61, 0xa2,
+				0x61, 0x62, 0x82, 0x01, 0xa1, 0x61, 0x63, 0x42, 0x01, 0x02,
+				0x61, 0x64, 0xf9, 0xbe, 0x00,
+			0x61, 0x65, 0x61, 0x66,
+		0x07
+	};
+	ksCborReader reader{input.data(), input.size()};
+
+	uint64_t count, value;
+	std::string_view key;
+	KSF_REQUIRE(reader.readMap(count) && count == 2);
+	KSF_CHECK(reader.readText(key) && key == "a");
+	KSF_CHECK(reader.skip());
+	KSF_CHECK(reader.readText(key) && key == "e");
+	KSF_CHECK(reader.skip());
+	KSF_CHECK(reader.readUnsigned(value) && value == 7);
+	KSF_CHECK(reader.isAtEnd() && !reader.hasError());
+
+	/* Map with an odd number of items is truncated. */
+	ksBytes oddMap{0xa2, 0x01, 0x02, 0x03};
+	ksCborReader truncated{oddMap.data(), oddMap.size()};
+	KSF_CHECK(!truncated.skip() && truncated.hasError());
+}
+
+KSF_TEST(skipDepthLimit)
+{
+	/* Items nested up to the limit are skipped, one level more is refused (stack of the device is small). */
+	for (uint8_t depth : {16, 17, 200})
+	{
+		ksBytes input(depth, 0x81);
+		input.push_back(0x00);
+
+		ksCborReader reader{input.data(), input.size()};
+		auto isSkipped{reader.skip()};
+		KSF_CHECK(isSkipped == (depth <= 16));
+		KSF_CHECK(reader.hasError() == !isSkipped);
+	}
+
+	/* Tags count as a level too. */
+	ksBytes tags(20, 0xc1);
+	tags.push_back(0x00);
+	ksCborReader reader{tags.data(), tags.size()};
+	KSF_CHECK(!reader.skip() && reader.hasError());
+}
+
+KSF_TEST(typeMismatchDoesNotMove)
+{
+	ksBytes input{0x63, 0x61, 0x62, 0x63};
+	ksCborReader reader{input.data(), input.size()};
+
+	uint64_t value;
+	int64_t signedValue;
+	double floatValue;
+	bool flag;
+	std::string_view bytes;
+	KSF_CHECK(!reader.readUnsigned(value) && !reader.readInt(signedValue) && !reader.readFloat(floatValue));
+	KSF_CHECK(!reader.readBool(flag) && !reader.readNull() && !reader.readBytes(bytes));
+	KSF_CHECK(!reader.readArray(value) && !reader.readMap(value) && !reader.readTag(value) && !reader.readBreak());
+	KSF_CHECK(reader.getPosition() == 0 && !reader.hasError());
+	KSF_CHECK(reader.readText(bytes) && bytes == "abc");
+}
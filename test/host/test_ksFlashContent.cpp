@@ -0,0 +1,86 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+// Sources: misc/ksFlashContent.cpp
+
+#include <string>
+#include <vector>
+#include "ksTest.h"
+#include "misc/ksFlashContent.h"
+
+using ksf::misc::ERangeResult;
+using ksf::misc::parseByteRange;
+
+/* Client stand-in that accepts a limited number of bytes per write and may drop the connection. */
+struct ksClientStandIn
+{
+	std::string received;				//!< Bytes accepted so far.
+	size_t acceptLimit{SIZE_MAX};		//!< Maximum number of bytes accepted by a single write.
+	size_t disconnectAfter{SIZE_MAX};	//!< Number of bytes after which the peer goes away.
+
+	uint8_t connected() { return received.size() < disconnectAfter; }
+
+	size_t write(const uint8_t* data, size_t length)
+	{
+		auto accepted{std::min(length, acceptLimit)};
+		received.append(reinterpret_cast<const char*>(data), accepted);
+		return accepted;
+	}
+};
+
+KSF_TEST(byteRanges)
+{
+	size_t start{0}, length{0};
+
+	KSF_CHECK(parseByteRange("bytes=0-499", 1000, start, length) == ERangeResult::Partial);
+	KSF_CHECK(start == 0 && length == 500);
+	KSF_CHECK(parseByteRange("bytes=500-", 1000, start, length) == ERangeResult::Partial);
+	KSF_CHECK(start == 500 && length == 500);
+	KSF_CHECK(parseByteRange("bytes=-300", 1000, start, length) == ERangeResult::Partial);
+	KSF_CHECK(start == 700 && length == 300);
+	KSF_CHECK(parseByteRange("bytes=900-5000", 1000, start, length) == ERangeResult::Partial);
+	KSF_CHECK(start == 900 && length == 100);
+
+	KSF_CHECK(parseByteRange("bytes=1000-", 1000, start, length) == ERangeResult::Unsatisfiable);
+	KSF_CHECK(parseByteRange("bytes=-0", 1000, start, length) == ERangeResult::Unsatisfiable);
+
+	KSF_CHECK(parseByteRange("items=0-1", 1000, start, length) == ERangeResult::None);
+	KSF_CHECK(parseByteRange("bytes=0-1,5-6", 1000, start, length) == ERangeResult::None);
+	KSF_CHECK(parseByteRange("bytes=5-1", 1000, start, length) == ERangeResult::None);
+	KSF_CHECK(parseByteRange("bytes=a-1", 1000, start, length) == ERangeResult::None);
+}
+
+KSF_TEST(writesWholeContentWithShortWrites)
+{
+	std::vector<uint8_t> content(10000);
+	for (size_t i{0}; i < content.size(); ++i)
+		content[i] = static_cast<uint8_t>(i * 7);
+
+	for (size_t acceptLimit : {SIZE_MAX, size_t{1460}, size_t{333}, size_t{1}})
+	{
+		ksClientStandIn client;
+		client.acceptLimit = acceptLimit;
+		KSF_CHECK(ksf::misc::writeFlashContent(client, content.data(), content.size()) == content.size());
+		KSF_CHECK(client.received == std::string(content.begin(), content.end()));
+	}
+}
+
+KSF_TEST(stopsWhenPeerGoesAway)
+{
+	std::vector<uint8_t> content(10000, 'x');
+
+	ksClientStandIn client;
+	client.disconnectAfter = 3000;
+	auto written{ksf::misc::writeFlashContent(client, content.data(), content.size())};
+	KSF_CHECK(written >= 3000 && written < content.size());
+
+	ksClientStandIn stalled;
+	stalled.acceptLimit = 0;
+	KSF_CHECK(ksf::misc::writeFlashContent(stalled, content.data(), content.size()) == 0);
+}
@@ -0,0 +1,238 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+// Sources: misc/ksHeatshrinkDecoder.cpp
+
+#include <random>
+#include <string>
+#include <vector>
+#include "ksTest.h"
+#include "misc/ksHeatshrinkDecoder.h"
+
+using ksf::misc::ksHeatshrinkDecoder;
+
+/*
+	Encoder used to produce test streams. Same format and match rules as scripts/ota_compress.py: MSB first bits,
+	literal tagged with 1, backreference tagged with 0 followed by (distance - 1) and (length - 1).
+*/
+class ksTestEncoder
+{
+	protected:
+		static constexpr size_t MAX_CANDIDATES{64};
+		std::vector<uint8_t> out;
+		uint32_t bitBuffer{0};
+		uint8_t bitCount{0};
+
+		void push(uint32_t value, uint8_t bits)
+		{
+			bitBuffer = (bitBuffer << bits) | (value & ((1U << bits) - 1));
+			bitCount += bits;
+			while (bitCount >= 8)
+			{
+				bitCount -= 8;
+				out.push_back(static_cast<uint8_t>(bitBuffer >> bitCount));
+			}
+		}
+
+	public:
+		std::vector<uint8_t> compress(const std::vector<uint8_t>& data, uint8_t windowBits, uint8_t lookaheadBits)
+		{
+			out = {'K', 'S', 'H', static_cast<uint8_t>(windowBits << 4 | lookaheadBits)};
+			bitBuffer = 0;
+			bitCount = 0;
+
+			const size_t window{1U << windowBits}, maxLength{1U << lookaheadBits};
+			const size_t backrefBits{1U + windowBits + lookaheadBits};
+			std::vector<int32_t> head(1 << 16, -1), previous(data.size(), -1);
+			auto hash = [&data](size_t pos) { return (data[pos] << 8 ^ data[pos + 1] << 4 ^ data[pos + 2]) & 0xFFFF; };
+
+			for (size_t pos{0}; pos < data.size();)
+			{
+				size_t bestLength{0}, bestDistance{0};
+				if (pos + 3 <= data.size())
+				{
+					size_t candidates{0};
+					for (auto candidate{head[hash(pos)]}; candidate >= 0 && candidates < MAX_CANDIDATES; candidate = previous[candidate], ++candidates)
+					{
+						auto distance{pos - candidate};
+						if (distance > window)
+							break;
+
+						size_t length{0};
+						while (length < maxLength && pos + length < data.size() && data[candidate + length] == data[pos + length])
+							++length;
+
+						if (length > bestLength)
+						{
+							bestLength = length;
+							bestDistance = distance;
+							if (length == maxLength)
+								break;
+						}
+					}
+				}
+
+				size_t step{1};
+				if (bestLength * 9 > backrefBits)
+				{
+					push(0, 1);
+					push(bestDistance - 1, windowBits);
+					push(bestLength - 1, lookaheadBits);
+					step = bestLength;
+				}
+				else
+				{
+					push(1, 1);
+					push(data[pos], 8);
+				}
+
+				for (auto end{pos + step}; pos < end; ++pos)
+				{
+					if (pos + 3 > data.size())
+						continue;
+					auto key{hash(pos)};
+					previous[pos] = head[key];
+					head[key] = static_cast<int32_t>(pos);
+				}
+			}
+
+			if (bitCount > 0)
+				out.push_back(static_cast<uint8_t>(bitBuffer << (8 - bitCount)));
+			return out;
+		}
+};
+
+/* Firmware-like content: random bytes, runs of one byte and repeated text. */
+static std::vector<uint8_t> makeContent(size_t size, uint32_t seed)
+{
+	std::mt19937 random{seed};
+	std::vector<uint8_t> data;
+	data.reserve(size + 300);
+	while (data.size() < size)
+	{
+		auto kind{random() % 10};
+		if (kind < 3)
+		{
+			for (auto count{1 + random() % 200}; count > 0; --count)
+				data.push_back(static_cast<uint8_t>(random()));
+		}
+		else if (kind < 5)
+			data.insert(data.end(), 1 + random() % 300, static_cast<uint8_t>(random()));
+		else
+		{
+			auto text{"firmware-text-" + std::to_string(random() % 50) + ';'};
+			data.insert(data.end(), text.begin(), text.end());
+		}
+	}
+	data.resize(size);
+	return data;
+}
+
+/* Feeds the stream to the decoder in random pieces of 1 to maxChunk bytes and collects the output. */
+static bool decodeInChunks(ksHeatshrinkDecoder& decoder, const std::vector<uint8_t>& stream, size_t maxChunk, uint32_t seed, std::vector<uint8_t>& output)
+{
+	std::mt19937 random{seed};
+	auto collect = [&output](const uint8_t* data, size_t length) {
+		output.insert(output.end(), data, data + length);
+		return true;
+	};
+
+	for (size_t offset{0}; offset < stream.size();)
+	{
+		auto chunk{std::min<size_t>(1 + random() % maxChunk, stream.size() - offset)};
+		if (!decoder.decode(stream.data() + offset, chunk, collect))
+			return false;
+		offset += chunk;
+	}
+	return true;
+}
+
+/* Compresses, decodes in random pieces and checks the result. */
+static void checkRoundTrip(size_t size, uint8_t windowBits, uint8_t lookaheadBits, size_t maxChunk, uint32_t seed)
+{
+	auto data{makeContent(size, seed)};
+	auto stream{ksTestEncoder().compress(data, windowBits, lookaheadBits)};
+	KSF_CHECK(stream.size() < data.size());
+
+	ksHeatshrinkDecoder decoder;
+	std::vector<uint8_t> output;
+	output.reserve(data.size());
+	KSF_REQUIRE(decodeInChunks(decoder, stream, maxChunk, seed * 7 + 1, output));
+	KSF_CHECK(decoder.isComplete());
+	KSF_CHECK(decoder.getTotalOutput() == data.size());
+	KSF_CHECK(output == data);
+}
+
+KSF_TEST(roundTrip128kRandomChunks)
+{
+	struct { uint8_t windowBits, lookaheadBits; } configs[]{{8, 3}, {11, 4}, {12, 6}, {12, 11}};
+	uint32_t seed{1};
+	for (auto config : configs)
+		for (size_t maxChunk : {size_t{1}, size_t{7}, size_t{512}, size_t{8192}})
+			checkRoundTrip(128 * 1024, config.windowBits, config.lookaheadBits, maxChunk, seed++);
+}
+
+KSF_TEST(roundTrip1mRandomChunks)
+{
+	checkRoundTrip(1024 * 1024, 11, 4, 1460, 100);
+	checkRoundTrip(1024 * 1024, 12, 8, 4096, 101);
+}
+
+KSF_TEST(headerSplitAcrossCalls)
+{
+	auto data{makeContent(4096, 5)};
+	auto stream{ksTestEncoder().compress(data, 10, 4)};
+
+	/* Header and the first bits are fed one byte per call. */
+	ksHeatshrinkDecoder decoder;
+	std::vector<uint8_t> output;
+	KSF_REQUIRE(decodeInChunks(decoder, stream, 1, 0, output));
+	KSF_CHECK(decoder.isComplete());
+	KSF_CHECK(output == data);
+}
+
+KSF_TEST(truncatedStreamGivesPrefix)
+{
+	auto data{makeContent(4096, 6)};
+	auto stream{ksTestEncoder().compress(data, 11, 4)};
+	stream.resize(stream.size() / 2);
+
+	ksHeatshrinkDecoder decoder;
+	std::vector<uint8_t> output;
+	KSF_CHECK(decodeInChunks(decoder, stream, 64, 0, output));
+	KSF_CHECK(decoder.getTotalOutput() < data.size());
+	KSF_CHECK(std::equal(output.begin(), output.end(), data.begin()));
+}
+
+KSF_TEST(malformedStreams)
+{
+	auto ignore = [](const uint8_t*, size_t) { return true; };
+
+	const uint8_t badMagic[]{'K', 'S', 'X', 0xB4, 0x00};
+	KSF_CHECK(!ksHeatshrinkDecoder().decode(badMagic, sizeof(badMagic), ignore));
+
+	/* Lookahead not shorter than the window. */
+	const uint8_t badBits[]{'K', 'S', 'H', 0x88};
+	KSF_CHECK(!ksHeatshrinkDecoder().decode(badBits, sizeof(badBits), ignore));
+
+	/* Backreference before the beginning of the output. */
+	const uint8_t badReference[]{'K', 'S', 'H', 0xB4, 0x00, 0x00, 0x00};
+	KSF_CHECK(!ksHeatshrinkDecoder().decode(badReference, sizeof(badReference), ignore));
+}
+
+KSF_TEST(outputFailureStopsDecoding)
+{
+	auto data{makeContent(32 * 1024, 7)};
+	auto stream{ksTestEncoder().compress(data, 11, 4)};
+
+	ksHeatshrinkDecoder decoder;
+	size_t calls{0};
+	KSF_CHECK(!decoder.decode(stream.data(), stream.size(), [&calls](const uint8_t*, size_t) { return ++calls < 2; }));
+	KSF_CHECK(calls == 2);
+}
@@ -0,0 +1,84 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+// Sources: misc/ksJsonWriter.cpp ksConstants.cpp
+
+#include "ksTest.h"
+#include "misc/ksJsonWriter.h"
+
+using ksf::misc::ksJsonWriter;
+
+static const char LONG_TEXT[] PROGMEM {"Flash text longer than the copy buffer, with \"quotes\" and a \\ at the 32 byte edge\n"};
+
+KSF_TEST(flashStringMethods)
+{
+	std::string out;
+	ksJsonWriter json{out};
+	json.beginObject();
+	json.member_P(PSTR("name"), PSTR("MCU \"chip\""));
+	json.member_P(PSTR("count"), 42);
+	json.member_P(PSTR("text"), std::string("ram"));
+	json.key_P(PSTR("list"));
+	json.beginArray();
+	json.value_P(PSTR("a\tb"));
+	json.value_P(PSTR(""));
+	json.endArray();
+	json.key_P(PSTR("built"));
+	json.beginString();
+	json.addString_P(PSTR("up "));
+	json.addString(12);
+	json.addString_P(PSTR(" ms"));
+	json.endString();
+	json.endObject();
+	KSF_CHECK(json.finish());
+	KSF_CHECK(out == R"({"name":"MCU \"chip\"","count":42,"text":"ram","list":["a\tb",""],"built":"up 12 ms"})");
+}
+
+KSF_TEST(flashStringLongerThanCopyBuffer)
+{
+	std::string fromFlash, fromRam;
+	ksJsonWriter flashJson{fromFlash}, ramJson{fromRam};
+	flashJson.value_P(LONG_TEXT);
+	ramJson.value(std::string_view(LONG_TEXT));
+	KSF_CHECK(fromFlash == fromRam);
+	KSF_CHECK(fromFlash.find(R"(\"quotes\")") != std::string::npos);
+	KSF_CHECK(fromFlash.substr(fromFlash.size() - 3) == R"(\n")");
+}
+
+KSF_TEST(chunkedOutput)
+{
+	/* Small chunks split escape sequences and keys, the joined output must not change. */
+	std::string expected;
+	{
+		ksJsonWriter json{expected};
+		json.beginObject();
+		json.member_P(PSTR("long"), LONG_TEXT);
+		json.member_P(PSTR("value"), 1.5);
+		json.endObject();
+	}
+
+	for (std::size_t chunkSize{1}; chunkSize < 20; ++chunkSize)
+	{
+		std::string joined;
+		bool finalSeen{false};
+		char buffer[20];
+		ksJsonWriter json{buffer, chunkSize, [&](std::string_view chunk, bool isFinal) {
+			joined.append(chunk);
+			finalSeen = isFinal;
+			return true;
+		}};
+		json.beginObject();
+		json.member_P(PSTR("long"), LONG_TEXT);
+		json.member_P(PSTR("value"), 1.5);
+		json.endObject();
+		KSF_CHECK(json.finish());
+		KSF_CHECK(finalSeen);
+		KSF_CHECK(joined == expected);
+	}
+}
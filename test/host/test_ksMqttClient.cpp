@@ -0,0 +1,321 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+// Sources: misc/ksMqttClient.cpp
+
+#include "ksTest.h"
+#include "ksStandInBroker.h"
+#include "misc/ksMqttClient.h"
+
+using ksf::misc::ksMqttClient;
+using ksf::test::ksStandInBroker;
+
+struct ksReceivedMessage
+{
+	std::string topic;
+	std::string payload;
+};
+
+/* Connects the client to the stand-in broker and collects incoming messages. */
+static bool connectClient(ksStandInBroker& broker, ksMqttClient& client, std::vector<ksReceivedMessage>& received)
+{
+	client.setCallback([&received](std::string_view topic, std::string_view payload) {
+		received.push_back({std::string(topic), std::string(payload)});
+	});
+	broker.connect("broker", 1883);
+	return client.connect("device", "user", "pass", "dev/lwt", 0, true, "0", true, 1000);
+}
+
+KSF_TEST(connectHandshake)
+{
+	ksStandInBroker broker;
+	ksMqttClient client{broker, 256, 64, 4};
+	std::vector<ksReceivedMessage> received;
+
+	KSF_REQUIRE(connectClient(broker, client, received));
+	KSF_CHECK(client.connected());
+
+	/* Protocol name, level 4, flags: clean session, will (retained), user name and password. */
+	auto& connect{broker.connectPacket};
+	KSF_REQUIRE(connect.size() > 10);
+	KSF_CHECK(std::string(connect.begin() + 2, connect.begin() + 6) == "MQTT");
+	KSF_CHECK(connect[6] == 4);
+	KSF_CHECK(connect[7] == (0x02 | 0x04 | 0x20 | 0x40 | 0x80));
+	KSF_CHECK(connect[8] == 0 && connect[9] == 15);
+}
+
+KSF_TEST(connectRejected)
+{
+	ksStandInBroker broker;
+	broker.connackCode = 5;
+	ksMqttClient client{broker, 256, 64, 4};
+	std::vector<ksReceivedMessage> received;
+
+	KSF_CHECK(!connectClient(broker, client, received));
+	KSF_CHECK(!client.connected());
+}
+
+KSF_TEST(publishQosOnWire)
+{
+	ksStandInBroker broker;
+	ksMqttClient client{broker, 256, 64, 4};
+	std::vector<ksReceivedMessage> received;
+	KSF_REQUIRE(connectClient(broker, client, received));
+
+	KSF_CHECK(client.publish("dev/", "qos0", "a"));
+	KSF_CHECK(client.publish("dev/", "qos1", "b", false, 1));
+	KSF_CHECK(client.publish("dev/", "qos2", "c", true, 2));
+
+	KSF_REQUIRE(broker.published.size() == 3);
+	KSF_CHECK(broker.published[0].topic == "dev/qos0" && broker.published[0].qos == 0);
+	KSF_CHECK(broker.published[1].topic == "dev/qos1" && broker.published[1].qos == 1);
+	KSF_CHECK(broker.published[2].topic == "dev/qos2" && broker.published[2].qos == 2 && broker.published[2].retain);
+	KSF_CHECK(broker.published[2].payload == "c");
+}
+
+KSF_TEST(inFlightWindowQos1)
+{
+	ksStandInBroker broker;
+	broker.holdAcks = true;
+	ksMqttClient client{broker, 256, 64, 2};
+	std::vector<ksReceivedMessage> received;
+	KSF_REQUIRE(connectClient(broker, client, received));
+
+	KSF_CHECK(client.publish("", "t", "1", false, 1));
+	KSF_CHECK(client.publish("", "t", "2", false, 1));
+	KSF_CHECK(client.getInFlightCount() == 2);
+
+	/* Window full - QoS 1 fails, QoS 0 still goes. */
+	KSF_CHECK(!client.publish("", "t", "3", false, 1));
+	KSF_CHECK(client.publish("", "t", "4", false, 0));
+	KSF_CHECK(client.getStats().publishFailures == 1);
+
+	/* Broker acknowledges both. */
+	broker.sendPacket(0x40, {0x00, 0x01});
+	broker.sendPacket(0x40, {0x00, 0x02});
+	KSF_CHECK(client.loop());
+	KSF_CHECK(client.getInFlightCount() == 0);
+	KSF_CHECK(client.publish("", "t", "5", false, 1));
+}
+
+KSF_TEST(qos2PublishCompletesOnPubcomp)
+{
+	ksStandInBroker broker;
+	broker.holdAcks = true;
+	ksMqttClient client{broker, 256, 64, 1};
+	std::vector<ksReceivedMessage> received;
+	KSF_REQUIRE(connectClient(broker, client, received));
+
+	KSF_CHECK(client.publish("", "t", "x", false, 2));
+	KSF_CHECK(client.getInFlightCount() == 1);
+
+	/* PUBREC is answered with PUBREL, but the message stays in flight. */
+	broker.sendPacket(0x50, {0x00, 0x01});
+	KSF_CHECK(client.loop());
+	KSF_CHECK(broker.pubrelsReceived == 1);
+	KSF_CHECK(client.getInFlightCount() == 1);
+	KSF_CHECK(!client.publish("", "t", "y", false, 2));
+
+	broker.sendPacket(0x70, {0x00, 0x01});
+	KSF_CHECK(client.loop());
+	KSF_CHECK(client.getInFlightCount() == 0);
+}
+
+KSF_TEST(qos2PublishWithBrokerHandshake)
+{
+	ksStandInBroker broker;
+	ksMqttClient client{broker, 256, 64, 4};
+	std::vector<ksReceivedMessage> received;
+	KSF_REQUIRE(connectClient(broker, client, received));
+
+	for (auto i{0}; i < 10; ++i)
+	{
+		KSF_CHECK(client.publish("", "t", "x", false, 2));
+		/* PUBREC, then PUBCOMP after the client's PUBREL. */
+		KSF_CHECK(client.loop());
+		KSF_CHECK(client.loop());
+	}
+	KSF_CHECK(client.getInFlightCount() == 0);
+	KSF_CHECK(broker.pubrelsReceived == 10);
+}
+
+KSF_TEST(incomingMessagesInFragments)
+{
+	ksStandInBroker broker;
+	broker.readChunkSize = 1;
+	ksMqttClient client{broker, 256, 64, 4};
+	std::vector<ksReceivedMessage> received;
+	KSF_REQUIRE(connectClient(broker, client, received));
+	KSF_CHECK(client.subscribe("dev/", "#"));
+
+	broker.publishToClient("dev/a", "hello");
+	broker.publishToClient("dev/b", std::string(200, 'x'), 1);
+	broker.publishToClient("dev/c", "", 2);
+
+	/* One byte per read, loop must not wait for missing bytes. */
+	for (auto i{0}; i < 1000 && broker.pendingToClient() > 0; ++i)
+		KSF_CHECK(client.loop());
+
+	KSF_REQUIRE(received.size() == 3);
+	KSF_CHECK(received[0].topic == "dev/a" && received[0].payload == "hello");
+	KSF_CHECK(received[1].topic == "dev/b" && received[1].payload == std::string(200, 'x'));
+	KSF_CHECK(received[2].topic == "dev/c" && received[2].payload.empty());
+	KSF_CHECK(broker.pubacksReceived == 1);
+
+	/* PUBREC was sent for QoS 2, broker's PUBREL is answered with PUBCOMP. */
+	for (auto i{0}; i < 100 && broker.pendingToClient() > 0; ++i)
+		client.loop();
+	KSF_CHECK(broker.pubcompsReceived == 1);
+}
+
+KSF_TEST(oversizedPacketIsSkipped)
+{
+	ksStandInBroker broker;
+	broker.readChunkSize = 7;
+	ksMqttClient client{broker, 64, 64, 4};
+	std::vector<ksReceivedMessage> received;
+	KSF_REQUIRE(connectClient(broker, client, received));
+
+	broker.publishToClient("big", std::string(1000, 'b'));
+	broker.publishToClient("small", "ok");
+	for (auto i{0}; i < 1000 && broker.pendingToClient() > 0; ++i)
+		KSF_CHECK(client.loop());
+
+	KSF_CHECK(client.connected());
+	KSF_REQUIRE(received.size() == 1);
+	KSF_CHECK(received[0].topic == "small" && received[0].payload == "ok");
+}
+
+KSF_TEST(echoThroughSubscription)
+{
+	ksStandInBroker broker;
+	ksMqttClient client{broker, 256, 64, 4};
+	std::vector<ksReceivedMessage> received;
+	KSF_REQUIRE(connectClient(broker, client, received));
+
+	KSF_CHECK(client.subscribe("dev/", "cmd"));
+	KSF_CHECK(client.publish("dev/", "cmd", "on"));
+	KSF_CHECK(client.publish("dev/", "other", "off"));
+	client.loop();
+
+	KSF_REQUIRE(received.size() == 1);
+	KSF_CHECK(received[0].payload == "on");
+
+	KSF_CHECK(client.unsubscribe("dev/", "cmd"));
+	KSF_CHECK(client.publish("dev/", "cmd", "again"));
+	client.loop();
+	KSF_CHECK(received.size() == 1);
+}
+
+KSF_TEST(streamedPublish)
+{
+	ksStandInBroker broker;
+	ksMqttClient client{broker, 256, 32, 4};
+	std::vector<ksReceivedMessage> received;
+	KSF_REQUIRE(connectClient(broker, client, received));
+
+	std::string payload(5000, '\0');
+	for (std::size_t i{0}; i < payload.size(); ++i)
+		payload[i] = static_cast<char>('a' + i % 26);
+
+	KSF_REQUIRE(client.beginPublish("dev/", "stream", payload.size(), false, 1));
+	KSF_CHECK(!client.publish("", "t", "blocked"));
+	for (std::size_t offset{0}; offset < payload.size(); offset += 700)
+		KSF_CHECK(client.writePayload(reinterpret_cast<const uint8_t*>(payload.data() + offset), std::min<std::size_t>(700, payload.size() - offset)));
+	KSF_CHECK(client.endPublish());
+
+	KSF_REQUIRE(broker.published.size() == 1);
+	KSF_CHECK(broker.published[0].payload == payload);
+
+	/* Short payload can't be completed - the connection is dropped. */
+	KSF_REQUIRE(client.beginPublish("", "t", 10));
+	KSF_CHECK(client.writePayload(reinterpret_cast<const uint8_t*>("abc"), 3));
+	KSF_CHECK(!client.endPublish());
+	KSF_CHECK(!client.connected());
+}
+
+KSF_TEST(writeWithoutStreamKeepsSession)
+{
+	ksStandInBroker broker;
+	broker.holdAcks = true;
+	ksMqttClient client{broker, 256, 64, 1};
+	std::vector<ksReceivedMessage> received;
+	KSF_REQUIRE(connectClient(broker, client, received));
+
+	/* Window full - the stream is not started, so the following writes fail without touching the session. */
+	KSF_REQUIRE(client.publish("", "t", "1", false, 1));
+	KSF_CHECK(!client.beginPublish("", "t", 3, false, 1));
+	KSF_CHECK(!client.writePayload(reinterpret_cast<const uint8_t*>("abc"), 3));
+	KSF_CHECK(!client.endPublish());
+	KSF_CHECK(client.connected());
+	KSF_CHECK(client.getStats().publishFailures == 1);
+	KSF_CHECK(client.publish("", "t", "2"));
+
+	/* Chunk over the declared length can't be sent as a part of the started packet. */
+	KSF_REQUIRE(client.beginPublish("", "t", 2));
+	KSF_CHECK(!client.writePayload(reinterpret_cast<const uint8_t*>("abc"), 3));
+	KSF_CHECK(!client.connected());
+}
+
+KSF_TEST(keepAlive)
+{
+	ksStandInBroker broker;
+	ksMqttClient client{broker, 256, 64, 4};
+	client.setKeepAlive(10);
+	std::vector<ksReceivedMessage> received;
+	KSF_REQUIRE(connectClient(broker, client, received));
+
+	ksf::test::fakeMillis += 10000;
+	KSF_CHECK(client.loop());
+	KSF_CHECK(broker.pingsReceived == 1);
+	ksf::test::fakeMillis += 20;
+	KSF_CHECK(client.loop());
+	KSF_CHECK(client.getStats().pingRoundTripMs == 20);
+
+	/* Unanswered ping drops the connection after another interval. */
+	broker.answerPings = false;
+	ksf::test::fakeMillis += 10000;
+	KSF_CHECK(client.loop());
+	ksf::test::fakeMillis += 10000;
+	KSF_CHECK(!client.loop());
+	KSF_CHECK(!client.connected());
+}
+
+KSF_TEST(writeFailureDropsConnection)
+{
+	ksStandInBroker broker;
+	ksMqttClient client{broker, 256, 64, 4};
+	std::vector<ksReceivedMessage> received;
+	KSF_REQUIRE(connectClient(broker, client, received));
+
+	/* Socket accepts only a part of the packet. */
+	broker.writeBudget = 20;
+	KSF_CHECK(!client.publish("dev/", "topic", std::string(100, 'p')));
+	KSF_CHECK(!client.connected());
+	KSF_CHECK(client.getStats().publishFailures == 1);
+	KSF_CHECK(!client.loop());
+}
+
+KSF_TEST(brokerClosesConnection)
+{
+	ksStandInBroker broker;
+	ksMqttClient client{broker, 256, 64, 4};
+	std::vector<ksReceivedMessage> received;
+	KSF_REQUIRE(connectClient(broker, client, received));
+
+	broker.closeFromBroker();
+	KSF_CHECK(!client.loop());
+	KSF_CHECK(!client.publish("", "t", "x"));
+
+	/* Reconnection resets the protocol state. */
+	broker.holdAcks = true;
+	KSF_REQUIRE(connectClient(broker, client, received));
+	KSF_CHECK(client.publish("", "t", "x", false, 1));
+	KSF_CHECK(client.getInFlightCount() == 1);
+}
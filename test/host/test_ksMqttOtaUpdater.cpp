@@ -0,0 +1,105 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+// Sources: comp/ksMqttOtaUpdater.cpp misc/ksMqttClient.cpp misc/ksOtaWriter.cpp misc/ksHeatshrinkDecoder.cpp misc/ksDeltaPatcher.cpp misc/ksSha256.cpp misc/ksReconnectPolicy.cpp misc/ksSimpleTimer.cpp ksComponent.cpp ksConstants.cpp evt/ksEventHandle.cpp
+
+#include <Update.h>
+#include "ksTest.h"
+#include "ksOtaServerStandIn.h"
+
+using ksf::test::ksOtaSetup;
+
+KSF_TEST(fullTransfer)
+{
+	ksOtaSetup setup{"top secret", 200 * 1024 + 123};
+	setup.server.control("nonce");
+	setup.run();
+
+	KSF_CHECK(setup.server.result == "ok");
+	KSF_CHECK(Update.finished);
+	KSF_CHECK(Update.image == std::vector<uint8_t>(setup.server.image.begin(), setup.server.image.end()));
+	KSF_CHECK(!setup.server.progress.empty() && setup.server.progress.back() == "100");
+	KSF_CHECK(setup.server.bytesSent >= setup.server.image.size());
+}
+
+KSF_TEST(beginWithoutNonceIsRejected)
+{
+	ksOtaSetup setup{"top secret"};
+	auto args{std::to_string(setup.server.image.size()) + ' ' + setup.server.md5 + " raw"};
+	setup.server.control("begin " + args + ' ' + setup.server.sign("", args));
+	setup.run();
+
+	KSF_CHECK(setup.server.result == "error: unauthorized");
+	KSF_CHECK(!setup.updater->isUpdating());
+}
+
+KSF_TEST(wrongSecretIsRejected)
+{
+	ksOtaSetup setup{"other secret"};
+	setup.server.control("nonce");
+	setup.run();
+
+	KSF_CHECK(!setup.server.lastNonce.empty());
+	KSF_CHECK(setup.server.result == "error: unauthorized");
+	KSF_CHECK(!setup.updater->isUpdating());
+}
+
+KSF_TEST(emptySecretRejectsAll)
+{
+	ksOtaSetup setup{""};
+	setup.server.secret = "";
+	setup.server.control("nonce");
+	setup.run();
+
+	KSF_CHECK(setup.server.result == "error: unauthorized");
+	KSF_CHECK(!setup.updater->isUpdating());
+}
+
+KSF_TEST(nonceIsSingleUse)
+{
+	ksOtaSetup setup{"top secret"};
+	setup.server.autoBegin = false;
+	setup.server.control("nonce");
+	setup.run();
+	KSF_REQUIRE(setup.server.lastNonce.size() == 16);
+
+	/* Tampered arguments don't match the HMAC - and the nonce is gone even though the command failed. */
+	auto args{std::to_string(setup.server.image.size()) + ' ' + setup.server.md5 + " raw"};
+	auto command{"begin " + args + ' ' + setup.server.sign(setup.server.lastNonce, args)};
+	setup.server.control("begin 1000 " + setup.server.md5 + " raw " + setup.server.sign(setup.server.lastNonce, args));
+	setup.server.control(command);
+	setup.run();
+	KSF_CHECK(setup.server.result == "error: unauthorized");
+	KSF_CHECK(!setup.updater->isUpdating());
+
+	/* New nonce differs from the previous one. */
+	auto previousNonce{setup.server.lastNonce};
+	setup.server.control("nonce");
+	setup.run();
+	KSF_CHECK(setup.server.lastNonce.size() == 16 && setup.server.lastNonce != previousNonce);
+}
+
+KSF_TEST(rejectedBeginKeepsUpdateRunning)
+{
+	ksOtaSetup setup{"top secret", 32 * 1024};
+	setup.server.control("nonce");
+
+	/* Let the update start, then inject a forged begin before the transfer ends. */
+	for (auto i{0}; i < 3; ++i)
+	{
+		setup.connector->loop(nullptr);
+		setup.server.serve();
+	}
+	KSF_REQUIRE(setup.updater->isUpdating());
+	setup.server.control("begin 10 " + setup.server.md5 + " raw " + std::string(64, '0'));
+	setup.run();
+
+	KSF_CHECK(setup.server.result == "ok");
+	KSF_CHECK(Update.image.size() == setup.server.image.size());
+}
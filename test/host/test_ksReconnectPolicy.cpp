@@ -0,0 +1,198 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+// Sources: misc/ksReconnectPolicy.cpp
+
+#include <algorithm>
+#include "ksTest.h"
+#include "misc/ksReconnectPolicy.h"
+
+using ksf::misc::ksReconnectPolicy;
+
+/*
+	Simulated connection loop: the time advances in 10 ms steps and every attempt fails while the broker is down.
+	Returns the times (relative to the start) at which attempts were made.
+*/
+static std::vector<uint32_t> simulateOutage(ksReconnectPolicy& policy, uint32_t startMs, uint32_t outageMs)
+{
+	std::vector<uint32_t> attemptTimes;
+	for (uint32_t elapsedMs{0}; elapsedMs <= outageMs; elapsedMs += 10)
+	{
+		auto nowMs{startMs + elapsedMs};
+		if (!policy.shouldAttempt(nowMs))
+			continue;
+
+		attemptTimes.push_back(elapsedMs);
+		policy.onAttemptFailed(nowMs);
+	}
+	return attemptTimes;
+}
+
+KSF_TEST(backoffDoublesAndSaturates)
+{
+	ksReconnectPolicy policy{500, 8000, 0, 0};
+
+	uint32_t expectedDelays[]{500, 1000, 2000, 4000, 8000, 8000, 8000};
+	for (auto expectedDelayMs : expectedDelays)
+	{
+		policy.onAttemptFailed(0);
+		KSF_CHECK(policy.getCurrentDelayMs() == expectedDelayMs);
+	}
+	KSF_CHECK(policy.getFailedAttempts() == 7);
+
+	/* Long outages must not overflow the shift. */
+	for (auto i{0}; i < 1000; ++i)
+		policy.onAttemptFailed(0);
+	KSF_CHECK(policy.getCurrentDelayMs() == 8000);
+}
+
+KSF_TEST(maxDelayBelowBaseIsClamped)
+{
+	ksReconnectPolicy policy{2000, 100, 0, 0};
+	policy.onAttemptFailed(0);
+	KSF_CHECK(policy.getCurrentDelayMs() == 2000);
+	policy.onAttemptFailed(0);
+	KSF_CHECK(policy.getCurrentDelayMs() == 2000);
+}
+
+KSF_TEST(attemptsFollowBackoffInSimulatedTime)
+{
+	ksReconnectPolicy policy{1000, 16000, 0, 0};
+	policy.onDisconnected(5000);
+
+	auto attemptTimes{simulateOutage(policy, 5000, 60000)};
+	std::vector<uint32_t> expectedTimes{0, 1000, 3000, 7000, 15000, 31000, 47000};
+	KSF_CHECK(attemptTimes == expectedTimes);
+}
+
+KSF_TEST(jitterStaysWithinBounds)
+{
+	constexpr uint32_t baseDelayMs{1000}, maxDelayMs{30000};
+	constexpr uint8_t jitterPercent{20};
+
+	for (uint32_t seed{1}; seed <= 200; ++seed)
+	{
+		ksReconnectPolicy policy{baseDelayMs, maxDelayMs, jitterPercent, 0};
+		policy.setSeed(seed);
+
+		uint32_t nominalDelayMs{baseDelayMs};
+		for (auto attempt{0}; attempt < 10; ++attempt)
+		{
+			policy.onAttemptFailed(0);
+			auto jitterMs{nominalDelayMs * jitterPercent / 100};
+			KSF_CHECK(policy.getCurrentDelayMs() >= nominalDelayMs - jitterMs);
+			KSF_CHECK(policy.getCurrentDelayMs() <= nominalDelayMs + jitterMs);
+			nominalDelayMs = std::min(nominalDelayMs * 2, maxDelayMs);
+		}
+	}
+}
+
+KSF_TEST(jitterSpreadsDevices)
+{
+	/* Devices that lost the broker at the same moment should not retry in lockstep. */
+	std::vector<uint32_t> delays;
+	for (uint32_t seed{1}; seed <= 50; ++seed)
+	{
+		ksReconnectPolicy policy{1000, 30000, 25, 0};
+		policy.setSeed(seed * 2654435761u);
+		policy.onAttemptFailed(0);
+		delays.push_back(policy.getCurrentDelayMs());
+	}
+
+	auto [minIt, maxIt]{std::minmax_element(delays.begin(), delays.end())};
+	KSF_CHECK(*maxIt - *minIt > 250);
+
+	std::sort(delays.begin(), delays.end());
+	KSF_CHECK(std::unique(delays.begin(), delays.end()) - delays.begin() > 25);
+}
+
+KSF_TEST(zeroSeedIsReplaced)
+{
+	ksReconnectPolicy policy{1000, 30000, 50, 0};
+	policy.setSeed(0);
+	for (auto i{0}; i < 5; ++i)
+		policy.onAttemptFailed(0);
+
+	/* Zero xorshift state would stay zero, pinning the delay to its lower bound. */
+	KSF_CHECK(policy.getCurrentDelayMs() != 8000 - 4000);
+}
+
+KSF_TEST(immediateRetryAfterDisconnect)
+{
+	ksReconnectPolicy policy{1000, 30000, 10, 0};
+
+	/* Failed attempts build up the backoff. */
+	for (auto i{0}; i < 5; ++i)
+		policy.onAttemptFailed(1000);
+	KSF_CHECK(!policy.shouldAttempt(2000));
+
+	/* Link up, then down - the first retry is allowed at once and backoff starts over. */
+	policy.onConnected();
+	KSF_CHECK(policy.getFailedAttempts() == 0);
+	policy.onDisconnected(50000);
+	KSF_CHECK(policy.shouldAttempt(50000));
+
+	policy.onAttemptFailed(50000);
+	KSF_CHECK(policy.getFailedAttempts() == 1);
+	KSF_CHECK(policy.getCurrentDelayMs() >= 900 && policy.getCurrentDelayMs() <= 1100);
+	KSF_CHECK(!policy.shouldAttempt(50000 + 899));
+	KSF_CHECK(policy.shouldAttempt(50000 + 1100));
+}
+
+KSF_TEST(failureInjectionThenRecovery)
+{
+	/* Broker rejects the first N attempts, then accepts. */
+	ksReconnectPolicy policy{200, 5000, 0, 0};
+	policy.onDisconnected(0);
+
+	uint32_t nowMs{0}, attempts{0};
+	constexpr uint32_t failuresToInject{6};
+	bool connected{false};
+	while (!connected && nowMs < 60000)
+	{
+		if (policy.shouldAttempt(nowMs))
+		{
+			if (++attempts > failuresToInject)
+			{
+				policy.onConnected();
+				connected = true;
+			}
+			else
+				policy.onAttemptFailed(nowMs);
+		}
+		nowMs += 1;
+	}
+
+	KSF_REQUIRE(connected);
+	/* 0 + 200 + 400 + 800 + 1600 + 3200 + 5000 (capped) */
+	KSF_CHECK(nowMs - 1 == 200 + 400 + 800 + 1600 + 3200 + 5000);
+	KSF_CHECK(policy.getFailedAttempts() == 0);
+}
+
+KSF_TEST(millisRollover)
+{
+	ksReconnectPolicy policy{1000, 30000, 0, 0};
+	uint32_t nowMs{UINT32_MAX - 500};
+	policy.onAttemptFailed(nowMs);
+
+	KSF_CHECK(!policy.shouldAttempt(nowMs + 999));
+	KSF_CHECK(policy.shouldAttempt(nowMs + 1000));
+	KSF_CHECK(policy.shouldAttempt(nowMs + 1500));
+}
+
+KSF_TEST(addressTtl)
+{
+	ksReconnectPolicy policy{1000, 30000, 0, 60000};
+	KSF_CHECK(!policy.isAddressExpired(1000, 60999));
+	KSF_CHECK(policy.isAddressExpired(1000, 61000));
+	KSF_CHECK(policy.isAddressExpired(UINT32_MAX - 100, 60000));
+
+	ksReconnectPolicy neverExpires{1000, 30000, 0, 0};
+	KSF_CHECK(!neverExpires.isAddressExpired(0, UINT32_MAX));
+}
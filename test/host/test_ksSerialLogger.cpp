@@ -0,0 +1,99 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+// Sources: comp/ksSerialLogger.cpp misc/ksLogRing.cpp ksLog.cpp ksComponent.cpp
+
+#include "ksTest.h"
+#include "ksApplication.h"
+#include "misc/ksLogRing.h"
+#include "comp/ksSerialLogger.h"
+
+using ksf::comps::ksSerialLogger;
+
+namespace ksf
+{
+	/* Link seam, the application (and the rest of the framework it pulls in) is not needed to log. */
+	misc::ksLogRing& ksApplication::getLogRing()
+	{
+		static misc::ksLogRing logRing(KSF_LOG_RING_SIZE);
+		return logRing;
+	}
+}
+
+/* Serial port stand-in with a transmit buffer of limited free space. */
+struct ksSerialStandIn : public Print
+{
+	std::string written;			//!< Bytes taken so far.
+	int freeSpace{0};				//!< Free space of the transmit buffer, taken by writes.
+
+	int availableForWrite() override { return freeSpace; }
+
+	size_t write(uint8_t value) override
+	{
+		if (freeSpace <= 0)
+			return 0;
+
+		written += static_cast<char>(value);
+		--freeSpace;
+		return 1;
+	}
+};
+
+KSF_TEST(drainsHistoryAndNewLines)
+{
+	ksSerialStandIn serial;
+	serial.freeSpace = 1024;
+
+	KSF_LOG_INFO("before %u", 1U);
+	ksSerialLogger logger{&serial};
+	KSF_CHECK(logger.loop(nullptr));
+	KSF_CHECK(serial.written == "before 1\r\n");
+
+	/* Position survives the component, so a logger of the next application doesn't repeat the lines. */
+	KSF_LOG_WARN("after %s", "rotation");
+	ksSerialLogger nextLogger{&serial};
+	KSF_CHECK(nextLogger.loop(nullptr));
+	KSF_CHECK(serial.written == "before 1\r\nafter rotation\r\n");
+}
+
+KSF_TEST(writesOnlyFreeSpace)
+{
+	ksSerialStandIn serial;
+	ksSerialLogger logger{&serial};
+	serial.freeSpace = 1024;
+	logger.loop(nullptr);
+	serial.written.clear();
+
+	/* Line longer than the free space is written in parts over several loops, nothing is lost or blocked on. */
+	KSF_LOG_ERROR("0123456789abcdefghij");
+	serial.freeSpace = 8;
+	KSF_CHECK(logger.loop(nullptr));
+	KSF_CHECK(serial.written == "01234567");
+	KSF_CHECK(logger.loop(nullptr));
+	KSF_CHECK(serial.written == "01234567");
+
+	serial.freeSpace = 8;
+	logger.loop(nullptr);
+	serial.freeSpace = 100;
+	logger.loop(nullptr);
+	KSF_CHECK(serial.written == "0123456789abcdefghij\r\n");
+}
+
+KSF_TEST(binaryRecordsAsHex)
+{
+	ksSerialStandIn serial;
+	ksSerialLogger logger{&serial};
+	serial.freeSpace = 1024;
+	logger.loop(nullptr);
+	serial.written.clear();
+
+	ksf::ksApplication::getLogRing().write({"\0\x03\x12", 3});
+	logger.loop(nullptr);
+	KSF_CHECK(serial.written == "#000312\r\n");
+}
@@ -0,0 +1,86 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+// Sources: misc/ksSha256.cpp
+
+#include <string>
+#include "ksTest.h"
+#include "misc/ksSha256.h"
+
+using ksf::misc::ksSha256;
+
+static std::string toHex(const uint8_t* digest)
+{
+	static constexpr char HEX_DIGITS[]{"0123456789abcdef"};
+	std::string hex;
+	for (std::size_t i{0}; i < ksSha256::DIGEST_SIZE; ++i)
+	{
+		hex += HEX_DIGITS[digest[i] >> 4];
+		hex += HEX_DIGITS[digest[i] & 0x0F];
+	}
+	return hex;
+}
+
+static std::string sha256(std::string_view data)
+{
+	uint8_t digest[ksSha256::DIGEST_SIZE];
+	ksSha256 hash;
+	hash.update(data);
+	hash.finish(digest);
+	return toHex(digest);
+}
+
+static std::string hmac(std::string_view key, std::string_view message)
+{
+	uint8_t digest[ksSha256::DIGEST_SIZE];
+	ksSha256::hmac(key, message, digest);
+	return toHex(digest);
+}
+
+KSF_TEST(hashVectors)
+{
+	KSF_CHECK(sha256("") == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+	KSF_CHECK(sha256("abc") == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+	KSF_CHECK(sha256("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq") == "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+	KSF_CHECK(sha256(std::string(1000000, 'a')) == "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+KSF_TEST(incrementalUpdates)
+{
+	std::string data(1000, '\0');
+	for (std::size_t i{0}; i < data.size(); ++i)
+		data[i] = static_cast<char>(i * 13);
+
+	/* Any split of the input gives the same digest, including splits on and around block borders. */
+	for (std::size_t split : {1, 55, 56, 63, 64, 65, 128, 999})
+	{
+		uint8_t digest[ksSha256::DIGEST_SIZE];
+		ksSha256 hash;
+		hash.update(std::string_view(data).substr(0, split));
+		hash.update(std::string_view(data).substr(split));
+		hash.finish(digest);
+		KSF_CHECK(toHex(digest) == sha256(data));
+	}
+}
+
+KSF_TEST(hmacRfc4231Vectors)
+{
+	/* Test cases 1, 2, 4, 6 and 7. */
+	KSF_CHECK(hmac(std::string(20, '\x0b'), "Hi There") == "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7");
+	KSF_CHECK(hmac("Jefe", "what do ya want for nothing?") == "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+
+	std::string key4;
+	for (char ch{1}; ch <= 25; ++ch)
+		key4 += ch;
+	KSF_CHECK(hmac(key4, std::string(50, '\xcd')) == "82558a389a443c0ea4cc819899f2083a85f0faa3e578f8077a2e3ff46729665b");
+
+	std::string longKey(131, '\xaa');
+	KSF_CHECK(hmac(longKey, "Test Using Larger Than Block-Size Key - Hash Key First") == "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54");
+	KSF_CHECK(hmac(longKey, "This is a test using a larger than block-size key and a larger than block-size data. The key needs to be hashed before being used by the HMAC algorithm.") == "9b09ffa71b942fcb27635fbcd5b0e944bfdc63644f0713938a7f51535c3a35e2");
+}
@@ -0,0 +1,59 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+// Sources: misc/ksStatFilter.cpp misc/ksStatWriter.cpp misc/ksCborWriter.cpp ksConstants.cpp
+
+#include <Arduino.h>
+#include <cmath>
+#include "ksTest.h"
+#include "misc/ksStatFilter.h"
+
+using ksf::misc::ksCompactStatWriter;
+using ksf::misc::ksFilteredStatWriter;
+using ksf::misc::ksStatFilter;
+
+static const char MQTT_GROUP[] PROGMEM {"mqtt"};
+static const char BYTES_IN_STAT[] PROGMEM {"bytesIn"};
+
+/* Writes one report through the filter and returns the resulting JSON document. */
+static std::string report(ksStatFilter& filter, int64_t rssi, uint64_t bytesIn, bool force = false)
+{
+	static uint8_t buffer[128];
+	ksCompactStatWriter writer{ksCompactStatWriter::Format::Json, buffer, sizeof(buffer)};
+	ksFilteredStatWriter filtered{writer, filter, force};
+	writer.begin();
+	filtered.addInt("rssi", rssi);
+	filtered.beginGroup(MQTT_GROUP);
+	filtered.addUnsigned(BYTES_IN_STAT, bytesIn);
+	filtered.endGroup();
+	writer.end();
+	return std::string(writer.getDocument());
+}
+
+KSF_TEST(pathHashMatchesGroups)
+{
+	/* Hash built part by part from the writer must match the hash of the full path. */
+	auto groupHash{ksStatFilter::hashPath("/", ksStatFilter::hashPath(MQTT_GROUP))};
+	KSF_CHECK(ksStatFilter::hashPath(BYTES_IN_STAT, groupHash) == ksStatFilter::hashPath("mqtt/bytesIn"));
+	KSF_CHECK(ksStatFilter::hashPath("mqtt/bytesIn") != ksStatFilter::hashPath("mqtt/bytesOut"));
+}
+
+KSF_TEST(thresholdsFilterReports)
+{
+	ksStatFilter filter;
+	filter.setThreshold("rssi", 5);
+	filter.setThreshold("mqtt/bytesIn", INFINITY);
+
+	KSF_CHECK(report(filter, -60, 100) == R"({"rssi":-60,"mqtt":{"bytesIn":100}})");
+	KSF_CHECK(report(filter, -62, 200) == R"({"mqtt":{}})");
+	KSF_CHECK(report(filter, -66, 300) == R"({"rssi":-66,"mqtt":{}})");
+
+	/* Heartbeat reports everything. */
+	KSF_CHECK(report(filter, -66, 300, true) == R"({"rssi":-66,"mqtt":{"bytesIn":300}})");
+}
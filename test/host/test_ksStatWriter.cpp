@@ -0,0 +1,73 @@
+/*
+ *	Copyright (c) 2020-2026, Krzysztof Strehlau
+ *
+ *	This file is a part of the ksIotFrameworkLib IoT library.
+ *	All licensing information can be found inside LICENSE.md file.
+ *
+ *	https://github.com/cziter15/ksIotFrameworkLib/blob/master/LICENSE
+ */
+
+// Sources: misc/ksStatWriter.cpp misc/ksCborWriter.cpp ksConstants.cpp
+
+#include "ksTest.h"
+#include "misc/ksStatWriter.h"
+
+using ksf::misc::ksCompactStatWriter;
+
+KSF_TEST(jsonDocument)
+{
+	uint8_t buffer[256];
+	ksCompactStatWriter writer{ksCompactStatWriter::Format::Json, buffer, sizeof(buffer)};
+	writer.begin();
+	writer.addInt("rssi", -61);
+	writer.beginGroup("mqtt");
+	writer.addUnsigned("reconnects", 3);
+	writer.addFloat("temp", 21.456, 1);
+	writer.endGroup();
+	writer.addString("fw", "1.0");
+	KSF_REQUIRE(writer.end());
+	KSF_CHECK(writer.getDocument() == R"({"rssi":-61,"mqtt":{"reconnects":3,"temp":21.5},"fw":"1.0"})");
+}
+
+KSF_TEST(jsonEscapesNamesAndValues)
+{
+	uint8_t buffer[256];
+	ksCompactStatWriter writer{ksCompactStatWriter::Format::Json, buffer, sizeof(buffer)};
+	writer.begin();
+	writer.addString("say \"hi\"", "a\\b\n\x01");
+	writer.beginGroup("grp\t");
+	writer.addInt("x\"", 1);
+	writer.endGroup();
+	KSF_REQUIRE(writer.end());
+	KSF_CHECK(writer.getDocument() == R"({"say \"hi\"":"a\\b\n\u0001","grp\t":{"x\"":1}})");
+}
+
+KSF_TEST(jsonEscapeNearBufferEnd)
+{
+	/* Every length around the point where escape sequences stop fitting must either fit or overflow, never cut. */
+	for (std::size_t capacity{1}; capacity < 40; ++capacity)
+	{
+		uint8_t buffer[64];
+		ksCompactStatWriter writer{ksCompactStatWriter::Format::Json, buffer, capacity};
+		writer.begin();
+		writer.addString("n", "\x02\x03\"\"");
+		auto complete{writer.end()};
+		KSF_CHECK(complete == (capacity >= 24));
+		KSF_CHECK(complete != writer.hasOverflow());
+		if (complete)
+			KSF_CHECK(writer.getDocument() == R"({"n":"\u0002\u0003\"\""})");
+	}
+}
+
+KSF_TEST(cborDocument)
+{
+	uint8_t buffer[64];
+	ksCompactStatWriter writer{ksCompactStatWriter::Format::Cbor, buffer, sizeof(buffer)};
+	writer.begin();
+	writer.addString("a\"", "b");
+	KSF_REQUIRE(writer.end());
+
+	/* Indefinite map, text "a\"", text "b", break - CBOR text is never escaped. */
+	const uint8_t expected[]{0xBF, 0x62, 'a', '"', 0x61, 'b', 0xFF};
+	KSF_CHECK(writer.getDocument() == std::string_view(reinterpret_cast<const char*>(expected), sizeof(expected)));
+}